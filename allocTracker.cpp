@@ -0,0 +1,188 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       allocTracker.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/23
+ * \brief      Heap allocations of every frame counted by subsystem
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "allocTracker.h"
+
+#ifdef ALLOC_TRACKING
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+// everything here is zero or constant initialized, operator new may run before main
+std::atomic<long long> allocTracker::allocations[ALLOC_MAX_TAGS];
+std::atomic<long long> allocTracker::bytes[ALLOC_MAX_TAGS];
+std::atomic<long long> allocTracker::frees[ALLOC_MAX_TAGS];
+AllocCounters allocTracker::last[ALLOC_MAX_TAGS];
+AllocCounters allocTracker::total;
+const char* allocTracker::names[ALLOC_MAX_TAGS] = { "untagged" };
+std::atomic<int> allocTracker::tagCount(1);
+int allocTracker::dumpInterval = 0;
+long long allocTracker::frame = 0;
+long long allocTracker::trackedFrames = 0;
+long long allocTracker::allocatingFrames = 0;
+
+static thread_local int currentTag = 0;
+static std::mutex tagMutex;
+
+void allocTracker::count(size_t size) {
+	allocations[currentTag].fetch_add(1, std::memory_order_relaxed);
+	bytes[currentTag].fetch_add((long long)size, std::memory_order_relaxed);
+}
+
+void allocTracker::countFree() {
+	frees[currentTag].fetch_add(1, std::memory_order_relaxed);
+}
+
+// names are compared by pointer first, the same literal usually has one address
+int allocTracker::getTag(const char* name) {
+	int count = tagCount.load(std::memory_order_acquire);
+	for (int tag = 0; tag < count; tag++)
+		if (names[tag] == name)
+			return tag;
+
+	std::lock_guard<std::mutex> lock(tagMutex);
+	count = tagCount.load(std::memory_order_relaxed);
+	for (int tag = 0; tag < count; tag++)
+		if (strcmp(names[tag], name) == 0)
+			return tag;
+	if (count == ALLOC_MAX_TAGS)
+		return 0;
+	names[count] = name;
+	tagCount.store(count + 1, std::memory_order_release);
+	return count;
+}
+
+int allocTracker::setTag(int tag) {
+	int previous = currentTag;
+	currentTag = tag;
+	return previous;
+}
+
+void allocTracker::endFrame() {
+	AllocCounters frameTotal;
+	int count = tagCount.load(std::memory_order_acquire);
+	for (int tag = 0; tag < count; tag++) {
+		last[tag].allocations = allocations[tag].exchange(0, std::memory_order_relaxed);
+		last[tag].bytes = bytes[tag].exchange(0, std::memory_order_relaxed);
+		last[tag].frees = frees[tag].exchange(0, std::memory_order_relaxed);
+		frameTotal.allocations += last[tag].allocations;
+		frameTotal.bytes += last[tag].bytes;
+		frameTotal.frees += last[tag].frees;
+	}
+	frame++;
+	trackedFrames++;
+	if (frameTotal.allocations > 0)
+		allocatingFrames++;
+	total.allocations += frameTotal.allocations;
+	total.bytes += frameTotal.bytes;
+	total.frees += frameTotal.frees;
+
+	if (dumpInterval > 0 && frame % dumpInterval == 0) {
+		allocScope scope("allocation report");
+		printReport(std::cout);
+	}
+}
+
+AllocCounters allocTracker::getFrame() {
+	AllocCounters frameTotal;
+	int count = tagCount.load(std::memory_order_acquire);
+	for (int tag = 0; tag < count; tag++) {
+		frameTotal.allocations += last[tag].allocations;
+		frameTotal.bytes += last[tag].bytes;
+		frameTotal.frees += last[tag].frees;
+	}
+	return frameTotal;
+}
+
+// table of the last frame, one row per tag that allocated or freed anything
+void allocTracker::printReport(std::ostream& out) {
+	out << "Heap allocations of frame " << frame << ":" << std::endl;
+	out << "  " << std::setw(24) << std::left << "scope" << std::right
+		<< std::setw(14) << "allocations" << std::setw(14) << "bytes" << std::setw(14) << "frees" << std::endl;
+	int count = tagCount.load(std::memory_order_acquire);
+	for (int tag = 0; tag < count; tag++) {
+		if (last[tag].allocations == 0 && last[tag].frees == 0)
+			continue;
+		out << "  " << std::setw(24) << std::left << names[tag] << std::right << std::setw(14) << last[tag].allocations
+			<< std::setw(14) << last[tag].bytes << std::setw(14) << last[tag].frees << std::endl;
+	}
+	AllocCounters frameTotal = getFrame();
+	out << "  " << std::setw(24) << std::left << "total" << std::right << std::setw(14) << frameTotal.allocations
+		<< std::setw(14) << frameTotal.bytes << std::setw(14) << frameTotal.frees << std::endl;
+}
+
+void allocTracker::resetTotals() {
+	total = AllocCounters();
+	trackedFrames = 0;
+	allocatingFrames = 0;
+}
+
+void allocTracker::printSummary(std::ostream& out) {
+	double frames = (double)std::max(trackedFrames, 1LL);
+	out << std::fixed << std::setprecision(1);
+	out << "Heap allocations: " << allocatingFrames << " of " << trackedFrames << " frames allocated, "
+		<< total.allocations / frames << " allocations and " << total.bytes / frames << " bytes per frame" << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------
+// replaced global allocation functions, the aligned forms are left to the library
+
+void* operator new(std::size_t size) {
+	allocTracker::count(size);
+	void* memory = malloc(size > 0 ? size : 1);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	allocTracker::count(size);
+	return malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+	return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept {
+	if (memory == NULL)
+		return;
+	allocTracker::countFree();
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+	operator delete(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+	operator delete(memory);
+}
+
+#endif
@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       allocTracker.h
+ * \author     rka Prokopov
+ * \date       2025/5/23
+ * \brief      Heap allocations of every frame counted by subsystem, built only with
+ *				ALLOC_TRACKING defined - the global operator new and delete are replaced
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __ALLOC_TRACKER_H
+#define __ALLOC_TRACKER_H
+
+#include <cstddef>
+
+// allocations of one frame, of one subsystem or all of them
+typedef struct AllocCounters {
+	long long allocations = 0;
+	long long bytes = 0;
+	long long frees = 0;
+} AllocCounters;
+
+// frames filling caches and growing buffers before the steady state is measured
+const int ALLOC_WARMUP_FRAMES = 30;
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+
+#ifdef ALLOC_TRACKING
+
+#include <atomic>
+#include <ostream>
+
+const int ALLOC_MAX_TAGS = 64;   // subsystems, more are counted as untagged
+
+/// <summary>
+/// counts of the current and the last finished frame per tag - a tag is the innermost
+/// ALLOC_SCOPE of the allocating thread, allocations outside of any scope are untagged
+/// </summary>
+class allocTracker {
+public:
+	static void count(size_t size);
+	static void countFree();
+	static int getTag(const char* name);   // registers the name the first time
+	static int setTag(int tag);            // returns the previous tag of the thread
+
+	static void endFrame();   // every dumpInterval frames the last frame is printed
+	static void setDumpInterval(int frames) { dumpInterval = frames; }
+	static AllocCounters getFrame();   // all tags of the last frame
+	static void printReport(std::ostream& out);
+
+	// frames since the reset, the steady state goal is none of them allocating
+	static void resetTotals();
+	static void printSummary(std::ostream& out);
+
+private:
+	static std::atomic<long long> allocations[ALLOC_MAX_TAGS];
+	static std::atomic<long long> bytes[ALLOC_MAX_TAGS];
+	static std::atomic<long long> frees[ALLOC_MAX_TAGS];
+	static AllocCounters last[ALLOC_MAX_TAGS];
+	static AllocCounters total;
+	static const char* names[ALLOC_MAX_TAGS];
+	static std::atomic<int> tagCount;
+	static int dumpInterval;
+	static long long frame;
+	static long long trackedFrames;
+	static long long allocatingFrames;
+};
+
+/// <summary>
+/// tags the allocations of the calling thread until the end of the scope, scopes nest
+/// </summary>
+class allocScope {
+public:
+	allocScope(const char* name) { previous = allocTracker::setTag(allocTracker::getTag(name)); }
+	~allocScope() { allocTracker::setTag(previous); }
+
+private:
+	int previous;
+};
+
+#define ALLOC_SCOPE(name) allocScope ALLOC_CONCAT(allocScope, __LINE__)(name)
+#define ALLOC_FRAME() allocTracker::endFrame()
+#define ALLOC_DUMP_EVERY(frames) allocTracker::setDumpInterval(frames)
+#define ALLOC_LAST_FRAME() allocTracker::getFrame()
+#define ALLOC_RESET_TOTALS() allocTracker::resetTotals()
+#define ALLOC_PRINT_SUMMARY(out) allocTracker::printSummary(out)
+
+#else
+
+#define ALLOC_SCOPE(name) ((void)0)
+#define ALLOC_FRAME() ((void)0)
+#define ALLOC_DUMP_EVERY(frames) ((void)0)
+#define ALLOC_LAST_FRAME() AllocCounters()
+#define ALLOC_RESET_TOTALS() ((void)0)
+#define ALLOC_PRINT_SUMMARY(out) ((void)0)
+
+#endif
+
+#endif
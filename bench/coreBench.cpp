@@ -0,0 +1,264 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       coreBench.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/19
+ * \brief      Micro-benchmarks of the CPU math of the core (splines, alignment, normal
+ *				matrix, camera, config parsing, frame scratch), built by CMakeLists.txt,
+ *				usage: coreBench [filter] [samples]
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "../spline.h"
+#include "../camera.h"
+#include "../transform.h"
+#include "../configLoader.h"
+#include "../frameArena.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// defined by the application, camera.cpp only reads it
+float teleportSpeed = 0.2f;
+
+const double BENCH_BATCH_MS = 5.0;    // one sample runs the body at least this long
+const int BENCH_INPUTS = 4096;        // parameters cycled by the bodies, power of two
+
+// results of one benchmark, times in nanoseconds per operation
+typedef struct BenchResult {
+	double mean;
+	double confidence;   // half width of the 95 % confidence interval of the mean
+	double median;
+	long long iterations;   // per sample
+} BenchResult;
+
+// keeps results alive so the compiler cannot drop the measured calls
+static volatile float sink;
+
+static void consume(const glm::vec3& value) {
+	sink = sink + value.x + value.y + value.z;
+}
+
+static void consume(const glm::mat4& value) {
+	sink = sink + value[0][0] + value[1][1] + value[2][2] + value[3][0];
+}
+
+// two sided Student t quantile for 95 %, normal approximation above 30 degrees of freedom
+static double studentT95(int degrees) {
+	static const double table[30] = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+	};
+	if (degrees < 1)
+		return 0.0;
+	return degrees <= 30 ? table[degrees - 1] : 1.960;
+}
+
+// body(iterations) performs that many operations, the batch size is doubled until one batch
+// takes BENCH_BATCH_MS, then every sample times one batch
+template <typename Body>
+static BenchResult measure(Body body, int samples) {
+	typedef std::chrono::steady_clock clock;
+	long long iterations = 1;
+	for (;;) {
+		clock::time_point start = clock::now();
+		body(iterations);
+		double elapsed = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+		if (elapsed >= BENCH_BATCH_MS || iterations >= (1LL << 40))
+			break;
+		iterations *= 2;
+	}
+
+	std::vector<double> times;
+	for (int i = 0; i < samples; i++) {
+		clock::time_point start = clock::now();
+		body(iterations);
+		times.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count() / iterations);
+	}
+
+	BenchResult result;
+	result.iterations = iterations;
+	result.mean = 0.0;
+	for (size_t i = 0; i < times.size(); i++)
+		result.mean += times[i];
+	result.mean /= times.size();
+	double variance = 0.0;
+	for (size_t i = 0; i < times.size(); i++)
+		variance += (times[i] - result.mean) * (times[i] - result.mean);
+	variance /= times.size() > 1 ? times.size() - 1 : 1;
+	result.confidence = studentT95((int)times.size() - 1) * sqrt(variance / times.size());
+	std::sort(times.begin(), times.end());
+	result.median = times[times.size() / 2];
+	return result;
+}
+
+static void report(const std::string& name, long long inputSize, const BenchResult& result) {
+	std::cout << std::left << std::setw(28) << name << std::right
+		<< std::setw(10) << inputSize
+		<< std::setw(14) << result.mean
+		<< std::setw(12) << result.confidence
+		<< std::setw(9) << (result.mean > 0.0 ? 100.0 * result.confidence / result.mean : 0.0)
+		<< std::setw(14) << result.median
+		<< std::setw(12) << result.iterations << std::endl;
+}
+
+static bool selected(const char* filter, const std::string& name) {
+	return filter == NULL || name.find(filter) != std::string::npos;
+}
+
+// closed loop of control points around the lake with some noise
+static std::vector<glm::vec3> makeCurve(size_t count, std::mt19937& random) {
+	std::uniform_real_distribution<float> noise(-0.1f, 0.1f);
+	std::vector<glm::vec3> points(count);
+	for (size_t i = 0; i < count; i++) {
+		float angle = 6.2831853f * i / count;
+		points[i] = glm::vec3(2.0f * cos(angle) + noise(random), 2.0f * sin(angle) + noise(random), 1.0f + noise(random));
+	}
+	return points;
+}
+
+// objects in the format of data/config.txt
+static std::string writeConfig(int objects, std::mt19937& random) {
+	std::uniform_real_distribution<float> value(-3.0f, 3.0f);
+	std::string fileName = "coreBench_config.txt";
+	std::ofstream file(fileName);
+	file << std::fixed << std::setprecision(3);
+	for (int i = 0; i < objects; i++) {
+		file << "[object" << i << "]\n"
+			<< "front=" << value(random) << "," << value(random) << "," << value(random) << "\n"
+			<< "up=0.0,0.0,1.0\n"
+			<< "position=" << value(random) << "," << value(random) << "," << value(random) << "\n"
+			<< "size=" << fabs(value(random)) << "\n"
+			<< "angle=" << value(random) << "\n"
+			<< "align=" << (i % 2 ? "true" : "false") << "\n\n";
+	}
+	return fileName;
+}
+
+int main(int argc, char** argv) {
+	const char* filter = argc > 1 && strcmp(argv[1], "all") != 0 ? argv[1] : NULL;
+	int samples = argc > 2 ? std::max(atoi(argv[2]), 2) : 30;
+
+	std::mt19937 random(2025);
+	std::uniform_real_distribution<float> unit(0.0f, 0.9999f);
+	std::uniform_real_distribution<float> coordinate(-3.0f, 3.0f);
+	std::vector<float> parameters(BENCH_INPUTS);
+	for (int i = 0; i < BENCH_INPUTS; i++)
+		parameters[i] = unit(random);
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(10) << "input"
+		<< std::setw(14) << "ns/op" << std::setw(12) << "+- 95%" << std::setw(9) << "%"
+		<< std::setw(14) << "median" << std::setw(12) << "batch" << std::endl;
+
+	// the scene curves are short, the long ones show what happens once they leave the cache
+	const size_t curveSizes[] = { duckCurvePointsTotal, curveSize, 1024, 1 << 20 };
+	splineHandler spline;
+	for (size_t size : curveSizes) {
+		std::vector<glm::vec3> curve = makeCurve(size, random);
+		if (selected(filter, "evaluateClosedCurve")) {
+			report("evaluateClosedCurve", size, measure([&](long long iterations) {
+				for (long long i = 0; i < iterations; i++)
+					consume(spline.evaluateClosedCurve(curve.data(), curve.size(), parameters[i & (BENCH_INPUTS - 1)]));
+			}, samples));
+		}
+		if (selected(filter, "evaluateMovementCurve")) {
+			report("evaluateMovementCurve", size, measure([&](long long iterations) {
+				for (long long i = 0; i < iterations; i++)
+					consume(spline.evaluateMovementCurve(curve.data(), curve.size(), parameters[i & (BENCH_INPUTS - 1)]));
+			}, samples));
+		}
+	}
+
+	std::vector<glm::vec3> positions(BENCH_INPUTS), fronts(BENCH_INPUTS);
+	std::vector<glm::mat4> models(BENCH_INPUTS);
+	for (int i = 0; i < BENCH_INPUTS; i++) {
+		positions[i] = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+		fronts[i] = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+	}
+	for (int i = 0; i < BENCH_INPUTS; i++) {
+		glm::mat4 model = splineHandler::alignObject(positions[i], fronts[i], glm::vec3(0.0f, 0.0f, 1.0f));
+		models[i] = glm::scale(model, glm::vec3(0.5f + unit(random), 0.5f + unit(random), 0.5f + unit(random)));
+	}
+
+	if (selected(filter, "alignObject")) {
+		report("alignObject", BENCH_INPUTS, measure([&](long long iterations) {
+			for (long long i = 0; i < iterations; i++) {
+				int input = (int)(i & (BENCH_INPUTS - 1));
+				consume(splineHandler::alignObject(positions[input], fronts[input], glm::vec3(0.0f, 0.0f, 1.0f)));
+			}
+		}, samples));
+	}
+	if (selected(filter, "normalMatrix")) {
+		report("normalMatrix", BENCH_INPUTS, measure([&](long long iterations) {
+			for (long long i = 0; i < iterations; i++)
+				consume(transformHandler::normalMatrix(models[i & (BENCH_INPUTS - 1)]));
+		}, samples));
+	}
+	if (selected(filter, "computeCenterView")) {
+		cameraHandler cameraControl;
+		Camera camera = Camera();
+		GameUniformVariables uniforms = GameUniformVariables();
+		report("computeCenterView", BENCH_INPUTS, measure([&](long long iterations) {
+			for (long long i = 0; i < iterations; i++) {
+				int input = (int)(i & (BENCH_INPUTS - 1));
+				camera.position = positions[input];
+				camera.direction = glm::normalize(fronts[input]);
+				camera.elevationAngle = 40.0f * parameters[input];
+				glm::vec3 up(0.0f, 0.0f, 1.0f);
+				consume(cameraControl.computeCenterView(&camera, &uniforms, &up));
+			}
+		}, samples));
+	}
+
+	// one operation is one frame of scratch - a list filled without reserve, like culling results
+	const int scratchSizes[] = { 64, 1024, 16384 };
+	for (int items : scratchSizes) {
+		if (selected(filter, "scratchHeap")) {
+			report("scratchHeap", items, measure([&](long long iterations) {
+				for (long long i = 0; i < iterations; i++) {
+					std::vector<glm::vec4> scratch;
+					for (int j = 0; j < items; j++)
+						scratch.push_back(glm::vec4((float)j));
+					sink = sink + scratch.back().x;
+				}
+			}, samples));
+		}
+		if (selected(filter, "scratchArena")) {
+			frameArena arena;
+			report("scratchArena", items, measure([&](long long iterations) {
+				for (long long i = 0; i < iterations; i++) {
+					arena.reset();
+					arenaVector<glm::vec4> scratch(&arena);
+					for (int j = 0; j < items; j++)
+						scratch.push_back(glm::vec4((float)j));
+					sink = sink + scratch.back().x;
+				}
+			}, samples));
+		}
+	}
+
+	// one operation is one whole file, seven lines per object
+	const int configSizes[] = { 10, 1000, 20000 };
+	for (int objects : configSizes) {
+		if (!selected(filter, "loadConfig"))
+			break;
+		std::string fileName = writeConfig(objects, random);
+		report("loadConfig", objects, measure([&](long long iterations) {
+			for (long long i = 0; i < iterations; i++)
+				sink = sink + (float)loadConfig(fileName).size();
+		}, samples));
+		remove(fileName.c_str());
+	}
+	return 0;
+}
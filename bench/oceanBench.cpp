@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       oceanBench.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/2
+ * \brief      Benchmark of one ocean simulation step (spectrum + FFT + maps) without GL,
+ *				usage: oceanBench [threads] [steps]
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "../oceanFFT.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+int main(int argc, char** argv) {
+	int threads = argc > 1 ? atoi(argv[1]) : 0;
+	int steps = argc > 2 ? atoi(argv[2]) : 200;
+	const int warmup = 10;
+
+	std::cout << "resolution\tthreads\tmean ms\tstddev ms" << std::endl;
+	for (int resolution = OCEAN_MIN_RESOLUTION; resolution <= OCEAN_MAX_RESOLUTION; resolution *= 2) {
+		oceanSimulator ocean;
+		ocean.init(resolution, 4.0f, 0.02f, 0.8f, threads);
+
+		float time = 0.0f;
+		for (int i = 0; i < warmup; i++, time += 0.033f)
+			ocean.simulate(time);
+
+		std::vector<double> samples;
+		for (int i = 0; i < steps; i++, time += 0.033f) {
+			auto start = std::chrono::steady_clock::now();
+			ocean.simulate(time);
+			auto end = std::chrono::steady_clock::now();
+			samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		double mean = 0.0;
+		for (size_t i = 0; i < samples.size(); i++)
+			mean += samples[i];
+		mean /= samples.size();
+		double variance = 0.0;
+		for (size_t i = 0; i < samples.size(); i++)
+			variance += (samples[i] - mean) * (samples[i] - mean);
+		variance /= samples.size() > 1 ? samples.size() - 1 : 1;
+
+		std::cout << resolution << "\t\t" << ocean.getThreadCount() << "\t" << mean << "\t" << sqrt(variance) << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,173 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       buoyancy.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/8
+ * \brief      Floating props - bilinear height sampling of all hull points (SSE when
+ *				available) and spring-damper integration of heave, pitch and roll
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "buoyancy.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BUOYANCY_SIMD 1
+#endif
+
+// body hull is a cross of points around its rest position, returns body index
+int buoyancySystem::addBody(const glm::vec3& position, float extent) {
+	int body = (int)restPosition.size();
+	restPosition.push_back(position);
+	halfExtent.push_back(extent);
+	heave.push_back(0.0f);
+	heaveVelocity.push_back(0.0f);
+	pitch.push_back(0.0f);
+	pitchVelocity.push_back(0.0f);
+	roll.push_back(0.0f);
+	rollVelocity.push_back(0.0f);
+
+	const float offsetX[BUOYANCY_HULL_POINTS] = { 0.0f, 1.0f, -1.0f, 0.0f, 0.0f };
+	const float offsetY[BUOYANCY_HULL_POINTS] = { 0.0f, 0.0f, 0.0f, 1.0f, -1.0f };
+	size_t count = (size_t)(body + 1) * BUOYANCY_HULL_POINTS;
+	size_t padded = (count + 3) & ~(size_t)3;
+	pointX.resize(padded, 0.0f);
+	pointY.resize(padded, 0.0f);
+	pointHeight.resize(padded, 0.0f);
+	for (int i = 0; i < BUOYANCY_HULL_POINTS; i++) {
+		pointX[body * BUOYANCY_HULL_POINTS + i] = position.x + offsetX[i] * extent;
+		pointY[body * BUOYANCY_HULL_POINTS + i] = position.y + offsetY[i] * extent;
+	}
+	return body;
+}
+
+void buoyancySystem::clear() {
+	restPosition.clear();
+	halfExtent.clear();
+	heave.clear();
+	heaveVelocity.clear();
+	pitch.clear();
+	pitchVelocity.clear();
+	roll.clear();
+	rollVelocity.clear();
+	pointX.clear();
+	pointY.clear();
+	pointHeight.clear();
+}
+
+// keep height channel of the ocean displacement map (dx, dy, height, 0)
+void buoyancySystem::setHeightField(const float* displacement, int newResolution, float newPatchSize) {
+	resolution = newResolution;
+	patchSize = newPatchSize;
+	heights.resize((size_t)resolution * resolution);
+	for (size_t i = 0; i < heights.size(); i++) {
+		heights[i] = displacement[4 * i + 2];
+	}
+}
+
+// range of bodies can be updated in parallel with other ranges when they start at batch boundary
+void buoyancySystem::updateBodies(float deltaTime, int first, int last) {
+	if (restPosition.empty() || resolution == 0 || first >= last)
+		return;
+
+	// batch of four bodies has twenty hull points, five whole groups
+	size_t pointEnd = (size_t)last * BUOYANCY_HULL_POINTS;
+	pointEnd = last == getBodyCount() ? pointX.size() : (pointEnd + 3) & ~(size_t)3;
+	sampleHeights((size_t)first * BUOYANCY_HULL_POINTS, pointEnd);
+	while (deltaTime > 0.0f) {
+		float step = std::min(deltaTime, BUOYANCY_MAX_STEP);
+		integrate(step, first, last);
+		deltaTime -= step;
+	}
+}
+
+// bilinear height of hull points, four points at once
+void buoyancySystem::sampleHeights(size_t pointBegin, size_t pointEnd) {
+	const float scale = resolution / patchSize;
+	const int mask = resolution - 1; // resolution is power of two, wraps negative indices too
+
+	for (size_t i = pointBegin; i < pointEnd; i += 4) {
+		float fracX[4], fracY[4];
+		int cellX[4], cellY[4];
+#ifdef BUOYANCY_SIMD
+		__m128 gx = _mm_mul_ps(_mm_loadu_ps(&pointX[i]), _mm_set1_ps(scale));
+		__m128 gy = _mm_mul_ps(_mm_loadu_ps(&pointY[i]), _mm_set1_ps(scale));
+		// floor - truncation rounds negative values up
+		__m128i ix = _mm_cvttps_epi32(gx);
+		__m128i iy = _mm_cvttps_epi32(gy);
+		ix = _mm_add_epi32(ix, _mm_castps_si128(_mm_cmplt_ps(gx, _mm_cvtepi32_ps(ix))));
+		iy = _mm_add_epi32(iy, _mm_castps_si128(_mm_cmplt_ps(gy, _mm_cvtepi32_ps(iy))));
+		_mm_storeu_ps(fracX, _mm_sub_ps(gx, _mm_cvtepi32_ps(ix)));
+		_mm_storeu_ps(fracY, _mm_sub_ps(gy, _mm_cvtepi32_ps(iy)));
+		_mm_storeu_si128((__m128i*)cellX, ix);
+		_mm_storeu_si128((__m128i*)cellY, iy);
+#else
+		for (int k = 0; k < 4; k++) {
+			float gx = pointX[i + k] * scale;
+			float gy = pointY[i + k] * scale;
+			cellX[k] = (int)floor(gx);
+			cellY[k] = (int)floor(gy);
+			fracX[k] = gx - cellX[k];
+			fracY[k] = gy - cellY[k];
+		}
+#endif
+		float h00[4], h10[4], h01[4], h11[4];
+		for (int k = 0; k < 4; k++) {
+			int x0 = cellX[k] & mask;
+			int x1 = (cellX[k] + 1) & mask;
+			int y0 = (cellY[k] & mask) * resolution;
+			int y1 = ((cellY[k] + 1) & mask) * resolution;
+			h00[k] = heights[y0 + x0];
+			h10[k] = heights[y0 + x1];
+			h01[k] = heights[y1 + x0];
+			h11[k] = heights[y1 + x1];
+		}
+#ifdef BUOYANCY_SIMD
+		__m128 fx = _mm_loadu_ps(fracX);
+		__m128 fy = _mm_loadu_ps(fracY);
+		__m128 a = _mm_loadu_ps(h00);
+		__m128 b = _mm_loadu_ps(h01);
+		__m128 bottom = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(h10), a), fx));
+		__m128 top = _mm_add_ps(b, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(h11), b), fx));
+		_mm_storeu_ps(&pointHeight[i], _mm_add_ps(bottom, _mm_mul_ps(_mm_sub_ps(top, bottom), fy)));
+#else
+		for (int k = 0; k < 4; k++) {
+			float bottom = h00[k] + (h10[k] - h00[k]) * fracX[k];
+			float top = h01[k] + (h11[k] - h01[k]) * fracX[k];
+			pointHeight[i + k] = bottom + (top - bottom) * fracY[k];
+		}
+#endif
+	}
+}
+
+// spring-damper towards surface height and slope under the hull
+void buoyancySystem::integrate(float deltaTime, int first, int last) {
+	for (int body = first; body < last; body++) {
+		const float* h = &pointHeight[body * BUOYANCY_HULL_POINTS];
+		float targetHeave = (h[0] + h[1] + h[2] + h[3] + h[4]) * 0.2f;
+		float targetPitch = -atan((h[1] - h[2]) / (2.0f * halfExtent[body]));
+		float targetRoll = atan((h[3] - h[4]) / (2.0f * halfExtent[body]));
+
+		heaveVelocity[body] += (BUOYANCY_STIFFNESS * (targetHeave - heave[body]) - BUOYANCY_DAMPING * heaveVelocity[body]) * deltaTime;
+		pitchVelocity[body] += (BUOYANCY_STIFFNESS * (targetPitch - pitch[body]) - BUOYANCY_DAMPING * pitchVelocity[body]) * deltaTime;
+		rollVelocity[body] += (BUOYANCY_STIFFNESS * (targetRoll - roll[body]) - BUOYANCY_DAMPING * rollVelocity[body]) * deltaTime;
+
+		heave[body] += heaveVelocity[body] * deltaTime;
+		pitch[body] += pitchVelocity[body] * deltaTime;
+		roll[body] += rollVelocity[body] * deltaTime;
+	}
+}
+
+// transformation applied before model matrix of the body, rotates around its rest position
+glm::mat4 buoyancySystem::getMotion(int body) {
+	if (body < 0 || body >= (int)restPosition.size())
+		return glm::mat4(1.0f);
+
+	glm::vec3 position = restPosition[body];
+	glm::mat4 motion = glm::translate(glm::mat4(1.0f), position + glm::vec3(0.0f, 0.0f, heave[body]));
+	motion = glm::rotate(motion, pitch[body], glm::vec3(0.0f, 1.0f, 0.0f));
+	motion = glm::rotate(motion, roll[body], glm::vec3(1.0f, 0.0f, 0.0f));
+	return glm::translate(motion, -position);
+}
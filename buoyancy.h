@@ -0,0 +1,64 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       buoyancy.h
+ * \author     rka Prokopov
+ * \date       2025/5/8
+ * \brief      Floating props - hull points of all bodies sampled in one batch
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __BUOYANCY_H
+#define __BUOYANCY_H
+
+#include "pgr.h"
+#include <vector>
+
+const int BUOYANCY_HULL_POINTS = 5;       // center, front, back, left, right
+const float BUOYANCY_STIFFNESS = 30.0f;   // spring towards water surface
+const float BUOYANCY_DAMPING = 5.0f;
+const float BUOYANCY_MAX_STEP = 0.05f;    // longer frames are integrated in parts
+const int BUOYANCY_BODY_BATCH = 4;        // bodies whose hull points fill whole SIMD groups
+
+/// <summary>
+/// floating bodies bob on the ocean height field, hull points are stored as arrays
+/// of coordinates so all bodies are sampled together, then heave, pitch and roll
+/// follow the surface as spring-dampers
+/// </summary>
+class buoyancySystem {
+public:
+	buoyancySystem() : resolution(0), patchSize(1.0f) {}
+
+	int addBody(const glm::vec3& restPosition, float halfExtent);
+	void clear();
+	void setHeightField(const float* displacement, int resolution, float patchSize);
+	void update(float deltaTime) { updateBodies(deltaTime, 0, getBodyCount()); }
+	void updateBodies(float deltaTime, int first, int last);  // first is multiple of BUOYANCY_BODY_BATCH
+	glm::mat4 getMotion(int body);
+	int getBodyCount() { return (int)restPosition.size(); }
+
+private:
+	void sampleHeights(size_t pointBegin, size_t pointEnd);
+	void integrate(float deltaTime, int first, int last);
+
+	// height field copy, workers may already compute the next step
+	std::vector<float> heights;
+	int resolution;
+	float patchSize;
+
+	// hull points, padded to multiple of four
+	std::vector<float> pointX;
+	std::vector<float> pointY;
+	std::vector<float> pointHeight;
+
+	// bodies
+	std::vector<glm::vec3> restPosition;
+	std::vector<float> halfExtent;
+	std::vector<float> heave;
+	std::vector<float> heaveVelocity;
+	std::vector<float> pitch;
+	std::vector<float> pitchVelocity;
+	std::vector<float> roll;
+	std::vector<float> rollVelocity;
+};
+
+#endif
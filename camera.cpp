@@ -9,6 +9,7 @@
 */
 //-----------------------------------------------------------------------------------------
 #include "camera.h"
+#include <algorithm>
 
 
 // positions for static camera and their center 
@@ -42,13 +43,23 @@ void cameraHandler::changePosition(bool* cameraPosition) {
 
 }
 
+// tilts the horizontal direction up or down by the elevation angle
+static glm::mat4 elevationTransform(const Camera* camera) {
+	glm::vec3 rotationAxis = glm::cross(camera->direction, glm::vec3(0.0f, 0.0f, 1.0f));
+	return glm::rotate(glm::mat4(1.0f), -glm::radians(camera->elevationAngle), rotationAxis);
+}
+
+// where the camera looks, without touching the reflector uniforms
+glm::vec3 cameraHandler::getViewDirection(const Camera* camera) {
+	return glm::vec3(elevationTransform(camera) * glm::vec4(camera->direction, 0.0f));
+}
+
 // computing center view
 glm::vec3  cameraHandler::computeCenterView(Camera* camera, GameUniformVariables* gameUniVars, glm::vec3* cameraUpVector) {
 	glm::vec3 cameraCenter;
 	glm::vec3 cameraViewDirection = camera->direction;
 
-	glm::vec3 rotationAxis = glm::cross(cameraViewDirection, glm::vec3(0.0f, 0.0f, 1.0f));
-	glm::mat4 cameraTransform = glm::rotate(glm::mat4(1.0f), -glm::radians(camera->elevationAngle), rotationAxis);
+	glm::mat4 cameraTransform = elevationTransform(camera);
 
 	*cameraUpVector = glm::vec3(cameraTransform * glm::vec4(*cameraUpVector, 0.0f));
 	cameraViewDirection = glm::vec3(cameraTransform * glm::vec4(cameraViewDirection, 0.0f));
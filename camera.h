@@ -12,7 +12,7 @@
 #define __CAMERA_POSITION_H
 #include <time.h>
 #include "pgr.h"
-#include "render_stuff.h"
+#include "utilStructures.h"
 
 // booleans
 // teleport speed for cam changes
@@ -29,6 +29,7 @@ class cameraHandler {
 public:
 	cameraHandler() = default;
 	glm::vec3 computeCenterView(Camera* camera, GameUniformVariables* gameUniVars, glm::vec3* cameraUpVector);
+	static glm::vec3 getViewDirection(const Camera* camera);
 	void computeCameraPosition(GameState& gameState);
 	void changePosition(bool* cameraPosition);
 	void increaseCameraSpeed(Camera* camera, float deltaSpeed);
@@ -38,8 +39,8 @@ public:
 	void turnCamera(Camera* camera, float deltaAngle);
 	void controlBorders(Camera* camera);
 	bool vectorDif(glm::vec3 t, glm::vec3 b);
-	void cameraHandler::moveCamUp(Camera* camera, float distance);
-	void cameraHandler::moveCamDown(Camera* camera, float distance);
+	void moveCamUp(Camera* camera, float distance);
+	void moveCamDown(Camera* camera, float distance);
 };
 
 #endif 
\ No newline at end of file
@@ -90,6 +90,12 @@ std::map<std::string, ObjectProp> loadConfig(const std::string& filename) {
                 else if (key == "align") {
                     obj.align = (value == "true" || value == "1");
                 }
+                else if (key == "float") {
+                    obj.floating = (value == "true" || value == "1");
+                }
+                else if (key == "model") {
+                    obj.model = value;
+                }
                 else {
                     std::cerr << "Warning: " << lineNumber << ": unknown key '" << key << "'." << std::endl;
                 }
@@ -101,4 +107,144 @@ std::map<std::string, ObjectProp> loadConfig(const std::string& filename) {
     }
 
     return objects;
-}
\ No newline at end of file
+}
+
+GameSettings loadSettings(const std::string& filename) {
+    GameSettings settings;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Warning: file '" << filename << "' is unable to load, using default settings" << std::endl;
+        return settings;
+    }
+
+    std::string line;
+    std::string currentSection;
+
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t") + 1);
+
+        if (line.empty() || line[0] == '#') continue;
+
+        if (line[0] == '[' && line.back() == ']') {
+            currentSection = line.substr(1, line.size() - 2);
+            continue;
+        }
+
+        auto delimiterPos = line.find('=');
+        if (delimiterPos == std::string::npos) {
+            std::cerr << "Settings on line " << lineNumber << ": expected '='." << std::endl;
+            continue;
+        }
+
+        std::string key = currentSection + "." + line.substr(0, delimiterPos);
+        std::string value = line.substr(delimiterPos + 1);
+
+        try {
+            if (key == "water.fftResolution") {
+                settings.oceanResolution = std::stoi(value);
+            }
+            else if (key == "water.patchSize") {
+                settings.oceanPatchSize = std::stof(value);
+            }
+            else if (key == "water.amplitude") {
+                settings.oceanAmplitude = std::stof(value);
+            }
+            else if (key == "water.choppiness") {
+                settings.oceanChoppiness = std::stof(value);
+            }
+            else if (key == "water.threads") {
+                settings.oceanThreads = std::stoi(value);
+            }
+            else if (key == "water.quality") {
+                if (value == "low")
+                    settings.waterQuality = WATER_QUALITY_LOW;
+                else if (value == "medium")
+                    settings.waterQuality = WATER_QUALITY_MEDIUM;
+                else if (value == "high")
+                    settings.waterQuality = WATER_QUALITY_HIGH;
+                else
+                    std::cerr << "Warning: " << lineNumber << ": unknown water quality '" << value << "'." << std::endl;
+            }
+            else if (key == "water.probeSize") {
+                settings.probeSize = std::stoi(value);
+            }
+            else if (key == "water.layered") {
+                settings.layeredWater = (value == "true" || value == "1");
+            }
+            else if (key == "render.maxFps") {
+                settings.maxFrameRate = std::stoi(value);
+            }
+            else if (key == "render.thread") {
+                settings.renderThread = (value == "true" || value == "1");
+            }
+            else if (key == "jobs.threads") {
+                settings.jobThreads = std::stoi(value);
+            }
+            else if (key == "headless.frames") {
+                settings.headlessFrames = std::stoi(value);
+            }
+            else if (key == "headless.width") {
+                settings.headlessWidth = std::stoi(value);
+            }
+            else if (key == "headless.height") {
+                settings.headlessHeight = std::stoi(value);
+            }
+            else if (key == "headless.camera") {
+                settings.headlessCamera = value;
+            }
+            else if (key == "headless.report") {
+                settings.headlessReport = value;
+            }
+            else if (key == "headless.startupReport") {
+                settings.startupReport = value;
+            }
+            else if (key == "headless.sweepCounts") {
+                settings.sweepCounts = value;
+            }
+            else if (key == "headless.sweepFrames") {
+                settings.sweepFrames = std::stoi(value);
+            }
+            else if (key == "headless.sweepDistribution") {
+                settings.sweepDistribution = value;
+            }
+            else if (key == "headless.sweepReport") {
+                settings.sweepReport = value;
+            }
+            else if (key == "flythrough.play") {
+                settings.flythroughs = value;
+            }
+            else if (key == "flythrough.rate") {
+                settings.flythroughRate = std::stoi(value);
+            }
+            else if (key == "flythrough.tolerance") {
+                settings.flythroughTolerance = std::stof(value);
+            }
+            else if (key == "flythrough.report") {
+                settings.flythroughReport = value;
+            }
+            else if (key == "stats.glCountersEvery") {
+                settings.glCountersEvery = std::stoi(value);
+            }
+            else if (key == "stats.allocEvery") {
+                settings.allocEvery = std::stoi(value);
+            }
+            else if (key == "stats.socket") {
+                settings.metricsSocket = value;
+            }
+            else if (key == "stats.interval") {
+                settings.metricsInterval = std::stoi(value);
+            }
+            else {
+                std::cerr << "Warning: " << lineNumber << ": unknown setting '" << key << "'." << std::endl;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << lineNumber << " parsing '" << key << "': " << e.what() << std::endl;
+        }
+    }
+
+    return settings;
+}
@@ -25,4 +25,11 @@
 /// <param name="filename"></param>
 /// <returns></returns>
 std::map<std::string, ObjectProp> loadConfig(const std::string& filename);
+
+/// <summary>
+/// loading file with application settings, missing file or keys keep defaults
+/// </summary>
+/// <param name="filename"></param>
+/// <returns></returns>
+GameSettings loadSettings(const std::string& filename);
 #endif
\ No newline at end of file
@@ -14,6 +14,7 @@
 #define WINDOW_HEIGHT  800
 #define WINDOW_TITLE   "PGR semestral"
 
+#include <string>
 #include "pgr.h"
 
 // keys used in the key map
@@ -88,9 +89,53 @@ typedef struct ObjectProp {
 	float         size;      // size of the object
 	float         angle;     // rotation angle in radians
 	bool          align;     // to use align method
+	bool          floating = false;  // object bobs on the waves
+	int           buoyancyBody = -1; // index in buoyancy system, set after loading
+	std::string   model;             // mesh of a generated prop, props of the scene have none
 
 } ObjectProp;
 
+// water quality - high keeps planar reflection, medium uses reflection probe,
+// low uses probe and skips refraction pass
+const int WATER_QUALITY_LOW = 0;
+const int WATER_QUALITY_MEDIUM = 1;
+const int WATER_QUALITY_HIGH = 2;
+
+//struct for application settings, they are loaded from settings.txt
+typedef struct GameSettings {
+
+	int           waterQuality = WATER_QUALITY_HIGH;
+	int           probeSize = 256;         // resolution of one reflection probe face
+	int           oceanResolution = 128;   // FFT grid size, power of two 64-512
+	float         oceanPatchSize = 4.0f;   // world size of one repeated wave tile
+	float         oceanAmplitude = 0.02f;  // average height of the waves
+	float         oceanChoppiness = 0.8f;  // horizontal displacement of the crests
+	int           oceanThreads = 0;        // worker threads, 0 = use all cores but one
+	bool          layeredWater = false;    // reflection and refraction in one geometry shader pass
+	int           maxFrameRate = 0;        // frames per second cap, 0 = as fast as vsync allows
+	bool          renderThread = false;    // simulation on its own thread, GLUT thread only draws
+	int           jobThreads = 0;          // job system workers, 0 = use all cores but one
+	int           headlessFrames = 300;    // frames drawn by the headless benchmark
+	int           headlessWidth = 1280;    // size of its offscreen framebuffer
+	int           headlessHeight = 720;
+	std::string   headlessCamera = "data/benchCamera.txt";  // keyframes of the scripted camera
+	std::string   headlessReport = "benchReport.json";      // machine readable results
+	std::string   startupReport = "startupReport.json";     // asset loading stages of --startup
+	std::string   sweepCounts = "0,1000,10000,100000";      // generated props of the --sweep runs
+	int           sweepFrames = 120;                        // frames drawn for every count
+	std::string   sweepDistribution = "uniform";
+	std::string   sweepReport = "sweepReport.csv";
+	std::string   flythroughs = "house,lake,hat";         // named paths played by v and --flythrough
+	int           flythroughRate = 60;                      // frames per second of virtual time
+	float         flythroughTolerance = 0.01f;              // largest distance of a fitted path from the flight
+	std::string   flythroughReport = "flythroughReport.json";
+	int           glCountersEvery = 0;     // frames between GL call dumps, builds with GL_COUNTERS only
+	int           allocEvery = 0;          // frames between heap allocation dumps, builds with ALLOC_TRACKING only
+	std::string   metricsSocket = "";      // Unix socket with live frame statistics, empty = off
+	int           metricsInterval = 500;   // milliseconds between two lines of statistics
+
+} GameSettings;
+
 // amount of points in curve for camera
 const size_t curveSize = 14;
 
@@ -119,17 +164,6 @@ const glm::vec3 curveData[] = {
 	 glm::vec3(-0.8, -1.65, 1.2),
 
 };
-// amount of vertices for banner
-const int barNumQuadVertices = 4;
-// vertices
-const float barVertexData[barNumQuadVertices * 5] = {
-	// x      y      z     u     v
-	-1.0f,  0.15f, 0.0f, 0.0f, 1.0f, // lev horn roh
-	-1.0f, -0.15f, 0.0f, 0.0f, 0.0f, // lev doln roh
-	 1.0f,  0.15f, 0.0f, 1.0f, 1.0f, // prav horn roh (u x bude zvisl na rychlosti)
-	 1.0f, -0.15f, 0.0f, 1.0f, 0.0f  // prav doln roh (u x bude zvisl na rychlosti)
-};
-
 // amount of vertexes for explosion
 const int explosionVertexCount = 4;
 // 4 vertices for explosion
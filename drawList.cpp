@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       drawList.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/12
+ * \brief      Scene recorded once per frame and replayed by every pass
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "drawList.h"
+#include "transform.h"
+#include <algorithm>
+#include <iostream>
+
+DrawItem& drawList::add(MeshGeometry* geometry, const glm::mat4& modelMatrix, int group, int stencil) {
+	items.emplace_back();
+	DrawItem& item = items.back();
+	item.geometry = geometry;
+	item.modelMatrix = modelMatrix;
+
+	item.normalMatrix = transformHandler::normalMatrix(modelMatrix);
+
+	float scale = std::max(glm::length(glm::vec3(modelMatrix[0])),
+		std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+	item.center = glm::vec3(modelMatrix[3]);
+	item.radius = DRAW_MODEL_RADIUS * scale;
+	item.group = group;
+	item.stencil = stencil;
+	item.secondTexture = false;
+	return item;
+}
+
+void drawList::addMeshes(std::vector<MeshGeometry*>& meshes, const glm::mat4& modelMatrix, int group, int stencil) {
+	for (size_t i = 0; i < meshes.size(); i++)
+		add(meshes[i], modelMatrix, group, stencil);
+}
+
+void passUniforms::init() {
+	cleanUp();
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	GLint blockSize = 2 * sizeof(glm::mat4);
+	slotSize = ((blockSize + alignment - 1) / alignment) * alignment;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, slotSize * PASS_BLOCK_SLOTS, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	nextSlot = 0;
+}
+
+void passUniforms::bind(GLuint program) {
+	GLuint index = glGetUniformBlockIndex(program, "PassBlock");
+	if (index == GL_INVALID_INDEX) {
+		std::cerr << "passUniforms: program " << program << " has no PassBlock" << std::endl;
+		return;
+	}
+	glUniformBlockBinding(program, index, PASS_BLOCK_BINDING);
+}
+
+void passUniforms::setPass(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) {
+	glm::mat4 block[2] = { viewMatrix, projectionMatrix * viewMatrix };
+	GLintptr offset = (GLintptr)slotSize * nextSlot;
+	nextSlot = (nextSlot + 1) % PASS_BLOCK_SLOTS;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(block), glm::value_ptr(block[0]));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferRange(GL_UNIFORM_BUFFER, PASS_BLOCK_BINDING, buffer, offset, sizeof(block));
+}
+
+void passUniforms::cleanUp() {
+	if (buffer != 0)
+		glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
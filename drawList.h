@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       drawList.h
+ * \author     rka Prokopov
+ * \date       2025/5/12
+ * \brief      Scene recorded once per frame and replayed by every pass
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __DRAW_LIST_H
+#define __DRAW_LIST_H
+
+#include <vector>
+#include "pgr.h"
+#include "utilStructures.h"
+
+const GLuint PASS_BLOCK_BINDING = 0;          // uniform buffer binding point of PassBlock
+const int PASS_BLOCK_SLOTS = 16;              // passes per frame before the buffer is reused
+const float DRAW_MODEL_RADIUS = 1.7320508f;   // loaders unitize models into (-1..1)^3
+
+// groups of items, passes pick which of them they draw
+const int DRAW_STATIC = 1;      // never moves, baked into the reflection probe
+const int DRAW_ANIMATED = 2;
+const int DRAW_ALL = DRAW_STATIC | DRAW_ANIMATED;
+
+// one mesh of the frame, matrices are computed when it is recorded
+typedef struct DrawItem {
+	MeshGeometry* geometry;
+	glm::mat4 modelMatrix;
+	glm::mat4 normalMatrix;
+	glm::vec3 center;      // world bounding sphere, negative radius is never culled
+	float radius;
+	int group;
+	int stencil;           // object id for mouse picking, 0 leaves stencil untouched
+	bool secondTexture;    // cube with grass over its own texture
+} DrawItem;
+
+// item that passed culling of one pass, sorted so that the same meshes and stencil ids
+// follow each other and their state is set once
+typedef struct DrawKey {
+	unsigned long long key;   // stencil id in the high half, vertex array in the low one
+	unsigned int item;
+
+	bool operator<(const DrawKey& other) const {
+		return key != other.key ? key < other.key : item < other.item;
+	}
+} DrawKey;
+
+/// <summary>
+/// meshes of the frame with their model and normal matrices
+/// </summary>
+class drawList {
+public:
+	void clear() { items.clear(); }
+	DrawItem& add(MeshGeometry* geometry, const glm::mat4& modelMatrix, int group, int stencil = 0);
+	void addMeshes(std::vector<MeshGeometry*>& meshes, const glm::mat4& modelMatrix, int group, int stencil = 0);
+
+	size_t size() const { return items.size(); }
+	const DrawItem& operator[](size_t i) const { return items[i]; }
+
+private:
+	std::vector<DrawItem> items;
+};
+
+/// <summary>
+/// uniform buffer with the view of each pass, std140 PassBlock { Vmatrix, PVmatrix },
+/// every pass writes its own slot so the driver never waits for the previous one
+/// </summary>
+class passUniforms {
+public:
+	passUniforms() : buffer(0), slotSize(0), nextSlot(0) {}
+
+	void init();
+	void bind(GLuint program);
+	void setPass(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+	void cleanUp();
+
+private:
+	GLuint buffer;
+	GLint slotSize;
+	int nextSlot;
+};
+
+#endif
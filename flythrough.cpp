@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       flythrough.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/22
+ * \brief      Recording and fitting of camera flythroughs
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "flythrough.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void flythroughRecorder::start() {
+	samples.clear();
+	recording = true;
+	std::cout << "flythrough: recording the free camera, press k again to stop" << std::endl;
+}
+
+void flythroughRecorder::addSample(float time, const glm::vec3& position, const glm::vec3& center) {
+	if (!recording)
+		return;
+	if (samples.empty())
+		startTime = time;
+	CameraKey sample = { time - startTime, position, center };
+	// keys of a script have to grow in time
+	if (!samples.empty() && sample.time <= samples.back().time)
+		return;
+	samples.push_back(sample);
+}
+
+std::string flythroughRecorder::stop(float tolerance) {
+	recording = false;
+	if (samples.size() < 2) {
+		std::cerr << "flythrough: recording is too short, nothing saved" << std::endl;
+		return "";
+	}
+	std::string name;
+	for (int i = 1; ; i++) {
+		name = "recorded" + std::to_string(i);
+		std::ifstream existing(getPath(name));
+		if (!existing.is_open())
+			break;
+	}
+
+	scriptedCamera path;
+	path.setKeys(fitKeys(samples, tolerance));
+	std::stringstream comment;
+	comment << "flythrough " << name << ", " << samples.size() << " samples fitted to "
+		<< path.getKeys().size() << " keys within " << tolerance;
+	if (!path.save(getPath(name), comment.str()))
+		return "";
+	std::cout << "flythrough: " << comment.str() << ", saved to " << getPath(name) << std::endl;
+	samples.clear();
+	return name;
+}
+
+// starts with the end samples only, then every segment whose worst sample is further than
+// the tolerance gets that sample as a new key - the keys move the neighbouring segments too,
+// so the check repeats until no sample is off
+std::vector<CameraKey> flythroughRecorder::fitKeys(const std::vector<CameraKey>& samples, float tolerance) {
+	if (samples.size() <= 2)
+		return samples;
+	std::vector<bool> kept(samples.size(), false);
+	kept.front() = kept.back() = true;
+
+	scriptedCamera path;
+	std::vector<CameraKey> keys;
+	bool added = true;
+	while (added) {
+		keys.clear();
+		for (size_t i = 0; i < samples.size(); i++)
+			if (kept[i])
+				keys.push_back(samples[i]);
+		path.setKeys(keys);
+
+		added = false;
+		size_t worst = 0;
+		float worstError = tolerance;
+		for (size_t i = 1; i < samples.size(); i++) {
+			if (kept[i]) { // end of the segment
+				if (worst > 0) {
+					kept[worst] = true;
+					added = true;
+				}
+				worst = 0;
+				worstError = tolerance;
+				continue;
+			}
+			glm::vec3 position, center;
+			path.evaluate(samples[i].time, position, center);
+			float error = glm::max(glm::distance(position, samples[i].position), glm::distance(center, samples[i].center));
+			if (error > worstError) {
+				worstError = error;
+				worst = i;
+			}
+		}
+	}
+	return keys;
+}
+
+std::string flythroughRecorder::getPath(const std::string& name) {
+	return std::string(FLYTHROUGH_DIRECTORY) + "/" + name + ".txt";
+}
+
+std::vector<std::string> flythroughRecorder::parseNames(const std::string& list) {
+	std::vector<std::string> names;
+	std::stringstream ss(list);
+	std::string name;
+	while (std::getline(ss, name, ',')) {
+		name.erase(0, name.find_first_not_of(" \t"));
+		name.erase(name.find_last_not_of(" \t") + 1);
+		if (!name.empty())
+			names.push_back(name);
+	}
+	return names;
+}
@@ -0,0 +1,45 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       flythrough.h
+ * \author     rka Prokopov
+ * \date       2025/5/22
+ * \brief      Free camera flights recorded as keyframes, fitted to a spline and saved
+ *				as named flythroughs for the interactive and headless benchmarks
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __FLYTHROUGH_H
+#define __FLYTHROUGH_H
+
+#include <string>
+#include <vector>
+#include "headless.h"
+
+// named flythroughs are files of this directory, same format as the benchmark camera
+const char* const FLYTHROUGH_DIRECTORY = "data/flythroughs";
+
+/// <summary>
+/// samples the free camera on every simulation step, on stop keeps only the keys the
+/// Catmull-Rom path of scriptedCamera needs to stay within the tolerance of the samples
+/// </summary>
+class flythroughRecorder {
+public:
+	flythroughRecorder() : recording(false), startTime(0.0f) {}
+
+	void start();
+	void addSample(float time, const glm::vec3& position, const glm::vec3& center);
+	// fits and saves the flight as the first free recordedN, returns its name or empty string
+	std::string stop(float tolerance);
+	bool isRecording() { return recording; }
+
+	static std::vector<CameraKey> fitKeys(const std::vector<CameraKey>& samples, float tolerance);
+	static std::string getPath(const std::string& name);
+	static std::vector<std::string> parseNames(const std::string& list);  // comma separated
+
+private:
+	std::vector<CameraKey> samples;
+	bool recording;
+	float startTime;   // simulation time of the first sample, keys start at zero
+};
+
+#endif
@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       frameArena.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/24
+ * \brief      Linear scratch memory for data that lives one frame
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "frameArena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+static thread_local frameArena* currentArena = NULL;
+
+frameArena::~frameArena() {
+	for (size_t i = 0; i < blocks.size(); i++)
+		delete[] blocks[i].memory;
+}
+
+void* frameArena::allocate(size_t size, size_t alignment) {
+	while (current < blocks.size()) {
+		ArenaBlock& block = blocks[current];
+		uintptr_t address = (uintptr_t)(block.memory + offset);
+		size_t padding = (alignment - address % alignment) % alignment;
+		if (offset + padding + size <= block.size) {
+			void* memory = block.memory + offset + padding;
+			offset += padding + size;
+			used += padding + size;
+			highWater = std::max(highWater, used);
+			return memory;
+		}
+		// rest of the block is skipped, allocations never span two blocks
+		used += block.size - offset;
+		current++;
+		offset = 0;
+	}
+
+	ArenaBlock block;
+	block.size = std::max(blockSize, size + alignment);
+	block.memory = new char[block.size];
+	blocks.push_back(block);
+#ifdef _DEBUG
+	if (blocks.size() > 1)
+		std::cerr << "frame arena: frame needs " << blocks.size() << " blocks, consider a bigger FRAME_ARENA_BLOCK" << std::endl;
+#endif
+	return allocate(size, alignment);
+}
+
+void frameArena::release(void* memory, size_t size) {
+#ifdef _DEBUG
+	memset(memory, FRAME_ARENA_POISON, size);
+#else
+	(void)memory;
+	(void)size;
+#endif
+}
+
+void frameArena::reset() {
+#ifdef _DEBUG
+	// stale pointers into the last frame read the poison instead of valid looking data
+	for (size_t i = 0; i < blocks.size() && i <= current; i++)
+		memset(blocks[i].memory, FRAME_ARENA_POISON, i < current ? blocks[i].size : offset);
+#endif
+	current = 0;
+	offset = 0;
+	used = 0;
+}
+
+size_t frameArena::getCapacity() const {
+	size_t capacity = 0;
+	for (size_t i = 0; i < blocks.size(); i++)
+		capacity += blocks[i].size;
+	return capacity;
+}
+
+void frameArena::printReport(std::ostream& out, const char* name) const {
+	out << std::fixed << std::setprecision(1);
+	out << "Frame arena " << name << ": high-water " << highWater / 1024.0 << " KB of "
+		<< getCapacity() / 1024.0 << " KB in " << blocks.size() << " blocks" << std::endl;
+}
+
+frameArena* frameArena::getCurrent() {
+	return currentArena;
+}
+
+frameArena* frameArena::makeCurrent(frameArena* arena) {
+	frameArena* previous = currentArena;
+	currentArena = arena;
+	return previous;
+}
@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       frameArena.h
+ * \author     rka Prokopov
+ * \date       2025/5/24
+ * \brief      Linear scratch memory for data that lives one frame - render lists,
+ *				culling results, sort keys and rebuilt meshes, with STL allocator adapter
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __FRAME_ARENA_H
+#define __FRAME_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <vector>
+
+const size_t FRAME_ARENA_BLOCK = 256 * 1024;      // bytes of one block, a bigger frame chains more
+const unsigned char FRAME_ARENA_POISON = 0xDD;    // debug builds fill released memory with it
+
+// one chunk of the arena, allocated the first frame that needs it and kept for the next ones
+typedef struct ArenaBlock {
+	char* memory;
+	size_t size;
+} ArenaBlock;
+
+/// <summary>
+/// bump allocator owned by one thread - allocations move a pointer, single frees do nothing
+/// and reset at the start of the frame releases everything at once, blocks stay allocated
+/// so after the first frames nothing goes to the heap
+/// </summary>
+class frameArena {
+public:
+	frameArena(size_t blockSize = FRAME_ARENA_BLOCK)
+		: blockSize(blockSize), current(0), offset(0), used(0), highWater(0) {}
+	~frameArena();
+
+	void* allocate(size_t size, size_t alignment);
+	void release(void* memory, size_t size);   // debug builds poison it, space returns on reset
+	void reset();                               // containers using the arena must be gone by then
+
+	size_t getUsed() const { return used; }
+	size_t getHighWater() const { return highWater; }   // most bytes of one frame
+	size_t getCapacity() const;
+	void printReport(std::ostream& out, const char* name) const;
+
+	// arena the allocators of the calling thread take memory from, NULL means the heap
+	static frameArena* getCurrent();
+	static frameArena* makeCurrent(frameArena* arena);   // returns the previous one
+
+private:
+	frameArena(const frameArena&) = delete;
+	frameArena& operator=(const frameArena&) = delete;
+
+	std::vector<ArenaBlock> blocks;
+	size_t blockSize;
+	size_t current;   // block allocations come from
+	size_t offset;    // first free byte of the current block
+	size_t used;      // bytes of this frame including alignment
+	size_t highWater;
+};
+
+/// <summary>
+/// STL allocator on the arena of the thread that creates the container, vectors of
+/// the frame use arenaVector instead of std::vector
+/// </summary>
+template <typename T>
+class arenaAllocator {
+public:
+	typedef T value_type;
+
+	arenaAllocator() : arena(frameArena::getCurrent()) {}
+	arenaAllocator(frameArena* arena) : arena(arena) {}
+	template <typename U>
+	arenaAllocator(const arenaAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t count) {
+		if (arena == NULL)
+			return static_cast<T*>(::operator new(count * sizeof(T)));
+		return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* memory, size_t count) {
+		if (arena == NULL)
+			::operator delete(memory);
+		else
+			arena->release(memory, count * sizeof(T));
+	}
+
+	frameArena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const arenaAllocator<T>& a, const arenaAllocator<U>& b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const arenaAllocator<T>& a, const arenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <typename T>
+using arenaVector = std::vector<T, arenaAllocator<T>>;
+
+/// <summary>
+/// makes the arena current for the calling thread until the end of the scope
+/// </summary>
+class arenaScope {
+public:
+	arenaScope(frameArena* arena) { previous = frameArena::makeCurrent(arena); }
+	~arenaScope() { frameArena::makeCurrent(previous); }
+
+private:
+	frameArena* previous;
+};
+
+#endif
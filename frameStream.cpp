@@ -0,0 +1,30 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       frameStream.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/11
+ * \brief      Frames handed from the simulation thread to the render thread
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "frameStream.h"
+
+// set on the shared slot when it holds a frame the reader has not seen
+static const int FRAME_FRESH = 4;
+
+// written frame goes to the middle, writer continues in the slot that was there
+void frameStream::publish() {
+	int previous = shared.exchange(writeSlot | FRAME_FRESH, std::memory_order_acq_rel);
+	writeSlot = previous & ~FRAME_FRESH;
+	published++;
+}
+
+// older frames which were not taken in time are simply overwritten
+bool frameStream::acquire() {
+	if ((shared.load(std::memory_order_acquire) & FRAME_FRESH) == 0)
+		return false;
+	int previous = shared.exchange(readSlot, std::memory_order_acq_rel);
+	readSlot = previous & ~FRAME_FRESH;
+	acquired++;
+	return true;
+}
@@ -0,0 +1,88 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       frameStream.h
+ * \author     rka Prokopov
+ * \date       2025/5/11
+ * \brief      Frames handed from the simulation thread to the render thread
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __FRAME_STREAM_H
+#define __FRAME_STREAM_H
+
+#include <vector>
+#include <atomic>
+#include "pgr.h"
+#include "utilStructures.h"
+
+const int FRAME_STREAM_SLOTS = 3;    // writer, reader and the one passed between them
+const int FRAME_RECENT_DROPS = 8;    // ripple drops carried by every frame
+
+// state of moving objects after one simulation step, frames are drawn between the last two
+typedef struct SimulationSnapshot {
+	glm::vec3 cameraPosition;
+	glm::vec3 cameraDirection;
+	glm::vec3 duckPosition;
+	glm::vec3 duckDirection;
+	glm::vec3 maxwellPosition;
+	glm::vec3 maxwellDirection;
+} SimulationSnapshot;
+
+// ripple made by the simulation, the render thread owns the ripple texture
+typedef struct RippleDrop {
+	glm::vec2 center;
+	float radius;
+	float strength;
+} RippleDrop;
+
+// everything the render passes read from the simulation
+typedef struct FrameSnapshot {
+	double stepTime = 0.0;       // simulation time of the newest step
+	double capturedAt = 0.0;     // clock time when the frame was written
+	float alpha = 0.0f;          // position between the two steps at capture time
+	float time = 0.0f;           // render time, set when the frame is drawn
+
+	SimulationSnapshot previous; // moving objects one step before
+	SimulationSnapshot current;
+	Camera camera;
+	glm::vec3 staticPosition;    // static camera, flies between positions
+	glm::vec3 staticCenter;
+
+	float lightIntensity = 0.9f;
+	glm::vec4 clearColor;
+	float loadingBarWidth = 0.0f;
+	std::vector<Explosion> explosions;
+	std::vector<glm::mat4> floatingMotion;   // per buoyancy body
+
+	// drops are numbered, frames overwritten before drawing must not lose them
+	RippleDrop drops[FRAME_RECENT_DROPS];
+	long long dropCount = 0;
+} FrameSnapshot;
+
+/// <summary>
+/// lock-free hand over of whole frames - the writer and the reader own one buffer each and
+/// swap it with the third one by a single atomic exchange, so neither side ever waits and
+/// the reader always gets the newest finished frame
+/// </summary>
+class frameStream {
+public:
+	frameStream() : writeSlot(0), readSlot(1), shared(2), published(0), acquired(0) {}
+
+	FrameSnapshot& beginWrite() { return slots[writeSlot]; }
+	void publish();
+	bool acquire();   // false when no new frame was published
+	const FrameSnapshot& latest() { return slots[readSlot]; }
+
+	long long getPublished() { return published; }
+	long long getAcquired() { return acquired; }
+
+private:
+	FrameSnapshot slots[FRAME_STREAM_SLOTS];
+	int writeSlot;              // only used by the writer
+	int readSlot;               // only used by the reader
+	std::atomic<int> shared;    // slot in between, FRAME_FRESH bit marks an unread frame
+	std::atomic<long long> published;
+	std::atomic<long long> acquired;
+};
+
+#endif
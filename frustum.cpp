@@ -0,0 +1,81 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       frustum.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/8
+ * \brief      View frustum planes for culling of whole objects
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "frustum.h"
+#include <algorithm>
+
+// planes are sums and differences of the matrix rows (Gribb, Hartmann)
+void viewFrustum::extract(const glm::mat4& projectionView) {
+	glm::vec4 rowX = glm::vec4(projectionView[0][0], projectionView[1][0], projectionView[2][0], projectionView[3][0]);
+	glm::vec4 rowY = glm::vec4(projectionView[0][1], projectionView[1][1], projectionView[2][1], projectionView[3][1]);
+	glm::vec4 rowZ = glm::vec4(projectionView[0][2], projectionView[1][2], projectionView[2][2], projectionView[3][2]);
+	glm::vec4 rowW = glm::vec4(projectionView[0][3], projectionView[1][3], projectionView[2][3], projectionView[3][3]);
+
+	planes[0] = rowW + rowX;
+	planes[1] = rowW - rowX;
+	planes[2] = rowW + rowY;
+	planes[3] = rowW - rowY;
+	planes[4] = rowW + rowZ;
+	planes[5] = rowW - rowZ;
+
+	for (int i = 0; i < 6; i++) {
+		float length = glm::length(glm::vec3(planes[i]));
+		if (length > 0.0f)
+			planes[i] /= length;
+	}
+}
+
+// box is outside when its corner furthest along the plane normal is behind the plane
+bool viewFrustum::containsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+	for (int i = 0; i < 6; i++) {
+		glm::vec3 corner = glm::vec3(
+			planes[i].x >= 0.0f ? boxMax.x : boxMin.x,
+			planes[i].y >= 0.0f ? boxMax.y : boxMin.y,
+			planes[i].z >= 0.0f ? boxMax.z : boxMin.z);
+		if (glm::dot(glm::vec3(planes[i]), corner) + planes[i].w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+bool viewFrustum::containsSphere(const glm::vec3& center, float radius) const {
+	for (int i = 0; i < 6; i++) {
+		if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+			return false;
+	}
+	return true;
+}
+
+// convex polygon is clipped by all planes, exact even for big polygons whose corners
+// lie on the inner side of every single plane - every plane adds at most one corner,
+// so both polygons fit on the stack
+bool viewFrustum::intersectsPolygon(const glm::vec3* corners, int count) const {
+	glm::vec3 buffers[2][FRUSTUM_MAX_CORNERS + 6];
+	glm::vec3* polygon = buffers[0];
+	glm::vec3* clipped = buffers[1];
+	int polygonCount = std::min(count, FRUSTUM_MAX_CORNERS);
+	std::copy(corners, corners + polygonCount, polygon);
+	for (int i = 0; i < 6 && polygonCount > 0; i++) {
+		int clippedCount = 0;
+		glm::vec3 normal = glm::vec3(planes[i]);
+		for (int j = 0; j < polygonCount; j++) {
+			const glm::vec3& a = polygon[j];
+			const glm::vec3& b = polygon[(j + 1) % polygonCount];
+			float distanceA = glm::dot(normal, a) + planes[i].w;
+			float distanceB = glm::dot(normal, b) + planes[i].w;
+			if (distanceA >= 0.0f)
+				clipped[clippedCount++] = a;
+			if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+				clipped[clippedCount++] = a + (b - a) * (distanceA / (distanceA - distanceB));
+		}
+		std::swap(polygon, clipped);
+		polygonCount = clippedCount;
+	}
+	return polygonCount > 0;
+}
@@ -0,0 +1,34 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       frustum.h
+ * \author     rka Prokopov
+ * \date       2025/5/8
+ * \brief      View frustum planes for culling of whole objects
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __FRUSTUM_H
+#define __FRUSTUM_H
+
+#include "pgr.h"
+
+const int FRUSTUM_MAX_CORNERS = 16;   // corners of a polygon tested by intersectsPolygon
+
+/// <summary>
+/// six planes taken from projection * view matrix, normals point inside
+/// </summary>
+class viewFrustum {
+public:
+	viewFrustum() {}
+	viewFrustum(const glm::mat4& projectionView) { extract(projectionView); }
+
+	void extract(const glm::mat4& projectionView);
+	bool containsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+	bool containsSphere(const glm::vec3& center, float radius) const;
+	bool intersectsPolygon(const glm::vec3* corners, int count) const;
+
+private:
+	glm::vec4 planes[6];   // left, right, bottom, top, near, far
+};
+
+#endif
@@ -13,15 +13,37 @@
 #include "render_stuff.h"
 #include "camera.h"
 #include "configLoader.h"
+#include "simulationClock.h"
+#include "headless.h"
+#include "passTimer.h"
+#include "inputRecorder.h"
+#include "metricsServer.h"
+#include "flythrough.h"
+#include "objectPool.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 
 // path to config.txt
 const char* CONFIG_PATH = "data/config.txt";
+// path to settings.txt
+const char* SETTINGS_PATH = "data/settings.txt";
 
 extern SCommonShaderProgram shaderProgram;  // main shader
 extern SCommonShaderProgram waterShader;  // water shader
 extern GameUniformVariables gameUniVars;   // uniform variables
 extern GameState gameState;	      // scene variables
+extern GameSettings gameSettings;     // application settings
+extern rippleSimulator ripples;       // interactive water ripples
+extern buoyancySystem buoyancy;       // floating props
+extern waterVisibility waterVisible;  // lake visibility for water passes
+extern jobSystem jobs;                // frame work on all cores
+extern FrameSnapshot renderFrame;     // frame drawn by the render thread
+extern std::mutex simulationMutex;    // simulation state shared with input callbacks
+extern perfHud performanceHud;        // overlay with frame timings
+extern RenderCounters renderCounters; // draw calls and triangles of the frame
+extern startupTimer startupTimes;     // asset loading stages of the --startup benchmark
 extern ExplosionShaderProgram explosionShader; // explosion shader
 
 bool cameraPosition = false;
@@ -33,10 +55,25 @@ extern glm::vec3 actualCenter;
 glm::vec3 freeCamPos;
 glm::vec3 freeCamDir;
 float teleportSpeed = 0.2f;
+// how often the duck and the boat disturb the water
+const float DUCK_RIPPLE_PERIOD = 0.15f;
+const float BOAT_RIPPLE_PERIOD = 1.6f;
+// key deltas in data.h were tuned for 30 updates per second
+const float INPUT_STEP_SCALE = (float)(SIMULATION_STEP * 30.0);
+// camera jumps longer than this are not interpolated
+const float SNAPSHOT_TELEPORT_DISTANCE = 0.5f;
+// floating bodies per job, whole SIMD batches so the chunks never share a batch
+const int BUOYANCY_JOB_BODIES = 16 * BUOYANCY_BODY_BATCH;
+// pools of the game objects, explosions of clicks beyond the limit are not shown
+const size_t CAMERA_POOL_SIZE = 1;
+const size_t OBJECT_POOL_SIZE = 4;   // duck, Maxwell, pool and ball
+const size_t EXPLOSION_POOL_SIZE = 64;
 // to show day colors
 glm::vec4 day = glm::vec4(0.95f, 0.95f, 0.85f, 1.0f);
 glm::vec4 currentColor = day;  //current state od daytime
-std::list<Explosion*> explosions; //list of explosions
+objectPool<Explosion> explosions(EXPLOSION_POOL_SIZE); //explosions in progress
+objectPool<Camera> cameras(CAMERA_POOL_SIZE);
+objectPool<Object> animatedObjects(OBJECT_POOL_SIZE);
 
 std::map<std::string, ObjectProp> m_loadProps;
 
@@ -51,6 +88,38 @@ struct
 
 } gameObjects;
 
+fixedStepClock simulationClock;
+SimulationSnapshot previousSnapshot;
+// simulation runs on its own thread and publishes frames, GLUT thread only draws them
+frameStream simulationFrames;
+std::thread simulationThread;
+std::atomic<bool> simulationRunning(false);
+std::atomic<long long> simulationMicroseconds(0);   // steps of the simulation thread not yet shown by a frame
+// light of the day computed by simulation, render copies it to uniforms
+float daylightIntensity = 0.9f;
+// ripple drops of the simulation, numbered so that frames can carry the last few
+RippleDrop recentDrops[FRAME_RECENT_DROPS];
+long long rippleDropCount = 0;
+long long appliedDropCount = 0;
+// benchmark without a window, started by --headless
+bool headlessMode = false;
+scriptedCamera benchCamera;
+float benchCameraStart = 0.0f;   // render time the benchmark camera starts its path at
+passTimer passTimes;
+// session input written by --record, fed back by --replay
+inputRecorder inputLog;
+// frame statistics for tools/metricsClient, started when stats.socket is set
+metricsServer metrics;
+long long drawnFrames = 0;
+// free camera flights recorded with k, flythroughs of the settings played with v
+flythroughRecorder flythroughRecording;
+scriptedCamera flythroughCamera;
+float flythroughStart = 0.0f;
+size_t flythroughIndex = 0;   // next one of gameSettings.flythroughs
+// scratch of the frame, reset by the thread that owns it, job workers have theirs in jobs
+frameArena renderArena;
+frameArena simulationArena;
+
 Light sun;
 Light cameraReflector;
 Light sphereLight;
@@ -71,7 +140,9 @@ public:
     void changePointLight();
     void updateObjects(float elapsedTime);
     void initializeApplication();
+    void initBuoyancy();   // bodies for the floating props of m_loadProps
     static void gameMenu(int choice);
+    static void handleMenu(int choice);
     void createMenu(void);
     static void finalizeApplication();
 
@@ -107,12 +178,23 @@ public:
     /// </summary>
     struct screenHandler {
     public:
-        static void timerCallback(int);
+        static void idleCallback();
+        static void simulateStep();
+        static void simulationLoop();
+        static void startSimulationThread();
+        static void stopSimulationThread();
         static void passiveMouseMotionCallback(int mouseX, int mouseY);
         static void mouseCallback(int buttonPressed, int buttonState, int mouseX, int mouseY);
+        static bool mouseLook(float deltaX, float deltaY);
+        static void handleClick(int objectID, bool water, const glm::vec2& waterPoint);
         static void displayCallback();
         static void reshapeCallback(int newWidth, int newHeight);
         static void drawWindowContents(bool drawWater);
+        static void computeCamera(glm::mat4& viewMatrix, glm::mat4& projectionMatrix);
+        static void recordSceneObjects();
+        static void drawSceneObjects(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const viewFrustum* frustum, bool drawWater);
+        static void drawReflectionContents();
+        static void drawLayeredWaterTargets();
 
     };
 
@@ -125,6 +207,10 @@ public:
         //static void keyboardUpCallback(unsigned char keyReleased, int mouseX, int mouseY);
         static void specialKeyboardCallback(int specKeyPressed, int mouseX, int mouseY);
         static void specialKeyboardUpCallback(int specKeyReleased, int mouseX, int mouseY);
+        // actions behind the callbacks, replay calls them directly
+        static void handleKey(unsigned char keyPressed);
+        static void handleSpecialKey(int specKeyPressed);
+        static void handleSpecialKeyUp(int specKeyReleased);
 
     };
 
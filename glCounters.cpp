@@ -0,0 +1,88 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       glCounters.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/17
+ * \brief      GL calls of every pass counted by type
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "glCounters.h"
+
+#ifdef GL_COUNTERS
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+int glCounters::pass = PASS_FRAME;
+int glCounters::dumpInterval = 0;
+long long glCounters::frame = 0;
+GlPassCounters glCounters::current[PASS_COUNT];
+GlPassCounters glCounters::last[PASS_COUNT];
+
+const char* glCounters::getCallName(int call) {
+	static const char* names[GL_CALL_COUNT] = {
+		"useProgram", "bindTexture", "bindVertexArray", "uniform", "draw"
+	};
+	return names[call];
+}
+
+// triangles the primitive mode makes out of count vertices
+void glCounters::countDraw(GLenum mode, GLsizei count) {
+	GlPassCounters& counters = current[pass];
+	counters.calls[GL_CALL_DRAW]++;
+	counters.vertices += count;
+	if (mode == GL_TRIANGLES)
+		counters.triangles += count / 3;
+	else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+		counters.triangles += count - 2;
+}
+
+void glCounters::endFrame() {
+	memcpy(last, current, sizeof(last));
+	memset(current, 0, sizeof(current));
+	pass = PASS_FRAME;
+	frame++;
+	if (dumpInterval > 0 && frame % dumpInterval == 0)
+		printReport(std::cout);
+}
+
+GlPassCounters glCounters::getFrame() {
+	GlPassCounters total;
+	memset(&total, 0, sizeof(total));
+	for (int i = 0; i < PASS_COUNT; i++) {
+		for (int call = 0; call < GL_CALL_COUNT; call++)
+			total.calls[call] += last[i].calls[call];
+		total.triangles += last[i].triangles;
+		total.vertices += last[i].vertices;
+	}
+	return total;
+}
+
+// table of the last frame, one row per pass that issued any call
+void glCounters::printReport(std::ostream& out) {
+	out << "GL calls of frame " << frame << ":" << std::endl;
+	out << "  " << std::setw(14) << std::left << "pass" << std::right;
+	for (int call = 0; call < GL_CALL_COUNT; call++)
+		out << std::setw(16) << getCallName(call);
+	out << std::setw(12) << "triangles" << std::setw(12) << "vertices" << std::endl;
+
+	GlPassCounters total = getFrame();
+	for (int i = 0; i <= PASS_COUNT; i++) {
+		const GlPassCounters& counters = i < PASS_COUNT ? last[i] : total;
+		long long calls = 0;
+		for (int call = 0; call < GL_CALL_COUNT; call++)
+			calls += counters.calls[call];
+		if (calls == 0)
+			continue;
+		// work outside the passes is reported as "other"
+		const char* name = i == PASS_COUNT ? "total" : i == PASS_FRAME ? "other" : passTimer::getName(i);
+		out << "  " << std::setw(14) << std::left << name << std::right;
+		for (int call = 0; call < GL_CALL_COUNT; call++)
+			out << std::setw(16) << counters.calls[call];
+		out << std::setw(12) << counters.triangles << std::setw(12) << counters.vertices << std::endl;
+	}
+}
+
+#endif
@@ -0,0 +1,143 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       glCounters.h
+ * \author     rka Prokopov
+ * \date       2025/5/17
+ * \brief      GL calls of every pass counted by type, built only with GL_COUNTERS defined -
+ *				include after pgr.h in files issuing GL calls, the calls below are redirected
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __GL_COUNTERS_H
+#define __GL_COUNTERS_H
+
+#ifdef GL_COUNTERS
+
+#include <ostream>
+#include "pgr.h"
+#include "passTimer.h"
+
+// counted kinds of calls
+enum {
+	GL_CALL_USE_PROGRAM,
+	GL_CALL_BIND_TEXTURE,
+	GL_CALL_BIND_VERTEX_ARRAY,
+	GL_CALL_UNIFORM,
+	GL_CALL_DRAW,
+	GL_CALL_COUNT
+};
+
+// calls of one pass in one frame
+typedef struct GlPassCounters {
+	long long calls[GL_CALL_COUNT];
+	long long triangles;
+	long long vertices;
+} GlPassCounters;
+
+/// <summary>
+/// per pass counters of the current and the last finished frame, passes are the ones of
+/// passTimer, work outside of them is counted under PASS_FRAME
+/// </summary>
+class glCounters {
+public:
+	static void count(int call) { current[pass].calls[call]++; }
+	static void countDraw(GLenum mode, GLsizei count);
+	static void setPass(int pass) { glCounters::pass = pass; }
+	static void endFrame();   // last frame is kept, every dumpInterval frames it is printed
+	static void setDumpInterval(int frames) { dumpInterval = frames; }
+
+	static const GlPassCounters& getPass(int pass) { return last[pass]; }
+	static GlPassCounters getFrame();   // all passes of the last frame
+	static void printReport(std::ostream& out);
+	static const char* getCallName(int call);
+
+private:
+	static int pass;
+	static int dumpInterval;
+	static long long frame;
+	static GlPassCounters current[PASS_COUNT];
+	static GlPassCounters last[PASS_COUNT];
+};
+
+// wrappers still see the original entry points, the defines below only apply after them
+inline void countedUseProgram(GLuint program) {
+	glCounters::count(GL_CALL_USE_PROGRAM);
+	glUseProgram(program);
+}
+inline void countedBindTexture(GLenum target, GLuint texture) {
+	glCounters::count(GL_CALL_BIND_TEXTURE);
+	glBindTexture(target, texture);
+}
+inline void countedBindVertexArray(GLuint array) {
+	glCounters::count(GL_CALL_BIND_VERTEX_ARRAY);
+	glBindVertexArray(array);
+}
+inline void countedUniform1i(GLint location, GLint v0) {
+	glCounters::count(GL_CALL_UNIFORM);
+	glUniform1i(location, v0);
+}
+inline void countedUniform1f(GLint location, GLfloat v0) {
+	glCounters::count(GL_CALL_UNIFORM);
+	glUniform1f(location, v0);
+}
+inline void countedUniform2f(GLint location, GLfloat v0, GLfloat v1) {
+	glCounters::count(GL_CALL_UNIFORM);
+	glUniform2f(location, v0, v1);
+}
+inline void countedUniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+	glCounters::count(GL_CALL_UNIFORM);
+	glUniform3fv(location, count, value);
+}
+inline void countedUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+	glCounters::count(GL_CALL_UNIFORM);
+	glUniform4fv(location, count, value);
+}
+inline void countedUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+	glCounters::count(GL_CALL_UNIFORM);
+	glUniformMatrix4fv(location, count, transpose, value);
+}
+inline void countedDrawArrays(GLenum mode, GLint first, GLsizei count) {
+	glCounters::countDraw(mode, count);
+	glDrawArrays(mode, first, count);
+}
+inline void countedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+	glCounters::countDraw(mode, count);
+	glDrawElements(mode, count, type, indices);
+}
+
+#undef glUseProgram
+#undef glBindTexture
+#undef glBindVertexArray
+#undef glUniform1i
+#undef glUniform1f
+#undef glUniform2f
+#undef glUniform3fv
+#undef glUniform4fv
+#undef glUniformMatrix4fv
+#undef glDrawArrays
+#undef glDrawElements
+#define glUseProgram countedUseProgram
+#define glBindTexture countedBindTexture
+#define glBindVertexArray countedBindVertexArray
+#define glUniform1i countedUniform1i
+#define glUniform1f countedUniform1f
+#define glUniform2f countedUniform2f
+#define glUniform3fv countedUniform3fv
+#define glUniform4fv countedUniform4fv
+#define glUniformMatrix4fv countedUniformMatrix4fv
+#define glDrawArrays countedDrawArrays
+#define glDrawElements countedDrawElements
+
+#define GL_COUNT_PASS(pass) glCounters::setPass(pass)
+#define GL_COUNT_FRAME() glCounters::endFrame()
+#define GL_COUNT_DUMP_EVERY(frames) glCounters::setDumpInterval(frames)
+
+#else
+
+#define GL_COUNT_PASS(pass) ((void)0)
+#define GL_COUNT_FRAME() ((void)0)
+#define GL_COUNT_DUMP_EVERY(frames) ((void)0)
+
+#endif
+
+#endif
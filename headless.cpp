@@ -0,0 +1,251 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       headless.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/13
+ * \brief      Rendering without a window - offscreen context and scripted camera
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "headless.h"
+#include "spline.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+
+#if defined(HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#elif defined(HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#endif
+
+#if defined(HEADLESS_EGL)
+
+bool headlessContext::create(int width, int height) {
+	this->width = width;
+	this->height = height;
+
+	// surfaceless platform needs no display server, plain default display is the fallback
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != NULL)
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	if (eglDisplay == EGL_NO_DISPLAY)
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+		std::cerr << "headless: EGL display cannot be initialized" << std::endl;
+		return false;
+	}
+	display = eglDisplay;
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0) {
+		std::cerr << "headless: no EGL config with depth and stencil" << std::endl;
+		destroy();
+		return false;
+	}
+
+	// pbuffer is the default framebuffer, passes that bind 0 keep working
+	const EGLint surfaceAttributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+	EGLSurface eglSurface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes);
+	if (eglSurface == EGL_NO_SURFACE) {
+		std::cerr << "headless: pbuffer " << width << "x" << height << " cannot be created" << std::endl;
+		destroy();
+		return false;
+	}
+	surface = eglSurface;
+
+	eglBindAPI(EGL_OPENGL_API);
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, pgr::OGL_VER_MAJOR,
+		EGL_CONTEXT_MINOR_VERSION, pgr::OGL_VER_MINOR,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+	if (eglContext == EGL_NO_CONTEXT) {
+		std::cerr << "headless: OpenGL " << pgr::OGL_VER_MAJOR << "." << pgr::OGL_VER_MINOR << " core context not supported" << std::endl;
+		destroy();
+		return false;
+	}
+	context = eglContext;
+
+	if (!eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+		std::cerr << "headless: context cannot be made current" << std::endl;
+		destroy();
+		return false;
+	}
+	return true;
+}
+
+void headlessContext::destroy() {
+	if (display == NULL)
+		return;
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (context != NULL)
+		eglDestroyContext(display, context);
+	if (surface != NULL)
+		eglDestroySurface(display, surface);
+	eglTerminate(display);
+	display = surface = context = NULL;
+}
+
+const char* headlessContext::getBackend() {
+	return "egl";
+}
+
+#elif defined(HEADLESS_OSMESA)
+
+bool headlessContext::create(int width, int height) {
+	this->width = width;
+	this->height = height;
+
+	const int attributes[] = {
+		OSMESA_FORMAT, OSMESA_RGBA,
+		OSMESA_DEPTH_BITS, 24,
+		OSMESA_STENCIL_BITS, 8,
+		OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+		OSMESA_CONTEXT_MAJOR_VERSION, pgr::OGL_VER_MAJOR,
+		OSMESA_CONTEXT_MINOR_VERSION, pgr::OGL_VER_MINOR,
+		0
+	};
+	OSMesaContext osContext = OSMesaCreateContextAttribs(attributes, NULL);
+	if (osContext == NULL) {
+		std::cerr << "headless: OSMesa core context cannot be created" << std::endl;
+		return false;
+	}
+	context = osContext;
+
+	// memory buffer is the default framebuffer
+	pixels.resize((size_t)width * height * 4);
+	if (!OSMesaMakeCurrent(osContext, pixels.data(), GL_UNSIGNED_BYTE, width, height)) {
+		std::cerr << "headless: OSMesa buffer " << width << "x" << height << " cannot be bound" << std::endl;
+		destroy();
+		return false;
+	}
+	return true;
+}
+
+void headlessContext::destroy() {
+	if (context != NULL)
+		OSMesaDestroyContext((OSMesaContext)context);
+	context = NULL;
+	pixels.clear();
+}
+
+const char* headlessContext::getBackend() {
+	return "osmesa";
+}
+
+#else
+
+bool headlessContext::create(int, int) {
+	std::cerr << "headless: built without HEADLESS_EGL or HEADLESS_OSMESA (LAKE_HEADLESS in CMake), no offscreen context" << std::endl;
+	return false;
+}
+
+void headlessContext::destroy() {
+}
+
+const char* headlessContext::getBackend() {
+	return "none";
+}
+
+#endif
+
+// keys have to be sorted by time, lines starting with # are comments
+bool scriptedCamera::load(const std::string& fileName) {
+	keys.clear();
+	std::ifstream file(fileName);
+	if (!file.is_open()) {
+		std::cerr << "Error: camera script '" << fileName << "' is unable to load" << std::endl;
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		line.erase(0, line.find_first_not_of(" \t"));
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		CameraKey key;
+		std::stringstream ss(line);
+		if (!(ss >> key.time >> key.position.x >> key.position.y >> key.position.z
+			>> key.center.x >> key.center.y >> key.center.z)) {
+			std::cerr << "Camera script on line " << lineNumber << ": expected 'time x y z cx cy cz'." << std::endl;
+			continue;
+		}
+		if (!keys.empty() && key.time < keys.back().time) {
+			std::cerr << "Camera script on line " << lineNumber << ": time goes back, key skipped." << std::endl;
+			continue;
+		}
+		keys.push_back(key);
+	}
+	return !keys.empty();
+}
+
+bool scriptedCamera::save(const std::string& fileName, const std::string& comment) {
+	std::ofstream file(fileName);
+	if (!file.is_open()) {
+		std::cerr << "Error: camera script '" << fileName << "' cannot be written" << std::endl;
+		return false;
+	}
+	file << "# " << comment << "\n# time x y z cx cy cz\n" << std::fixed << std::setprecision(4);
+	for (size_t i = 0; i < keys.size(); i++)
+		file << keys[i].time << " " << keys[i].position.x << " " << keys[i].position.y << " " << keys[i].position.z
+			<< " " << keys[i].center.x << " " << keys[i].center.y << " " << keys[i].center.z << "\n";
+	return file.good();
+}
+
+// Catmull-Rom through the keys, the end keys are repeated so that the path starts and ends
+// in them, the last key holds after the script ends
+void scriptedCamera::evaluate(float time, glm::vec3& position, glm::vec3& center) const {
+	position = glm::vec3(0.0f, -2.0f, 1.3f);
+	center = glm::vec3(0.0f);
+	if (keys.empty())
+		return;
+	size_t next = std::upper_bound(keys.begin(), keys.end(), time,
+		[](float time, const CameraKey& key) { return time < key.time; }) - keys.begin();
+	if (next == 0) {
+		position = keys[0].position;
+		center = keys[0].center;
+		return;
+	}
+	if (next == keys.size()) {
+		position = keys.back().position;
+		center = keys.back().center;
+		return;
+	}
+	size_t from = next - 1;
+	size_t before = from > 0 ? from - 1 : from;
+	size_t after = next + 1 < keys.size() ? next + 1 : next;
+	float alpha = (time - keys[from].time) / glm::max(keys[next].time - keys[from].time, 0.0001f);
+
+	splineHandler spline;
+	glm::vec3 positions[] = { keys[before].position, keys[from].position, keys[next].position, keys[after].position };
+	glm::vec3 centers[] = { keys[before].center, keys[from].center, keys[next].center, keys[after].center };
+	position = spline.evaluateCurveSegment(positions, alpha);
+	center = spline.evaluateCurveSegment(centers, alpha);
+}
+
+glm::mat4 scriptedCamera::getView(float time) {
+	glm::vec3 position, center;
+	evaluate(time, position, center);
+	return glm::lookAt(position, center, glm::vec3(0.0f, 0.0f, 1.0f));
+}
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       headless.h
+ * \author     rka Prokopov
+ * \date       2025/5/13
+ * \brief      Rendering without a window - offscreen context and scripted camera
+ *				for benchmark machines with no display
+ *
+ *  Context comes from EGL (build with HEADLESS_EGL) or OSMesa (HEADLESS_OSMESA),
+ *  both work with Mesa's software rasterizer. Without either flag the headless
+ *  mode only reports that it is not available.
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __HEADLESS_H
+#define __HEADLESS_H
+
+#include <string>
+#include <vector>
+#include "pgr.h"
+
+const double HEADLESS_FRAME_TIME = 1.0 / 60.0;  // virtual time between benchmark frames
+
+/// <summary>
+/// OpenGL context with an offscreen default framebuffer - pbuffer surface of
+/// surfaceless EGL or a memory buffer of OSMesa
+/// </summary>
+class headlessContext {
+public:
+	headlessContext() : display(NULL), surface(NULL), context(NULL), width(0), height(0) {}
+
+	bool create(int width, int height);
+	void destroy();
+	const char* getBackend();
+
+private:
+	void* display;
+	void* surface;
+	void* context;
+	std::vector<unsigned char> pixels;   // color buffer of OSMesa
+	int width;
+	int height;
+};
+
+// position and point of view of the scripted camera at given time
+typedef struct CameraKey {
+	float time;
+	glm::vec3 position;
+	glm::vec3 center;
+} CameraKey;
+
+/// <summary>
+/// camera flying through keyframes "time x y z cx cy cz", same path on every run
+/// </summary>
+class scriptedCamera {
+public:
+	bool load(const std::string& fileName);
+	bool save(const std::string& fileName, const std::string& comment);
+	glm::mat4 getView(float time);
+	void evaluate(float time, glm::vec3& position, glm::vec3& center) const;
+	float getDuration() { return keys.empty() ? 0.0f : keys.back().time; }
+
+	void setKeys(const std::vector<CameraKey>& keys) { this->keys = keys; }
+	const std::vector<CameraKey>& getKeys() { return keys; }
+
+private:
+	std::vector<CameraKey> keys;
+};
+
+#endif
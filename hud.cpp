@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       hud.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/16
+ * \brief      Performance overlay - FPS, frame time graph, pass timings and scene counters
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "hud.h"
+#include <cstdio>
+
+static const glm::vec4 HUD_BACKGROUND = glm::vec4(0.0f, 0.0f, 0.0f, 0.6f);
+static const glm::vec4 HUD_TEXT = glm::vec4(1.0f);
+static const glm::vec4 HUD_DIM_TEXT = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+
+void perfHud::frameStarted() {
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	frameTime = std::chrono::duration<double, std::milli>(now - lastFrame).count();
+	lastFrame = now;
+	if (frameTime <= 0.0 || frameTime > 1000.0) // first frame or a stall
+		return;
+
+	graph[graphHead] = (float)frameTime;
+	graphHead = (graphHead + 1) % HUD_GRAPH_FRAMES;
+	// smoothed over about half a second so the number can be read
+	framesPerSecond = framesPerSecond * 0.97 + (1000.0 / frameTime) * 0.03;
+}
+
+void perfHud::build(spriteBatch& batch, passTimer& passes, const RenderCounters& counters, int width, int height) {
+	const float line = (FONT_GLYPH_HEIGHT + 3) * HUD_TEXT_SCALE;
+	const float graphHeight = 60.0f;
+	const float panelWidth = glm::min(30 * FONT_ADVANCE * HUD_TEXT_SCALE, width - 20.0f);   // narrow windows
+	float x = 10.0f;
+	float y = 0.06f * height;   // under the speed bar
+
+	int passLines = 0;
+	for (int pass = 0; pass < PASS_COUNT; pass++)
+		if (passes.getLastCpu(pass) > 0.0)
+			passLines++;
+	float panelHeight = line * (4 + passLines) + graphHeight + 16.0f;
+	batch.addRect(x - 6.0f, y - 6.0f, panelWidth, panelHeight, HUD_BACKGROUND);
+
+	char text[64];
+	snprintf(text, sizeof(text), "FPS %.1f  %.2f MS", framesPerSecond, frameTime);
+	batch.addText(x, y, text, HUD_TEXT_SCALE, HUD_TEXT);
+	y += line;
+
+	// frame time graph, green within 60 Hz, yellow within 30 Hz, red above
+	float barWidth = (panelWidth - 12.0f) / HUD_GRAPH_FRAMES;
+	float scale = graphHeight / HUD_GRAPH_MAX_MS;
+	for (int i = 0; i < HUD_GRAPH_FRAMES; i++) {
+		float ms = graph[(graphHead + i) % HUD_GRAPH_FRAMES];
+		float barHeight = glm::min(ms, HUD_GRAPH_MAX_MS) * scale;
+		glm::vec4 color = ms < 16.7f ? glm::vec4(0.3f, 0.9f, 0.3f, 0.9f)
+			: ms < 33.4f ? glm::vec4(0.9f, 0.8f, 0.2f, 0.9f) : glm::vec4(0.9f, 0.25f, 0.2f, 0.9f);
+		batch.addRect(x + i * barWidth, y + graphHeight - barHeight, glm::max(barWidth - 1.0f, 1.0f), barHeight, color);
+	}
+	batch.addRect(x, y + graphHeight - 16.7f * scale, panelWidth - 12.0f, 1.0f, glm::vec4(1.0f, 1.0f, 1.0f, 0.4f));
+	y += graphHeight + 8.0f;
+
+	batch.addText(x, y, "PASS            CPU    GPU", HUD_TEXT_SCALE, HUD_DIM_TEXT);
+	y += line;
+	for (int pass = 0; pass < PASS_COUNT; pass++) {
+		if (passes.getLastCpu(pass) <= 0.0)
+			continue;
+		snprintf(text, sizeof(text), "%-13s %6.2f %6.2f", passTimer::getName(pass), passes.getLastCpu(pass), passes.getLastGpu(pass));
+		batch.addText(x, y, text, HUD_TEXT_SCALE, HUD_TEXT);
+		y += line;
+	}
+
+	snprintf(text, sizeof(text), "DRAWS %d  TRIS %lldK", counters.drawCalls, counters.triangles / 1000);
+	batch.addText(x, y, text, HUD_TEXT_SCALE, HUD_TEXT);
+	y += line;
+	snprintf(text, sizeof(text), "TEXTURES %.1f MB", counters.textureBytes / (1024.0 * 1024.0));
+	batch.addText(x, y, text, HUD_TEXT_SCALE, HUD_TEXT);
+}
@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       hud.h
+ * \author     rka Prokopov
+ * \date       2025/5/16
+ * \brief      Performance overlay - FPS, frame time graph, pass timings and scene counters
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __HUD_H
+#define __HUD_H
+
+#include <chrono>
+#include "spriteBatch.h"
+#include "passTimer.h"
+
+const int HUD_GRAPH_FRAMES = 120;           // frames shown in the frame time graph
+const float HUD_GRAPH_MAX_MS = 50.0f;       // frame time at the top of the graph
+const float HUD_TEXT_SCALE = 2.0f;
+
+// work of the last frame, counted where the draw calls are issued
+typedef struct RenderCounters {
+	int drawCalls = 0;
+	long long triangles = 0;
+	size_t textureBytes = 0;   // textures loaded from files, mipmaps included
+	int texturesLoaded = 0;
+	int meshesLoaded = 0;
+} RenderCounters;
+
+/// <summary>
+/// overlay toggled by a key, the text is rebuilt every frame into the sprite batch
+/// </summary>
+class perfHud {
+public:
+	perfHud() : visible(false), graphHead(0), frameTime(0.0), framesPerSecond(0.0) {
+		for (int i = 0; i < HUD_GRAPH_FRAMES; i++)
+			graph[i] = 0.0f;
+	}
+
+	void toggle() { visible = !visible; }
+	bool isVisible() { return visible; }
+
+	void frameStarted();   // wall time between two frames
+	double getFrameTime() { return frameTime; }
+	void build(spriteBatch& batch, passTimer& passes, const RenderCounters& counters, int width, int height);
+
+private:
+	bool visible;
+	std::chrono::steady_clock::time_point lastFrame;
+	float graph[HUD_GRAPH_FRAMES];   // milliseconds, ring
+	int graphHead;
+	double frameTime;
+	double framesPerSecond;          // smoothed
+};
+
+#endif
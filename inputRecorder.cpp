@@ -0,0 +1,135 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       inputRecorder.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/14
+ * \brief      Input of a session saved with simulation ticks and fed back on replay
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "inputRecorder.h"
+#include <iostream>
+#include <cstring>
+
+// values are stored little endian whatever the machine is
+static void put32(unsigned char* bytes, unsigned int value) {
+	for (int i = 0; i < 4; i++)
+		bytes[i] = (unsigned char)(value >> (8 * i));
+}
+
+static unsigned int get32(const unsigned char* bytes) {
+	unsigned int value = 0;
+	for (int i = 0; i < 4; i++)
+		value |= (unsigned int)bytes[i] << (8 * i);
+	return value;
+}
+
+static unsigned int floatBits(float value) {
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static float bitsFloat(unsigned int bits) {
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+bool inputRecorder::startRecording(const std::string& fileName, unsigned int seed) {
+	stop();
+	file = fopen(fileName.c_str(), "wb");
+	if (file == NULL) {
+		std::cerr << "Error: input recording '" << fileName << "' cannot be written" << std::endl;
+		return false;
+	}
+	unsigned char header[12];
+	put32(header, INPUT_FILE_MAGIC);
+	put32(header + 4, INPUT_FILE_VERSION);
+	put32(header + 8, seed);
+	fwrite(header, 1, sizeof(header), file);
+
+	this->seed = seed;
+	tick = 0;
+	recording = true;
+	return true;
+}
+
+bool inputRecorder::startReplay(const std::string& fileName) {
+	stop();
+	file = fopen(fileName.c_str(), "rb");
+	if (file == NULL) {
+		std::cerr << "Error: input recording '" << fileName << "' is unable to load" << std::endl;
+		return false;
+	}
+	unsigned char header[12];
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) || get32(header) != INPUT_FILE_MAGIC
+		|| get32(header + 4) != INPUT_FILE_VERSION) {
+		std::cerr << "Error: '" << fileName << "' is not an input recording of this version" << std::endl;
+		fclose(file);
+		file = NULL;
+		return false;
+	}
+	seed = get32(header + 8);
+
+	// end tick is the last event, recordings cut short end with their last input
+	endTick = 0;
+	InputEvent event;
+	while (readEvent(event))
+		endTick = event.tick;
+	fseek(file, sizeof(header), SEEK_SET);
+
+	tick = 0;
+	hasPending = false;
+	replaying = true;
+	return true;
+}
+
+void inputRecorder::stop() {
+	if (recording)
+		record(INPUT_END, 0);
+	if (file != NULL)
+		fclose(file);
+	file = NULL;
+	recording = false;
+	replaying = false;
+}
+
+void inputRecorder::record(int type, int code, float x, float y, int flags) {
+	if (!recording)
+		return;
+	unsigned char bytes[INPUT_EVENT_SIZE];
+	put32(bytes, tick);
+	bytes[4] = (unsigned char)type;
+	bytes[5] = (unsigned char)code;
+	bytes[6] = (unsigned char)flags;
+	bytes[7] = (unsigned char)(flags >> 8);
+	put32(bytes + 8, floatBits(x));
+	put32(bytes + 12, floatBits(y));
+	fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+bool inputRecorder::readEvent(InputEvent& event) {
+	unsigned char bytes[INPUT_EVENT_SIZE];
+	if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes))
+		return false;
+	event.tick = get32(bytes);
+	event.type = bytes[4];
+	event.code = bytes[5];
+	event.flags = (unsigned short)(bytes[6] | (bytes[7] << 8));
+	event.x = bitsFloat(get32(bytes + 8));
+	event.y = bitsFloat(get32(bytes + 12));
+	return true;
+}
+
+bool inputRecorder::nextEvent(InputEvent& event) {
+	if (!replaying)
+		return false;
+	if (!hasPending)
+		hasPending = readEvent(pending);
+	if (!hasPending || pending.tick > tick)
+		return false;
+	event = pending;
+	hasPending = false;
+	return event.type != INPUT_END;
+}
@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       inputRecorder.h
+ * \author     rka Prokopov
+ * \date       2025/5/14
+ * \brief      Input of a session saved with simulation ticks and fed back on replay,
+ *				so the same session gives the same frames run after run
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __INPUT_RECORDER_H
+#define __INPUT_RECORDER_H
+
+#include <string>
+#include <cstdio>
+
+const unsigned int INPUT_FILE_MAGIC = 0x4e494b4c;  // "LKIN"
+const unsigned int INPUT_FILE_VERSION = 1;
+const int INPUT_EVENT_SIZE = 16;                   // bytes of one event in the file
+
+// kinds of recorded events
+enum {
+	INPUT_KEY,            // code = key
+	INPUT_SPECIAL_DOWN,   // code = GLUT special key
+	INPUT_SPECIAL_UP,
+	INPUT_MOUSE_LOOK,     // x, y = offset from the window center
+	INPUT_CLICK,          // code = picked object, x, y = clicked water point when flags is 1
+	INPUT_MENU,           // code = menu choice
+	INPUT_END             // tick when the recording stopped
+};
+
+// one event, applied before the simulation step following its tick
+typedef struct InputEvent {
+	unsigned int tick;
+	unsigned char type;
+	unsigned char code;
+	unsigned short flags;
+	float x;
+	float y;
+} InputEvent;
+
+/// <summary>
+/// writes input events into a compact binary file, or reads them back and hands them
+/// out at the ticks they were recorded at - mouse picking is stored as its result,
+/// so replay does not depend on what is on the screen
+/// </summary>
+class inputRecorder {
+public:
+	inputRecorder() : file(NULL), recording(false), replaying(false), tick(0), seed(0), endTick(0), hasPending(false) {}
+
+	bool startRecording(const std::string& fileName, unsigned int seed);
+	bool startReplay(const std::string& fileName);
+	void stop();
+
+	bool isRecording() { return recording; }
+	bool isReplaying() { return replaying; }
+	bool isActive() { return recording || replaying; }
+	unsigned int getSeed() { return seed; }
+	unsigned int getTick() { return tick; }
+
+	void record(int type, int code, float x = 0.0f, float y = 0.0f, int flags = 0);
+	void step() { tick++; }
+	bool nextEvent(InputEvent& event);   // next replayed event due at the current tick
+	bool finished() { return replaying && tick >= endTick; }
+
+private:
+	bool readEvent(InputEvent& event);
+
+	FILE* file;
+	bool recording;
+	bool replaying;
+	unsigned int tick;      // simulation steps since the session started
+	unsigned int seed;
+	unsigned int endTick;
+	InputEvent pending;     // read ahead, waits for its tick
+	bool hasPending;
+};
+
+#endif
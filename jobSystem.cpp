@@ -0,0 +1,313 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       jobSystem.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/10
+ * \brief      Work stealing scheduler - per thread queues, dependencies, parallel for
+ *				and timings of every job of the frame
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "jobSystem.h"
+#include "profiler.h"
+#include "allocTracker.h"
+#include <algorithm>
+#include <map>
+#include <iomanip>
+
+// index of the calling thread, main thread is 0
+static thread_local int currentThread = 0;
+
+void jobSystem::init(int threads) {
+	shutdown();
+	if (threads <= 0)
+		threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	threadCount = std::min(threads + 1, JOB_MAX_THREADS);
+
+	quit = false;
+	frameStart = std::chrono::steady_clock::now();
+	for (int i = 0; i < threadCount; i++)
+		queues[i].ring.assign(JOB_QUEUE_SIZE, NULL);
+	for (int i = 1; i < threadCount; i++)
+		workers.push_back(std::thread(&jobSystem::workerLoop, this, i));
+}
+
+void jobSystem::shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		quit = true;
+	}
+	wakeCondition.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+	workers.clear();
+	for (int i = 0; i < JOB_MAX_THREADS; i++) {
+		queues[i].head = 0;
+		queues[i].count = 0;
+	}
+	queuedJobs = 0;
+	threadCount = 1;
+}
+
+// jobs of the previous frame are handed out again from the first one and the workers start
+// with empty arenas - jobs another thread submitted may still run, so the calling thread
+// helps until every job is done
+void jobSystem::beginFrame() {
+	std::unique_lock<std::mutex> lock(createMutex);
+	waitForJobs(lock);
+	usedJobs = 0;
+	for (int i = 1; i < threadCount; i++)
+		arenas[i].reset();
+	frameStart = std::chrono::steady_clock::now();
+}
+
+// helps until every job of every thread is done, no job can be created while the lock is held
+void jobSystem::waitForJobs(std::unique_lock<std::mutex>& lock) {
+	while (unfinishedJobs > 0) {
+		lock.unlock();
+		if (!runOne(currentThread))
+			std::this_thread::yield();
+		lock.lock();
+	}
+}
+
+// reused jobs keep the capacity of their dependency lists, after a few frames nothing allocates
+job* jobSystem::create(const char* name, std::function<void()> work) {
+	job* task;
+	{
+		std::lock_guard<std::mutex> lock(createMutex);
+		if (usedJobs == frameJobs.size())
+			frameJobs.emplace_back();
+		task = &frameJobs[usedJobs++];
+		unfinishedJobs++;
+	}
+	setUp(task, name, std::move(work));
+	return task;
+}
+
+void jobSystem::prepare(job* task, const char* name, std::function<void()> work) {
+	{
+		std::lock_guard<std::mutex> lock(createMutex);
+		unfinishedJobs++;
+	}
+	setUp(task, name, std::move(work));
+}
+
+void jobSystem::setUp(job* task, const char* name, std::function<void()> work) {
+	task->work = std::move(work);
+	task->name = name;
+	task->dependencies.clear();
+	task->dependents.clear();
+	task->waitingFor = 1;
+	task->finished = false;
+	task->start = 0.0;
+	task->end = 0.0;
+	task->thread = -1;
+}
+
+void jobSystem::depend(job* later, job* earlier) {
+	later->waitingFor++;
+	later->dependencies.push_back(earlier);
+	earlier->dependents.push_back(later);
+}
+
+void jobSystem::submit(job* task) {
+	if (--task->waitingFor == 0)
+		push(task);
+}
+
+// calling thread runs other jobs until the task is done
+void jobSystem::wait(job* task) {
+	while (!task->finished) {
+		if (!runOne(currentThread))
+			std::this_thread::yield();
+	}
+}
+
+// range is cut into jobs of grain items, returns when the empty job depending on all of them is done
+void jobSystem::parallelFor(const char* name, int count, int grain, std::function<void(int, int)> body) {
+	if (count <= 0)
+		return;
+	grain = std::max(grain, 1);
+
+	job* joined = create(name, []() {});
+	for (int begin = 0; begin < count; begin += grain) {
+		int end = std::min(begin + grain, count);
+		job* part = create(name, [&body, begin, end]() { body(begin, end); });
+		depend(joined, part);
+		submit(part);
+	}
+	submit(joined);
+	wait(joined);
+}
+
+void jobSystem::workerLoop(int index) {
+	currentThread = index;
+	frameArena::makeCurrent(&arenas[index]);
+	PROFILE_THREAD_NAME("job worker");
+	while (true) {
+		if (runOne(index))
+			continue;
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeCondition.wait(lock, [this]() { return quit || queuedJobs > 0; });
+		if (quit)
+			return;
+	}
+}
+
+bool jobSystem::runOne(int index) {
+	job* task = popOwn(index);
+	if (task == NULL)
+		task = steal(index);
+	if (task == NULL)
+		return false;
+	execute(task, index);
+	return true;
+}
+
+void jobSystem::execute(job* task, int index) {
+	task->thread = index;
+	task->start = now();
+	{
+		PROFILE_ZONE(task->name);
+		ALLOC_SCOPE(task->name);
+		task->work();
+	}
+	task->end = now();
+	finish(task);
+}
+
+// newest own job, its data is most likely still in cache
+job* jobSystem::popOwn(int index) {
+	std::lock_guard<std::mutex> lock(queueMutex[index]);
+	JobQueue& queue = queues[index];
+	if (queue.count == 0)
+		return NULL;
+	queue.count--;
+	job* task = queue.ring[(queue.head + queue.count) % queue.ring.size()];
+	queuedJobs--;
+	return task;
+}
+
+// oldest job of another thread, usually the biggest remaining piece of work
+job* jobSystem::steal(int index) {
+	for (int i = 1; i < threadCount; i++) {
+		int victim = (index + i) % threadCount;
+		std::lock_guard<std::mutex> lock(queueMutex[victim]);
+		JobQueue& queue = queues[victim];
+		if (queue.count == 0)
+			continue;
+		job* task = queue.ring[queue.head];
+		queue.head = (queue.head + 1) % queue.ring.size();
+		queue.count--;
+		queuedJobs--;
+		return task;
+	}
+	return NULL;
+}
+
+void jobSystem::push(job* task) {
+	int index = currentThread;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex[index]);
+		JobQueue& queue = queues[index];
+		if (queue.count < queue.ring.size()) {
+			queue.ring[(queue.head + queue.count) % queue.ring.size()] = task;
+			queue.count++;
+			queuedJobs++;
+			task = NULL;
+		}
+	}
+	if (task != NULL) { // queue is full, nobody else would run it sooner
+		execute(task, index);
+		return;
+	}
+	// empty lock orders the push before a worker goes to sleep
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wakeCondition.notify_one();
+}
+
+void jobSystem::finish(job* task) {
+	for (size_t i = 0; i < task->dependents.size(); i++) {
+		job* later = task->dependents[i];
+		if (--later->waitingFor == 0)
+			push(later);
+	}
+	task->finished = true;
+	unfinishedJobs--;
+}
+
+double jobSystem::now() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+}
+
+// longest chain of dependent jobs, jobs waiting for nested jobs contain their time
+double jobSystem::getCriticalPath(std::vector<job*>* path) {
+	std::unique_lock<std::mutex> lock(createMutex);
+	waitForJobs(lock);
+	return findCriticalPath(path);
+}
+
+double jobSystem::findCriticalPath(std::vector<job*>* path) {
+	std::map<job*, double> chainLength;
+	std::map<job*, job*> chainPrevious;
+
+	// dependencies are created before the job depending on them, only the empty join job
+	// of parallelFor comes first - the job waiting for it holds the time of its parts
+	job* last = NULL;
+	for (size_t slot = 0; slot < usedJobs; slot++) {
+		job* task = &frameJobs[slot];
+		double before = 0.0;
+		job* previous = NULL;
+		for (size_t i = 0; i < task->dependencies.size(); i++) {
+			job* earlier = task->dependencies[i];
+			if (chainLength[earlier] > before) {
+				before = chainLength[earlier];
+				previous = earlier;
+			}
+		}
+		chainLength[task] = before + (task->end - task->start);
+		chainPrevious[task] = previous;
+		if (last == NULL || chainLength[task] > chainLength[last])
+			last = task;
+	}
+	if (last == NULL)
+		return 0.0;
+
+	if (path != NULL) {
+		path->clear();
+		for (job* task = last; task != NULL; task = chainPrevious[task])
+			path->insert(path->begin(), task);
+	}
+	return chainLength[last];
+}
+
+// timings are written by the threads running the jobs, the report waits until they are done
+void jobSystem::printReport(std::ostream& out) {
+	std::unique_lock<std::mutex> lock(createMutex);
+	waitForJobs(lock);
+	std::vector<job*> path;
+	double critical = findCriticalPath(&path);
+
+	out << std::fixed << std::setprecision(3);
+	out << "Jobs of the last frame, " << threadCount << " threads:" << std::endl;
+	for (size_t i = 0; i < usedJobs; i++) {
+		const job& task = frameJobs[i];
+		out << "  " << std::setw(20) << std::left << task.name << std::right
+			<< " thread " << task.thread << "  start " << task.start << " ms  " << (task.end - task.start) << " ms" << std::endl;
+	}
+	out << "Critical path " << critical << " ms:";
+	for (size_t i = 0; i < path.size(); i++)
+		out << (i == 0 ? " " : " -> ") << path[i]->name;
+	out << std::endl;
+}
+
+// scratch the workers needed at most in one frame
+void jobSystem::printArenaReport(std::ostream& out) {
+	for (int i = 1; i < threadCount; i++) {
+		std::string name = "worker " + std::to_string(i);
+		arenas[i].printReport(out, name.c_str());
+	}
+}
@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       jobSystem.h
+ * \author     rka Prokopov
+ * \date       2025/5/10
+ * \brief      Work stealing scheduler for per-frame CPU work
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __JOB_SYSTEM_H
+#define __JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include "frameArena.h"
+
+const int JOB_MAX_THREADS = 16;   // workers plus the main thread
+const int JOB_QUEUE_SIZE = 4096;  // queued jobs per thread, a full queue runs the job right away
+
+/// <summary>
+/// one task of the frame, it starts when all jobs it depends on are finished
+/// </summary>
+struct job {
+	std::function<void()> work;
+	const char* name;
+	std::atomic<int> waitingFor;     // unfinished dependencies, plus one until submitted
+	std::atomic<bool> finished;
+	std::vector<job*> dependencies;
+	std::vector<job*> dependents;
+
+	// timings in milliseconds from the start of the frame
+	double start;
+	double end;
+	int thread;
+};
+
+// ring of queued jobs, allocated once by init so that queueing never allocates
+typedef struct JobQueue {
+	std::vector<job*> ring;
+	size_t head = 0;    // oldest job
+	size_t count = 0;
+} JobQueue;
+
+/// <summary>
+/// every thread owns a queue - it pushes and pops its own jobs at the back, idle threads
+/// steal the oldest jobs from the front of the others, the main thread helps while waiting
+/// </summary>
+class jobSystem {
+public:
+	jobSystem() : threadCount(1), quit(false), queuedJobs(0), unfinishedJobs(0) {}
+	~jobSystem() { shutdown(); }
+
+	void init(int threads);   // 0 = all cores but one
+	void shutdown();
+
+	// jobs live until the next beginFrame, dependencies are added before the earlier job is submitted
+	void beginFrame();
+	job* create(const char* name, std::function<void()> work);
+	// job in storage of the caller, beginFrame never hands it out again - for work that
+	// a thread other than the frame owner submits and waits for
+	void prepare(job* task, const char* name, std::function<void()> work);
+	void depend(job* later, job* earlier);
+	void submit(job* task);
+	void wait(job* task);
+	void parallelFor(const char* name, int count, int grain, std::function<void(int, int)> body);
+
+	int getThreadCount() { return threadCount; }
+	double getCriticalPath(std::vector<job*>* path = NULL);
+	void printReport(std::ostream& out);
+	void printArenaReport(std::ostream& out);
+
+private:
+	void workerLoop(int index);
+	bool runOne(int index);
+	void execute(job* task, int index);
+	void setUp(job* task, const char* name, std::function<void()> work);
+	void waitForJobs(std::unique_lock<std::mutex>& lock);
+	double findCriticalPath(std::vector<job*>* path);   // createMutex is held
+	job* popOwn(int index);
+	job* steal(int index);
+	void push(job* task);
+	void finish(job* task);
+	double now();
+
+	int threadCount;
+	std::vector<std::thread> workers;
+	JobQueue queues[JOB_MAX_THREADS];
+	std::mutex queueMutex[JOB_MAX_THREADS];
+
+	std::mutex sleepMutex;
+	std::condition_variable wakeCondition;
+	bool quit;
+	std::atomic<int> queuedJobs;
+
+	std::deque<job> frameJobs;       // deque keeps addresses while growing, jobs are reused every frame
+	size_t usedJobs = 0;             // jobs of the current frame, the rest wait for later frames
+	std::mutex createMutex;          // jobs may create jobs
+	std::atomic<int> unfinishedJobs; // created or prepared and not done yet, of every thread
+	frameArena arenas[JOB_MAX_THREADS];   // scratch of the workers, the main thread brings its own
+	std::chrono::steady_clock::time_point frameStart;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#version 150
+
+in vec3 position;           // vertex position in world space
+in vec3 normal;             // vertex normal
+in vec2 texCoord;           // incoming texture coordinates
+
+// main camera of the pass, layers get their projections in the geometry shader
+layout(std140) uniform PassBlock {
+  mat4 Vmatrix;             // View                       --> world to eye coordinates
+  mat4 PVmatrix;            // unused here
+};
+uniform mat4 Mmatrix;       // Model                      --> model to world coordinates
+uniform mat4 normalMatrix;  // inverse transposed Mmatrix
+
+// projection is done per layer in geometry shader
+out vec3 worldPosition_g;
+out vec3 vertexPosition_g;
+out vec3 vertexNormal_g;
+out vec2 texCoord_g;
+out float mydistance_g;
+
+void main() {
+  vec4 worldPosition = Mmatrix * vec4(position, 1.0);
+  worldPosition_g = worldPosition.xyz;
+
+  // lighting is evaluated in the eye space of the main camera in both layers
+  vertexPosition_g = (Vmatrix * worldPosition).xyz;
+  vertexNormal_g   = normalize( (Vmatrix * normalMatrix * vec4(normal, 0.0) ).xyz);
+  texCoord_g = texCoord;
+  mydistance_g = length(vertexPosition_g);
+
+  gl_Position = worldPosition;
+}
@@ -27,10 +27,11 @@ struct Light {         // structure describing light parameters
 uniform float time;         // time used for simulation of moving lights (such as sun)
 uniform Material material;  // current material
 
-uniform mat4 PVMmatrix;     // Projection * View * Model  --> model to clip coordinates
-uniform mat4 Vmatrix;       // View                       --> world to eye coordinates
-uniform mat4 Mmatrix;       // Model                      --> model to world coordinates
-uniform mat4 normalMatrix;  // inverse transposed Mmatrix
+// view of the current pass, shared by all draws of the pass
+layout(std140) uniform PassBlock {
+  mat4 Vmatrix;             // View                       --> world to eye coordinates
+  mat4 PVmatrix;            // Projection * View          --> world to clip coordinates
+};
 
 uniform vec3 reflectorPosition;   // reflector position (world coordinates)
 uniform vec3 reflectorDirection;  // reflector direction (world coordinates)
@@ -6,8 +6,11 @@ in vec3 position;           // vertex position in world space
 in vec3 normal;             // vertex normal
 in vec2 texCoord;           // incoming texture coordinates
 
-uniform mat4 PVMmatrix;     // Projection * View * Model  --> model to clip coordinates
-uniform mat4 Vmatrix;       // View                       --> world to eye coordinates
+// view of the current pass, shared by all draws of the pass
+layout(std140) uniform PassBlock {
+  mat4 Vmatrix;             // View                       --> world to eye coordinates
+  mat4 PVmatrix;            // Projection * View          --> world to clip coordinates
+};
 uniform mat4 Mmatrix;       // Model                      --> model to world coordinates
 uniform mat4 normalMatrix;  // inverse transposed Mmatrix
 
@@ -22,16 +25,17 @@ smooth out vec2 texCoord_v;       // outgoing texture coordinates
 
 void main() {
 
-  vertexPosition = (Vmatrix * Mmatrix * vec4(position, 1.0)).xyz;         
+  vec4 worldPosition = Mmatrix * vec4(position, 1.0);
+  vertexPosition = (Vmatrix * worldPosition).xyz;
   vertexNormal   = normalize( (Vmatrix * normalMatrix * vec4(normal, 0.0) ).xyz);  
-  clipSpace = PVMmatrix * vec4(position, 1);  
-  gl_Position = PVMmatrix * vec4(position, 1);  
+  clipSpace = PVmatrix * worldPosition;
+  gl_Position = clipSpace;
 
   texCoord_v = texCoord;
   mydistance =  distance(vec4(0.0, 0.0, 0.0, 1.0), vec4(vertexPosition, 1.0));
   //gl_ClipDistance[0] = texCoord_v.y - 1.1;
   //gl_ClipDistance[1] = 1.1 - texCoord_v.y;
-  gl_ClipDistance[0] = vertexPosition.z - 1.1;   
+  // reflection pass is clipped by oblique near plane of its projection
   gl_ClipDistance[1] = 1.1 - vertexPosition.z; 
 
 }
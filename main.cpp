@@ -12,17 +12,24 @@
 //-----------------------------------------------------------------------------------------
 
 #include <iostream>
+#include <fstream>
 #include <time.h>
-#include <list>
+#include <thread>
 #include "pgr.h"
 #include "gameEngine.h"
 #include "data.h"
 #include "water.h"
 #include "spline.h"
+#include "glCounters.h"
+#include "allocTracker.h"
+#include "sceneGenerator.h"
+#include <sstream>
+#include <iomanip>
 
 
 gameEngine* gameHandler = new gameEngine();
 waterBufferMaker* waterFBOHandler;
+reflectionCamera waterReflection; // mirrored camera of the planar reflection pass
 renderObjects gameEngine::renderHandler;
 cameraHandler gameEngine::camHandler;
 splineHandler gameEngine::splineFucHandler;
@@ -31,10 +38,19 @@ float loadingBarWidth = 0.0f; //var for loading bar
 
 bool duckAnimation; //if animation is on or off
 
+// camera of the last main pass, to find clicked point on water
+glm::mat4 lastViewMatrix = glm::mat4(1.0f);
+glm::mat4 lastProjectionMatrix = glm::mat4(1.0f);
+// when the last ripples were made
+float lastDuckRipple = 0.0f;
+float lastBoatRipple = 0.0f;
+
 //---------------------------------------------------------CREATE OBJECTS--------------------------------------------------------------------
 //create duck
 void gameEngine::duckHandler::createDuck() {
-	Object* newDuck = new Object;
+	// restart has reset the pool, the object takes the slot of the previous game
+	gameObjects.duck = animatedObjects.get(animatedObjects.create());
+	Object* newDuck = gameObjects.duck;
 
 	newDuck->position = m_loadProps["duck"].position;
 	newDuck->direction = m_loadProps["duck"].front;
@@ -43,13 +59,12 @@ void gameEngine::duckHandler::createDuck() {
 	newDuck->destroyed = false;
 	newDuck->startTime = gameState.elapsedTime;
 	newDuck->currentTime = newDuck->startTime;
-
-	gameObjects.duck = newDuck;
 }
 
 // create Maxwell object
 void gameEngine::maxwellHandler::createMaxwell() {
-	Object* newMaxwell = new Object;
+	gameObjects.maxwellObj = animatedObjects.get(animatedObjects.create());
+	Object* newMaxwell = gameObjects.maxwellObj;
 
 	newMaxwell->position = m_loadProps["maxwell"].position;
 	newMaxwell->direction = m_loadProps["maxwell"].front;
@@ -60,13 +75,12 @@ void gameEngine::maxwellHandler::createMaxwell() {
 	newMaxwell->destroyed = false;
 	newMaxwell->startTime = gameState.elapsedTime;
 	newMaxwell->currentTime = newMaxwell->startTime;
-
-	gameObjects.maxwellObj = newMaxwell;
 }
 
 // create Maxwell object
 void gameEngine::poolHandler::createPool() {
-	Object* newPool = new Object;
+	gameObjects.poolObj = animatedObjects.get(animatedObjects.create());
+	Object* newPool = gameObjects.poolObj;
 
 	newPool->position = m_loadProps["pool"].position;
 	newPool->direction = m_loadProps["pool"].front;
@@ -77,12 +91,11 @@ void gameEngine::poolHandler::createPool() {
 	newPool->destroyed = false;
 	newPool->startTime = gameState.elapsedTime;
 	newPool->currentTime = newPool->startTime;
-
-	gameObjects.poolObj = newPool;
 }
 
 void gameEngine::poolHandler::createBall() {
-	Object* newBall = new Object;
+	gameObjects.ballObj = animatedObjects.get(animatedObjects.create());
+	Object* newBall = gameObjects.ballObj;
 
 	newBall->position = m_loadProps["ball"].position;
 	newBall->direction = m_loadProps["ball"].front;
@@ -93,13 +106,13 @@ void gameEngine::poolHandler::createBall() {
 	newBall->destroyed = false;
 	newBall->startTime = gameState.elapsedTime;
 	newBall->currentTime = newBall->startTime;
-
-	gameObjects.ballObj = newBall;
 }
 
 //----------------------------------------------------------INTERACTION WITH OBJECTS------------------------------------------------------
 void createExplosion(glm::vec3 position) {
-	Explosion* newExplosion = new Explosion;
+	Explosion* newExplosion = explosions.get(explosions.create());
+	if (newExplosion == NULL) // pool is full, the click makes no explosion
+		return;
 
 	newExplosion->speed = 0.0f;
 	newExplosion->destroyed = false;
@@ -115,8 +128,6 @@ void createExplosion(glm::vec3 position) {
 
 	newExplosion->position = glm::vec3(position.x+0.6, position.y-0.3, position.z);
 	newExplosion->end = newExplosion->startTime + newExplosion->frames * newExplosion->frameDuration;
-
-	explosions.push_back(newExplosion);
 }
 
 void controlExplosion(Explosion* explosion) {
@@ -187,8 +198,8 @@ void gameEngine::evalLightIntensity() {
 		phase = (cycleDuration - timeInCycle) / (cycleDuration / 2.0f); // 1 -> 0
 	}
 	phase = pow(phase, 2.0f);
-	// change light
-	gameUniVars.lightIntensity = glm::mix(1.0f, -1.2f, phase);
+	// change light, render thread takes it with the next frame
+	daylightIntensity = glm::mix(1.0f, -1.2f, phase);
 
 }
 
@@ -204,14 +215,107 @@ void gameEngine::changePointLight() {
 	}
 }
 
+//-------------------------------------------------------------INTERPOLATION------------------------------------------------------------------------------
+SimulationSnapshot captureSnapshot() {
+	SimulationSnapshot snapshot;
+	snapshot.cameraPosition = gameObjects.camera->position;
+	snapshot.cameraDirection = gameObjects.camera->direction;
+	snapshot.duckPosition = gameObjects.duck->position;
+	snapshot.duckDirection = gameObjects.duck->direction;
+	snapshot.maxwellPosition = gameObjects.maxwellObj->position;
+	snapshot.maxwellDirection = gameObjects.maxwellObj->direction;
+	return snapshot;
+}
+
+// direction is blended and kept unit, opposite directions just switch
+glm::vec3 mixDirection(const glm::vec3& from, const glm::vec3& to, float alpha) {
+	glm::vec3 direction = glm::mix(from, to, alpha);
+	float length = glm::length(direction);
+	return length > 0.0001f ? direction / length : to;
+}
+
+SimulationSnapshot interpolateSnapshot(const SimulationSnapshot& previous, const SimulationSnapshot& current, float alpha) {
+	if (glm::distance(previous.cameraPosition, current.cameraPosition) > SNAPSHOT_TELEPORT_DISTANCE)
+		return current; // camera switch or restart
+
+	SimulationSnapshot snapshot = current;
+	snapshot.cameraPosition = glm::mix(previous.cameraPosition, current.cameraPosition, alpha);
+	// mouse turns the camera outside of simulation, only the spline drives its direction
+	if (gameState.curveMotion)
+		snapshot.cameraDirection = mixDirection(previous.cameraDirection, current.cameraDirection, alpha);
+	snapshot.duckPosition = glm::mix(previous.duckPosition, current.duckPosition, alpha);
+	snapshot.duckDirection = mixDirection(previous.duckDirection, current.duckDirection, alpha);
+	snapshot.maxwellPosition = glm::mix(previous.maxwellPosition, current.maxwellPosition, alpha);
+	snapshot.maxwellDirection = mixDirection(previous.maxwellDirection, current.maxwellDirection, alpha);
+	return snapshot;
+}
+
+// drops go to the render thread with the next frame
+void queueRippleDrop(const glm::vec2& center, float radius, float strength) {
+	RippleDrop drop = { center, radius, strength };
+	recentDrops[rippleDropCount % FRAME_RECENT_DROPS] = drop;
+	rippleDropCount++;
+}
+
+// everything the render passes need, written by the thread running the simulation
+void captureFrame(FrameSnapshot& frame) {
+	frame.stepTime = simulationClock.getSimulationTime();
+	frame.capturedAt = simulationClock.now();
+	frame.alpha = simulationClock.getAlpha();
+	frame.previous = previousSnapshot;
+	frame.current = captureSnapshot();
+	frame.camera = *gameObjects.camera;
+	frame.staticPosition = actualPosition;
+	frame.staticCenter = actualCenter;
+
+	frame.lightIntensity = daylightIntensity;
+	frame.clearColor = currentColor;
+	frame.loadingBarWidth = loadingBarWidth;
+	frame.explosions.clear();
+	for (size_t slot = 0; slot < explosions.getSlotEnd(); slot++)
+		if (explosions.isAlive(slot))
+			frame.explosions.push_back(explosions[slot]);
+	frame.floatingMotion.resize(buoyancy.getBodyCount());
+	for (int i = 0; i < buoyancy.getBodyCount(); i++)
+		frame.floatingMotion[i] = buoyancy.getMotion(i);
+
+	for (int i = 0; i < FRAME_RECENT_DROPS; i++)
+		frame.drops[i] = recentDrops[i];
+	frame.dropCount = rippleDropCount;
+}
+
+// frame is drawn between its last two steps, it may be a little old when it gets here
+void prepareRenderFrame(FrameSnapshot& frame) {
+	float alpha = frame.alpha + (float)((simulationClock.now() - frame.capturedAt) / SIMULATION_STEP);
+	alpha = glm::min(alpha, 1.0f);
+	frame.time = (float)std::max(frame.stepTime + (alpha - 1.0f) * SIMULATION_STEP, 0.0);
+
+	frame.current = interpolateSnapshot(frame.previous, frame.current, alpha);
+	frame.camera.position = frame.current.cameraPosition;
+	frame.camera.direction = frame.current.cameraDirection;
+}
+
+// drops made since the last drawn frame, when too many frames were skipped the oldest are lost
+void applyRippleDrops(const FrameSnapshot& frame) {
+	long long first = std::max(appliedDropCount, frame.dropCount - FRAME_RECENT_DROPS);
+	for (long long i = first; i < frame.dropCount; i++) {
+		const RippleDrop& drop = frame.drops[i % FRAME_RECENT_DROPS];
+		ripples.addDrop(drop.center, drop.radius, drop.strength);
+	}
+	appliedDropCount = frame.dropCount;
+}
+
+
 //-------------------------------------------------------------RESTART GAME------------------------------------------------------------------------------
 void gameEngine::restartGame() {
 
-	gameState.elapsedTime = 0.001f * (float)glutGet(GLUT_ELAPSED_TIME); // milliseconds => seconds
+	gameState.elapsedTime = (float)simulationClock.getSimulationTime();
 
-	if (gameObjects.camera == NULL) {
-		gameObjects.camera = new Camera;
-	}
+	// objects of the previous game are dropped at once, the new ones reuse their slots
+	cameras.reset();
+	animatedObjects.reset();
+	explosions.reset();
+	gameObjects.camera = cameras.get(cameras.create());
 
 	gameObjects.camera->position = glm::vec3(-0.0f, 5.3f, 1.3f);
 	gameObjects.camera->viewAngle = 90.0f; // degrees
@@ -234,6 +338,8 @@ void gameEngine::restartGame() {
 		gameState.freeCameraMode = false;
 		glutPassiveMotionFunc(NULL);
 	}
+	gameState.flythroughMode = false;
+	flythroughIndex = 0;
 	// reset key map
 	for (int i = 0; i < KEYS_COUNT; i++) {
 		gameState.keyMap[i] = false;
@@ -244,12 +350,20 @@ void gameEngine::restartGame() {
 	gameUniVars.pointLightIntensity = 0.0f;
 	gameUniVars.useLighting = true;
 	gameUniVars.spotLight = false;
+
+	previousSnapshot = captureSnapshot();
 }
 
 
 
 //-------------------------------------------------------------------DRAW GEOMETRY AND STUFF-------------------------------------------------------
-void gameEngine::screenHandler::drawWindowContents( bool drawWater ) {
+// view and projection of the current camera mode
+void gameEngine::screenHandler::computeCamera(glm::mat4& viewMatrix, glm::mat4& projectionMatrix) {
+	if (headlessMode) { // benchmark flies the same path on every run
+		viewMatrix = benchCamera.getView(renderFrame.time - benchCameraStart);
+		projectionMatrix = glm::perspective(glm::radians(60.0f), (float)gameState.windowWidth / (float)gameState.windowHeight, 0.1f, 10.0f);
+		return;
+	}
 	// setup parallel projection
 	glm::mat4 orthoProjectionMatrix = glm::ortho(
 		-SCENE_WIDTH, SCENE_WIDTH,
@@ -259,24 +373,26 @@ void gameEngine::screenHandler::drawWindowContents( bool drawWater ) {
 	glm::mat4 orthoViewMatrix;
 
 	orthoViewMatrix = glm::lookAt(
-		actualPosition, // position
-		actualCenter, // center
+		renderFrame.staticPosition, // position
+		renderFrame.staticCenter, // center
 		glm::vec3(0.0f, 0.0f, 1.0f)  // up
 	);
 
-	glm::mat4 viewMatrix = orthoViewMatrix;
-	glm::mat4 projectionMatrix = orthoProjectionMatrix;
+	viewMatrix = orthoViewMatrix;
+	projectionMatrix = orthoProjectionMatrix;
+	// camera as the simulation published it, the live one belongs to the simulation
+	Camera* camera = &renderFrame.camera;
 	// compute to know where is the center - first time after restart
 	if (firstTime) {
 		glm::vec3 cameraUpVector = glm::vec3(0.0f, 0.0f, 1.0f);
-		camHandler.computeCenterView(gameObjects.camera, &gameUniVars, &cameraUpVector);
+		camHandler.computeCenterView(camera, &gameUniVars, &cameraUpVector);
 		firstTime = false;
 	}
 	if (gameState.freeCameraMode) {
-		glm::vec3 cameraPosition = gameObjects.camera->position;
+		glm::vec3 cameraPosition = camera->position;
 		glm::vec3 cameraUpVector = glm::vec3(0.0f, 0.0f, 1.0f);
-		camHandler.controlBorders(gameObjects.camera);
-		glm::vec3 cameraCenter = camHandler.computeCenterView(gameObjects.camera, &gameUniVars, &cameraUpVector);
+		camHandler.controlBorders(camera);
+		glm::vec3 cameraCenter = camHandler.computeCenterView(camera, &gameUniVars, &cameraUpVector);
 
 		viewMatrix = glm::lookAt(
 			cameraPosition,
@@ -284,10 +400,10 @@ void gameEngine::screenHandler::drawWindowContents( bool drawWater ) {
 			cameraUpVector
 		);
 	}
-	if (gameState.curveMotion) { // set camera for curve motion
-		glm::vec3 cameraPosition = gameObjects.camera->position;
+	if (gameState.curveMotion || gameState.flythroughMode) { // set camera for curve motion and flythroughs
+		glm::vec3 cameraPosition = camera->position;
 		glm::vec3 cameraUpVector = glm::vec3(0.0f, 0.0f, 1.0f);
-		glm::vec3 cameraCenter = camHandler.computeCenterView(gameObjects.camera, &gameUniVars, &cameraUpVector);
+		glm::vec3 cameraCenter = camHandler.computeCenterView(camera, &gameUniVars, &cameraUpVector);
 
 		viewMatrix = glm::lookAt(
 			cameraPosition,
@@ -297,59 +413,203 @@ void gameEngine::screenHandler::drawWindowContents( bool drawWater ) {
 	}
 
 	projectionMatrix = glm::perspective(glm::radians(60.0f), (float)gameState.windowWidth / (float)gameState.windowHeight, 0.1f, 10.0f);
+}
 
-	glUseProgram(shaderProgram.program);
-	glUniform1f(shaderProgram.timeLocation, gameState.elapsedTime);
-	
-	glEnable(GL_STENCIL_TEST);
-	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-	glStencilFunc(GL_ALWAYS, 2, -1);
+// meshes of the frame with their matrices, computed once and replayed by every pass
+void gameEngine::screenHandler::recordSceneObjects() {
+	renderHandler.getDrawHandler().beginDrawList();
+	renderHandler.getDrawHandler().recordDuck(m_loadProps["duck"], renderFrame.current.duckPosition, renderFrame.current.duckDirection); // duck, v=2
+	renderHandler.getDrawHandler().recordMaxwell(m_loadProps["maxwell"], renderFrame.current.maxwellPosition, renderFrame.current.maxwellDirection); // maxwell, v=3
+	renderHandler.getDrawHandler().recordPool(renderFrame.time, gameObjects.poolObj, m_loadProps); // pool
+	renderHandler.getDrawHandler().recordStaticScene(m_loadProps); // almost all meshes
+}
 
-	renderHandler.getDrawHandler().drawDuck(viewMatrix, projectionMatrix, shaderProgram, gameUniVars, m_loadProps["duck"], gameObjects.duck->position, gameObjects.duck->direction); // draw duck, v=2
-	glStencilFunc(GL_ALWAYS, 3, -1);
-	renderHandler.getDrawHandler().drawMaxwell(viewMatrix, projectionMatrix, shaderProgram, gameUniVars, m_loadProps["maxwell"], gameObjects.maxwellObj->position, gameObjects.maxwellObj->direction); //draw maxwell
-	glDisable(GL_STENCIL_TEST);
-	renderHandler.getDrawHandler().drawPoolMethod( gameState.elapsedTime, viewMatrix, shaderProgram, gameObjects.poolObj, gameObjects.ballObj, gameUniVars, m_loadProps, projectionMatrix); //draw pool
-	renderHandler.getDrawHandler().drawEverything(viewMatrix, projectionMatrix, drawWater, m_loadProps, waterFBOHandler); // draw almost all meshes
+// animated objects and the rest of the scene, without HUD and explosions
+void gameEngine::screenHandler::drawSceneObjects(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const viewFrustum* frustum, bool drawWater) {
+	renderHandler.getDrawHandler().drawEverything(viewMatrix, projectionMatrix, frustum, drawWater, waterFBOHandler);
+}
+
+void gameEngine::screenHandler::drawWindowContents( bool drawWater ) {
+	glm::mat4 viewMatrix, projectionMatrix;
+	computeCamera(viewMatrix, projectionMatrix);
 
-	//update loading bar
-	renderHandler.getDrawHandler().drawBar(viewMatrix, projectionMatrix, loadingBarWidth);
+	if (drawWater) {
+		lastViewMatrix = viewMatrix;
+		lastProjectionMatrix = projectionMatrix;
+	}
 
+	viewFrustum frustum(projectionMatrix * viewMatrix);
+	drawSceneObjects(viewMatrix, projectionMatrix, &frustum, drawWater);
 
 	glDisable(GL_STENCIL_TEST);
 	// create explosion
-	std::list <Explosion*> ::iterator it;
+	std::vector<Explosion>::iterator it;
 	for (int i = 0; i < 4; i++) {
-		for (it = explosions.begin(); it != explosions.end(); ++it) {
-			renderHandler.getDrawHandler().drawExplosion(viewMatrix, projectionMatrix, *it);
+		for (it = renderFrame.explosions.begin(); it != renderFrame.explosions.end(); ++it) {
+			renderHandler.getDrawHandler().drawExplosion(viewMatrix, projectionMatrix, &(*it));
 		};
 	};
 
 	glUseProgram(0);
 }
 
+// planar reflection - scene seen by mirrored camera, oblique near plane cuts it at the water
+void gameEngine::screenHandler::drawReflectionContents() {
+	glm::mat4 viewMatrix, projectionMatrix;
+	computeCamera(viewMatrix, projectionMatrix);
+	waterReflection.update(viewMatrix, projectionMatrix);
+
+	drawSceneObjects(waterReflection.getView(), waterReflection.getProjection(), &waterReflection.getFrustum(), false);
+
+	std::vector<Explosion>::iterator it;
+	for (it = renderFrame.explosions.begin(); it != renderFrame.explosions.end(); ++it) {
+		if (waterReflection.getFrustum().containsSphere(it->position, it->size))
+			renderHandler.getDrawHandler().drawExplosion(waterReflection.getView(), waterReflection.getProjection(), &(*it));
+	}
+	glUseProgram(0);
+}
+
+// reflection and refraction in one pass - the geometry shader sends every triangle
+// to both layers, reflection layer is seen by the camera mirrored under the water
+void gameEngine::screenHandler::drawLayeredWaterTargets() {
+	glm::mat4 viewMatrix, projectionMatrix;
+	computeCamera(viewMatrix, projectionMatrix);
+	glm::mat4 reflectionView = viewMatrix * waterMirrorMatrix();
+	glm::mat4 layerViews[WATER_LAYER_COUNT];
+	layerViews[WATER_LAYER_REFLECTION] = reflectionView;
+	layerViews[WATER_LAYER_REFRACTION] = viewMatrix;
+
+	// skybox is a single screen quad, draw it into each layer
+	for (int layer = 0; layer < WATER_LAYER_COUNT; layer++) {
+		waterFBOHandler->bindLayerFrameBuffer(layer);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		renderHandler.getDrawHandler().drawSky(layerViews[layer], projectionMatrix);
+	}
+
+	waterFBOHandler->bindLayeredFrameBuffer();
+	renderHandler.getDrawHandler().beginLayeredPass(reflectionView, viewMatrix, projectionMatrix);
+	drawSceneObjects(viewMatrix, projectionMatrix, NULL, false); // each layer has its own view, nothing is culled
+	renderHandler.getDrawHandler().endLayeredPass();
+
+	// explosions have their own program, they go layer by layer
+	if (!renderFrame.explosions.empty()) {
+		std::vector<Explosion>::iterator it;
+		for (int layer = 0; layer < WATER_LAYER_COUNT; layer++) {
+			waterFBOHandler->bindLayerFrameBuffer(layer);
+			for (it = renderFrame.explosions.begin(); it != renderFrame.explosions.end(); ++it)
+				renderHandler.getDrawHandler().drawExplosion(layerViews[layer], projectionMatrix, &(*it));
+		}
+	}
+	waterFBOHandler->unbindCurrentFrameBuffer();
+	glUseProgram(0);
+}
+
 // Called to update the display. You should call glutSwapBuffers after all of your
 // rendering to display what you rendered.
 void gameEngine::screenHandler::displayCallback() {
+	PROFILE_ZONE("frame");
+	ALLOC_SCOPE("render");
+	renderArena.reset();
 	GLbitfield mask = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT;
+	performanceHud.frameStarted();
+	if (simulationRunning) // steps of the simulation thread since the last frame
+		passTimes.addCpu(PASS_SIMULATION, simulationMicroseconds.exchange(0) / 1000.0);
+	renderCounters.drawCalls = 0;
+	renderCounters.triangles = 0;
+
+	// frame shows moving objects between the last two simulation steps, the passes
+	// read only this copy so the simulation thread can already run the next steps
+	if (simulationRunning)
+		renderFrame = simulationFrames.latest();
+	else
+		captureFrame(renderFrame);
+	prepareRenderFrame(renderFrame);
+	applyRippleDrops(renderFrame);
+	gameUniVars.lightIntensity = renderFrame.lightIntensity;
+	glClearColor(renderFrame.clearColor.x, renderFrame.clearColor.y, renderFrame.clearColor.z, 1);
 
-	waterFBOHandler->bindReflectionFrameBuffer();
-	glClear(mask);
-	glEnable(GL_CLIP_DISTANCE0);
-	gameEngine::screenHandler::drawWindowContents(false);
-	waterFBOHandler->unbindCurrentFrameBuffer();
+	{
+		PROFILE_GPU_ZONE("update");
+		passTimes.begin(PASS_UPDATE);
+		renderHandler.getDrawHandler().updateOcean(renderFrame.time);
+		renderHandler.getDrawHandler().updateRipples(renderFrame.time);
+		gameEngine::screenHandler::recordSceneObjects();
+		renderHandler.getDrawHandler().updateReflectionProbe();
+		passTimes.end(PASS_UPDATE);
+	}
 
-	glDisable(GL_CLIP_DISTANCE0);
-	waterFBOHandler->bindRefractionFrameBuffer();
-	glClear(mask);
-	glEnable(GL_CLIP_DISTANCE1);
-	gameEngine::screenHandler::drawWindowContents(false);
-	waterFBOHandler->unbindCurrentFrameBuffer();
+	// water targets only when some of the lake can be seen
+	glm::mat4 viewMatrix, projectionMatrix;
+	computeCamera(viewMatrix, projectionMatrix);
+	bool waterPasses = waterVisible.passesNeeded(viewMatrix, projectionMatrix);
+	bool layered = renderHandler.getDrawHandler().layeredWaterActive(waterFBOHandler);
+	// rings are rebuilt on a worker while the water targets are drawn
+	renderHandler.getDrawHandler().prepareWaterMesh(glm::vec3(glm::inverse(viewMatrix)[3]));
+
+	// planar reflection only in high quality, otherwise water reflects the probe
+	if (waterPasses && layered) {
+		PROFILE_GPU_ZONE("water layers");
+		passTimes.begin(PASS_WATER_LAYERS);
+		gameEngine::screenHandler::drawLayeredWaterTargets();
+		passTimes.end(PASS_WATER_LAYERS);
+	}
+	else if (waterPasses && gameSettings.waterQuality == WATER_QUALITY_HIGH) {
+		PROFILE_GPU_ZONE("reflection");
+		passTimes.begin(PASS_REFLECTION);
+		waterFBOHandler->bindReflectionFrameBuffer();
+		glClear(mask);
+		gameEngine::screenHandler::drawReflectionContents();
+		waterFBOHandler->unbindCurrentFrameBuffer();
+		passTimes.end(PASS_REFLECTION);
+	}
 
-	glClear(mask);
-	glDisable(GL_CLIP_DISTANCE1);
-	gameEngine::screenHandler::drawWindowContents(true);
-	glutSwapBuffers();
+	if (waterPasses && !layered && gameSettings.waterQuality != WATER_QUALITY_LOW) {
+		PROFILE_GPU_ZONE("refraction");
+		passTimes.begin(PASS_REFRACTION);
+		waterFBOHandler->bindRefractionFrameBuffer();
+		glClear(mask);
+		glEnable(GL_CLIP_DISTANCE1);
+		gameEngine::screenHandler::drawWindowContents(false);
+		waterFBOHandler->unbindCurrentFrameBuffer();
+		passTimes.end(PASS_REFRACTION);
+	}
+
+	{
+		PROFILE_GPU_ZONE("main");
+		passTimes.begin(PASS_MAIN);
+		// water targets reset the viewport to the default window size
+		glViewport(0, 0, gameState.windowWidth, gameState.windowHeight);
+		glClear(mask);
+		glDisable(GL_CLIP_DISTANCE1);
+		gameEngine::screenHandler::drawWindowContents(true);
+		renderHandler.getDrawHandler().finishWaterMesh();
+		passTimes.end(PASS_MAIN);
+	}
+	{
+		PROFILE_GPU_ZONE("hud");
+		passTimes.begin(PASS_HUD);
+		renderHandler.getDrawHandler().drawOverlay(renderFrame.loadingBarWidth, passTimes);
+		passTimes.end(PASS_HUD);
+	}
+	passTimes.endFrame();
+	GL_COUNT_FRAME();
+	ALLOC_FRAME();
+	drawnFrames++;
+	if (metrics.isRunning()) {
+		FrameMetrics frameMetrics;
+		frameMetrics.frame = drawnFrames;
+		frameMetrics.frameTime = performanceHud.getFrameTime();
+		for (int pass = 0; pass < PASS_COUNT; pass++) {
+			frameMetrics.passCpu[pass] = passTimes.getLastCpu(pass);
+			frameMetrics.passGpu[pass] = passTimes.getLastGpu(pass);
+		}
+		frameMetrics.counters = renderCounters;
+		frameMetrics.allocations = ALLOC_LAST_FRAME();
+		metrics.publish(frameMetrics);
+	}
+	PROFILE_FRAME();
+	if (!headlessMode)
+		glutSwapBuffers();
 }
 
 void gameEngine::screenHandler::reshapeCallback(int newWidth, int newHeight) {
@@ -376,122 +636,296 @@ void gameEngine::updateObjects(float elapsedTime) {
 	float timeDelta = elapsedTime - gameObjects.camera->currentTime;
 	gameObjects.camera->currentTime = elapsedTime;
 
-	m_duckHandler.updateDuck(timeDelta); // new position for duck
+	// independent parts of the scene run as jobs, the main thread helps while waiting
+	job* duckJob = jobs.create("duck", [this, timeDelta]() {
+		m_duckHandler.updateDuck(timeDelta); // new position for duck
+	});
+	job* rippleJob = jobs.create("ripple drops", [elapsedTime]() {
+		// ripples behind the swimming duck and around the boat
+		if (duckAnimation && elapsedTime - lastDuckRipple > DUCK_RIPPLE_PERIOD) {
+			lastDuckRipple = elapsedTime;
+			queueRippleDrop(glm::vec2(gameObjects.duck->position), 0.08f, -0.004f);
+		}
+		// find, operator[] would insert into the map the render thread reads
+		std::map<std::string, ObjectProp>::const_iterator boat = m_loadProps.find("boat");
+		if (boat != m_loadProps.end() && elapsedTime - lastBoatRipple > BOAT_RIPPLE_PERIOD) {
+			lastBoatRipple = elapsedTime;
+			queueRippleDrop(glm::vec2(boat->second.position), 0.25f, -0.003f);
+		}
+	});
+	jobs.depend(rippleJob, duckJob);
+	job* cameraJob = jobs.create("camera", [timeDelta, elapsedTime]() {
+		if (gameState.flythroughMode) { // recorded flight, loops while it is on
+			glm::vec3 center;
+			float time = fmod(elapsedTime - flythroughStart, glm::max(flythroughCamera.getDuration(), 0.001f));
+			flythroughCamera.evaluate(time, gameObjects.camera->position, center);
+			gameObjects.camera->direction = glm::normalize(center - gameObjects.camera->position);
+			gameObjects.camera->elevationAngle = 0.0f;
+		}
+		else if (gameState.curveMotion == true) { // show spline motion
+			gameObjects.camera->startTime += timeDelta;
+			float a = gameObjects.camera->startTime;
+			a *= 0.1;
+			gameObjects.camera->position = splineFucHandler.evaluateMovementCurve(curveData, curveSize, a);
+			gameObjects.camera->direction = glm::normalize(splineFucHandler.evalMovementCurveFirstDev(curveData, curveSize, a));
+		}
+		else {// normal camera static/free
+			glm::vec3 new_position = gameObjects.camera->position + timeDelta * gameObjects.camera->speed * gameObjects.camera->direction;
+			if (!collisionController(new_position)) {
+				gameObjects.camera->position = new_position;
+			}
+			else {
+				gameObjects.camera->speed = 0.0f;
+			}
+			gameObjects.camera->position = new_position;
+
+			camHandler.controlBorders(gameObjects.camera);
+			camHandler.computeCameraPosition(gameState);
+		}
+	});
+	job* explosionJob = jobs.create("explosions", [elapsedTime]() {
+		// update explosion
+		for (size_t slot = 0; slot < explosions.getSlotEnd(); slot++) {
+			if (!explosions.isAlive(slot))
+				continue;
+			Explosion* explosion = &explosions[slot];
+			explosion->currentTime = elapsedTime;
+
+			controlExplosion(explosion);
+
+			if (explosion->destroyed == true)
+				explosions.destroy(explosions.getHandle(slot));
+		}
+	});
+	job* maxwellJob = jobs.create("maxwell", [this, timeDelta]() {
+		//blow cat after explosion
+		if (gameState.blowMaxwell) {
+			m_maxwellHandler.updateMaxwell(timeDelta); //new movement for maxwell
+		}
+	});
+	job* buoyancyJob = jobs.create("buoyancy", [timeDelta]() {
+		// floating props follow the waves, chunks of whole SIMD batches
+		jobs.parallelFor("buoyancy bodies", buoyancy.getBodyCount(), BUOYANCY_JOB_BODIES, [timeDelta](int first, int last) {
+			buoyancy.updateBodies(timeDelta, first, last);
+		});
+	});
+	job* frameJobs[] = { duckJob, rippleJob, cameraJob, explosionJob, maxwellJob, buoyancyJob };
+	for (job* task : frameJobs)
+		jobs.submit(task);
+
 	if (gameState.isCloudy)
 		gameHandler->evalLightIntensity(); // change light intensity with according to game time
 	else 
-		gameUniVars.lightIntensity = 0.9f; //else eval intensity back to normal
+		daylightIntensity = 0.9f; //else eval intensity back to normal
+
+	currentColor = mix(currentColor, day, timeDelta);
+
+	for (job* task : frameJobs)
+		jobs.wait(task);
 
 	loadingBarWidth = glm::clamp(gameObjects.camera->speed / 10.0f, 0.0f, 1.0f); //clam curr speed
+}
 
-	currentColor = mix(currentColor, day, timeDelta);
 
-	if (gameState.curveMotion == true) { // show spline motion
-		gameObjects.camera->startTime += timeDelta;
-		float a = gameObjects.camera->startTime;
-		a *= 0.1;
-		gameObjects.camera->position = splineFucHandler.evaluateMovementCurve(curveData, curveSize, a);
-		gameObjects.camera->direction = glm::normalize(splineFucHandler.evalMovementCurveFirstDev(curveData, curveSize, a));
-	}
-	else {// normal camera static/free
-		glm::vec3 new_position = gameObjects.camera->position + timeDelta * gameObjects.camera->speed * gameObjects.camera->direction;
-		if (!collisionController(new_position)) {
-			gameObjects.camera->position = new_position;
-		}
-		else {
-			gameObjects.camera->speed = 0.0f;
-		}
-		gameObjects.camera->position = new_position;
-	
-		camHandler.controlBorders(gameObjects.camera);
-		camHandler.computeCameraPosition(gameState);
-	}
-	// update explosion
-	std::list <Explosion*>::iterator it;
-	it = explosions.begin();
-	while (it != explosions.end()) {
-		Explosion* explosion = (Explosion*)(*it);
-		explosion->currentTime = elapsedTime;
-
-		controlExplosion(explosion);
-
-		if (explosion->destroyed == true) {
-			it = explosions.erase(it);
-		}
-		else {
-			++it;
+//-----------------------------------------------------------UPDATE SCREEN--------------------------------------------------------------
+
+// recorded input due before the next step, in the order it came in
+static void replayInput() {
+	InputEvent event;
+	while (inputLog.nextEvent(event)) {
+		switch (event.type) {
+		case INPUT_KEY:
+			gameEngine::keyBoardHandler::handleKey(event.code);
+			break;
+		case INPUT_SPECIAL_DOWN:
+			gameEngine::keyBoardHandler::handleSpecialKey(event.code);
+			break;
+		case INPUT_SPECIAL_UP:
+			gameEngine::keyBoardHandler::handleSpecialKeyUp(event.code);
+			break;
+		case INPUT_MOUSE_LOOK:
+			gameEngine::screenHandler::mouseLook(event.x, event.y);
+			break;
+		case INPUT_CLICK:
+			gameEngine::screenHandler::handleClick(event.code, event.flags != 0, glm::vec2(event.x, event.y));
+			break;
+		case INPUT_MENU:
+			gameEngine::handleMenu(event.code);
+			break;
+		default:
+			;
 		}
 	}
+}
 
-	//blow cat after explosion
-	if (gameState.blowMaxwell) {
-		m_maxwellHandler.updateMaxwell(timeDelta); //new movement for maxwell
+// fixed steps that catch up with real time
+static void runSimulationSteps(int steps) {
+	// jobs of the previous frame are released once new steps start
+	if (steps > 0)
+		jobs.beginFrame();
+	PROFILE_ZONE("simulation");
+	ALLOC_SCOPE("simulation");
+	// pass timer and GL counters belong to the GL thread, the simulation thread
+	// only adds up its time for the next drawn frame
+	bool ownThread = simulationRunning;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (!ownThread)
+		passTimes.begin(PASS_SIMULATION);
+	for (int i = 0; i < steps; i++) {
+		if (inputLog.isReplaying())
+			replayInput();
+		previousSnapshot = captureSnapshot();
+		simulationClock.tick();
+		gameEngine::screenHandler::simulateStep();
+		inputLog.step();
 	}
-	
-	// set color
-	glClearColor(currentColor.x, currentColor.y, currentColor.z, 1);
+	if (!ownThread)
+		passTimes.end(PASS_SIMULATION);
+	else
+		simulationMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
 }
 
+// main loop - simulation catches up with real time in fixed steps, then one frame is drawn
+void gameEngine::screenHandler::idleCallback() {
+	if (inputLog.finished()) { // whole recorded session was played back
+		passTimes.finish();
+		std::cout << "Replay finished after " << inputLog.getTick() << " steps" << std::endl;
+		passTimes.printReport(std::cout);
+		inputLog.stop();
+		glutLeaveMainLoop();
+		return;
+	}
 
-//-----------------------------------------------------------UPDATE SCREEN--------------------------------------------------------------
+	if (simulationRunning) {
+		// simulation thread publishes frames, this thread only draws the newest one
+		simulationFrames.acquire();
+	}
+	else {
+		// replay runs on virtual time, one step per frame however long the frames take
+		if (inputLog.isReplaying())
+			simulationClock.addTime(SIMULATION_STEP);
+		runSimulationSteps(simulationClock.advance());
+	}
 
-void gameEngine::screenHandler::timerCallback(int) {
+	if (simulationClock.frameDue(gameSettings.maxFrameRate))
+		glutPostRedisplay();
+	else
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+// one fixed step of game logic, same steps give the same game on every machine
+void gameEngine::screenHandler::simulateStep() {
 
 	// update scene time
-	gameState.elapsedTime = 0.001f * (float)glutGet(GLUT_ELAPSED_TIME); // milliseconds => seconds
+	gameState.elapsedTime = (float)simulationClock.getSimulationTime();
 
 	// call appropriate actions according to the currently pressed keys in key map
 	// (combinations of keys are supported but not used in this implementation)
 	if (gameState.keyMap[KEY_RIGHT_ARROW] == true ) {
-		camHandler.turnCameraRight(gameObjects.camera, CAMERA_VIEW_ANGLE_DELTA);
+		camHandler.turnCameraRight(gameObjects.camera, CAMERA_VIEW_ANGLE_DELTA * INPUT_STEP_SCALE);
 	}
 	if (gameState.keyMap[KEY_LEFT_ARROW] == true ) {
-		camHandler.turnCameraLeft(gameObjects.camera, CAMERA_VIEW_ANGLE_DELTA);
+		camHandler.turnCameraLeft(gameObjects.camera, CAMERA_VIEW_ANGLE_DELTA * INPUT_STEP_SCALE);
 	}
 	if (gameState.keyMap[KEY_UP_ARROW] == true && gameState.freeCameraMode ) {
-		camHandler.increaseCameraSpeed(gameObjects.camera, CAMERA_SPEED_INCREMENT);
+		camHandler.increaseCameraSpeed(gameObjects.camera, CAMERA_SPEED_INCREMENT * INPUT_STEP_SCALE);
 
 	}
 	if (gameState.keyMap[KEY_DOWN_ARROW] == true && gameState.freeCameraMode ) {
-		camHandler.decreaseCameraSpeed(gameObjects.camera, CAMERA_SPEED_INCREMENT);
+		camHandler.decreaseCameraSpeed(gameObjects.camera, CAMERA_SPEED_INCREMENT * INPUT_STEP_SCALE);
 
 	}
 	// update objects in the scene
 	gameHandler->updateObjects(gameState.elapsedTime);
-	// set timeCallback next invocation
-	glutTimerFunc(33, timerCallback, 0);
 
-	glutPostRedisplay();
+	// flights are sampled on the steps, the same recording gives the same keys
+	if (flythroughRecording.isRecording() && gameState.freeCameraMode) {
+		Camera* camera = gameObjects.camera;
+		flythroughRecording.addSample(gameState.elapsedTime, camera->position, camera->position + cameraHandler::getViewDirection(camera));
+	}
 }
 
-// passive mouse callback - camera motion
-void gameEngine::screenHandler::passiveMouseMotionCallback(int mouseX, int mouseY) {
-	if (!gameState.curveMotion) {
-		if (mouseY != gameState.windowHeight / 2) {
+// simulation thread - steps run while the GLUT thread draws the previous frame,
+// every batch of steps is published as one frame
+void gameEngine::screenHandler::simulationLoop() {
+	PROFILE_THREAD_NAME("simulation");
+	frameArena::makeCurrent(&simulationArena);
+	while (simulationRunning) {
+		int steps = simulationClock.advance();
+		if (steps == 0) {
+			// sleep until the next step is due
+			double wait = (1.0 - simulationClock.getAlpha()) * SIMULATION_STEP;
+			std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+			continue;
+		}
+		{
+			std::lock_guard<std::mutex> lock(simulationMutex);
+			simulationArena.reset();
+			runSimulationSteps(steps);
+			captureFrame(simulationFrames.beginWrite());
+		}
+		simulationFrames.publish();
+	}
+}
 
-			float cameraElevationAngleDelta = 0.5f * (mouseY - gameState.windowHeight / 2);
-			if (fabs(gameObjects.camera->elevationAngle + cameraElevationAngleDelta) < CAMERA_ELEVATION_MAX_Y)
-				gameObjects.camera->elevationAngle += cameraElevationAngleDelta;
+void gameEngine::screenHandler::startSimulationThread() {
+	if (simulationRunning)
+		return;
+	// first frame exists before the thread starts
+	captureFrame(simulationFrames.beginWrite());
+	simulationFrames.publish();
+	simulationFrames.acquire();
 
+	simulationRunning = true;
+	simulationThread = std::thread(simulationLoop);
+}
 
-			glutWarpPointer(gameState.windowWidth / 2, gameState.windowHeight / 2);
+void gameEngine::screenHandler::stopSimulationThread() {
+	if (!simulationRunning)
+		return;
+	simulationRunning = false;
+	simulationThread.join();
+}
 
-			glutPostRedisplay();
-		}
-		if (mouseX != gameState.windowWidth / 2) {
+// passive mouse callback - camera motion
+void gameEngine::screenHandler::passiveMouseMotionCallback(int mouseX, int mouseY) {
+	if (inputLog.isReplaying()) // camera is turned by the recording
+		return;
+	float deltaX = (float)(mouseX - gameState.windowWidth / 2);
+	float deltaY = (float)(mouseY - gameState.windowHeight / 2);
+	if (deltaX == 0.0f && deltaY == 0.0f)
+		return;
 
-			float cameraElevationAngleDelta = 0.5f * (mouseX - gameState.windowWidth / 2);
-			camHandler.turnCamera(gameObjects.camera, -cameraElevationAngleDelta);
+	// offset from the center is recorded, replay does not depend on the window size
+	inputLog.record(INPUT_MOUSE_LOOK, 0, deltaX, deltaY);
+	if (mouseLook(deltaX, deltaY)) {
+		glutWarpPointer(gameState.windowWidth / 2, gameState.windowHeight / 2);
+		glutPostRedisplay();
+	}
+}
 
-			glutWarpPointer(gameState.windowWidth / 2, gameState.windowHeight / 2);
+// turns the free camera by mouse offset from the window center
+bool gameEngine::screenHandler::mouseLook(float deltaX, float deltaY) {
+	std::lock_guard<std::mutex> lock(simulationMutex);
+	if (gameState.curveMotion)
+		return false;
 
-			glutPostRedisplay();
-		}
+	if (deltaY != 0.0f) {
+		float cameraElevationAngleDelta = 0.5f * deltaY;
+		if (fabs(gameObjects.camera->elevationAngle + cameraElevationAngleDelta) < CAMERA_ELEVATION_MAX_Y)
+			gameObjects.camera->elevationAngle += cameraElevationAngleDelta;
 	}
+	if (deltaX != 0.0f) {
+		float cameraElevationAngleDelta = 0.5f * deltaX;
+		camHandler.turnCamera(gameObjects.camera, -cameraElevationAngleDelta);
+	}
+	return true;
 }
 
 // interaction with mouse
 void gameEngine::screenHandler::mouseCallback(int buttonPressed, int buttonState, int mouseX, int mouseY) {
+	if (inputLog.isReplaying()) // clicks come from the recording
+		return;
 
 	// interaction with left button down
 	if ((buttonPressed == GLUT_LEFT_BUTTON) && (buttonState == GLUT_DOWN)) {
@@ -499,20 +933,19 @@ void gameEngine::screenHandler::mouseCallback(int buttonPressed, int buttonState
 		glReadPixels(mouseX, gameState.windowHeight - mouseY - 1,
 			1, 1, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, &objectID
 		);
-		if (objectID == 1) { // sphere
-			gameHandler->changePointLight();
-		} if (objectID == 2) { // duck animation
-			duckAnimation = !duckAnimation;
-		} if (objectID == 3) { // boat
-			gameState.blowMaxwell = !gameState.blowMaxwell;
-			if (gameState.blowMaxwell) {
-				gameObjects.maxwellObj->currentTime = 0.0;
-				createExplosion(m_loadProps["maxwell"].position);
-			}
-			else {
-				gameObjects.maxwellObj->position = gameObjects.maxwellObj->origPos;
-			}
+		bool water = false;
+		glm::vec3 clicked = glm::vec3(0.0f);
+		if (objectID == 0) { // water
+			float depth = 1.0f;
+			glReadPixels(mouseX, gameState.windowHeight - mouseY - 1, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
+			clicked = glm::unProject(glm::vec3(mouseX, gameState.windowHeight - mouseY - 1, depth), lastViewMatrix,
+				lastProjectionMatrix, glm::vec4(0, 0, gameState.windowWidth, gameState.windowHeight));
+			// only pixels that belong to water surface, not sky or buildings
+			water = depth < 1.0f && fabs(clicked.z - WATER_Z) < 0.15f;
 		}
+		// result of picking is recorded, replay does not read the screen
+		inputLog.record(INPUT_CLICK, objectID, clicked.x, clicked.y, water ? 1 : 0);
+		handleClick(objectID, water, glm::vec2(clicked));
 	}
 	if ((buttonPressed == GLUT_RIGHT_BUTTON) && (buttonState == GLUT_DOWN)) {
 		int objectID = 0;
@@ -521,24 +954,62 @@ void gameEngine::screenHandler::mouseCallback(int buttonPressed, int buttonState
 	}
 }
 
+// actions of a picked object, water point is valid when water was hit
+void gameEngine::screenHandler::handleClick(int objectID, bool water, const glm::vec2& waterPoint) {
+	std::unique_lock<std::mutex> lock(simulationMutex);
+	if (objectID == 1) { // sphere
+		gameHandler->changePointLight();
+	}
+	else if (objectID == 2) { // duck animation
+		duckAnimation = !duckAnimation;
+	}
+	else if (objectID == 3) { // boat
+		gameState.blowMaxwell = !gameState.blowMaxwell;
+		if (gameState.blowMaxwell) {
+			gameObjects.maxwellObj->currentTime = 0.0;
+			createExplosion(m_loadProps["maxwell"].position);
+		}
+		else {
+			gameObjects.maxwellObj->position = gameObjects.maxwellObj->origPos;
+		}
+	}
+	// ripples belong to the render thread
+	lock.unlock();
+	if (water) {
+		ripples.addDrop(waterPoint, 0.15f, -0.03f);
+	}
+}
+
 //-----------------------------------------------------------------------KEYBOARD SETTINGS-----------------------------------------------
 // shortcuts to change mood
 void gameEngine::keyBoardHandler::keyboardCallback(unsigned char keyPressed, int mouseX, int mouseY) {
-
-	switch (keyPressed) {
-	case 27: // escape
+	if (keyPressed == 27) { // escape, never recorded so it also ends a replay
 #ifndef __APPLE__
 		glutLeaveMainLoop();
 #else
 		exit(0);
 #endif
-		break;
+		return;
+	}
+	if (inputLog.isReplaying())
+		return;
+	inputLog.record(INPUT_KEY, keyPressed);
+	handleKey(keyPressed);
+}
+
+void gameEngine::keyBoardHandler::handleKey(unsigned char keyPressed) {
+	// keys change state read by the simulation thread
+	std::unique_lock<std::mutex> lock(simulationMutex);
+
+	switch (keyPressed) {
 	case 'r': // restart game & load data from config
+		lock.unlock(); // stops the simulation thread
 		gameHandler->initializeApplication();
+		lock.lock();
 		gameHandler->restartGame();
 		break;
 	case 'c': // switch camera
-		if (!gameState.curveMotion) {
+		if (!gameState.curveMotion && !gameState.flythroughMode) {
 
 			gameState.freeCameraMode = !gameState.freeCameraMode;
 			if (gameState.freeCameraMode) {
@@ -559,6 +1030,8 @@ void gameEngine::keyBoardHandler::keyboardCallback(unsigned char keyPressed, int
 		break;
 
 	case 'm': // turn on curve motion
+		if (gameState.flythroughMode)
+			break;
 		gameState.curveMotion = !gameState.curveMotion;
 		if (!gameState.curveMotion) {
 			gameObjects.camera->speed = 0;
@@ -571,6 +1044,44 @@ void gameEngine::keyBoardHandler::keyboardCallback(unsigned char keyPressed, int
 			freeCamPos = gameObjects.camera->position;
 		}
 		break;
+	case 'k': // record the free camera as a flythrough
+		if (flythroughRecording.isRecording())
+			flythroughRecording.stop(gameSettings.flythroughTolerance);
+		else if (gameState.freeCameraMode)
+			flythroughRecording.start();
+		break;
+	case 'v': // flythroughs of the settings in turn, then back to the camera before them
+		if (gameState.curveMotion || flythroughRecording.isRecording())
+			break;
+		{
+			std::vector<std::string> names = flythroughRecorder::parseNames(gameSettings.flythroughs);
+			if (!gameState.flythroughMode) {
+				freeCamDir = gameObjects.camera->direction;
+				freeCamPos = gameObjects.camera->position;
+			}
+			gameState.flythroughMode = false;
+			while (flythroughIndex < names.size() && !gameState.flythroughMode) {
+				const std::string& name = names[flythroughIndex++];
+				if (flythroughCamera.load(flythroughRecorder::getPath(name))) {
+					gameState.flythroughMode = true;
+					flythroughStart = gameState.elapsedTime;
+					std::cout << "flythrough: " << name << ", " << flythroughCamera.getDuration() << " s" << std::endl;
+				}
+			}
+			if (gameState.flythroughMode) {
+				gameObjects.camera->speed = 0;
+				if (gameState.freeCameraMode) {
+					gameState.freeCameraMode = false;
+					glutPassiveMotionFunc(NULL);
+				}
+			}
+			else {
+				flythroughIndex = 0;
+				gameObjects.camera->direction = freeCamDir;
+				gameObjects.camera->position = freeCamPos;
+			}
+		}
+		break;
 	case ' ': // turn camera reflektor
 		if (gameState.freeCameraMode)
 			gameUniVars.spotLight = !gameUniVars.spotLight;
@@ -587,6 +1098,14 @@ void gameEngine::keyBoardHandler::keyboardCallback(unsigned char keyPressed, int
 	case 's':
 		camHandler.moveCamDown(gameObjects.camera, -0.3f);
 		break;
+	case 'j': // timings of the last frame jobs
+		jobs.printReport(std::cout);
+		break;
+	case 'h': // performance overlay, passes are timed while it is on
+		performanceHud.toggle();
+		if (performanceHud.isVisible() && !passTimes.isEnabled())
+			passTimes.init(false);
+		break;
 	default:
 		;
 	}
@@ -594,9 +1113,17 @@ void gameEngine::keyBoardHandler::keyboardCallback(unsigned char keyPressed, int
 
 //special key is pressed
 void gameEngine::keyBoardHandler::specialKeyboardCallback(int specKeyPressed, int mouseX, int mouseY) {
+	if (inputLog.isReplaying())
+		return;
+	inputLog.record(INPUT_SPECIAL_DOWN, specKeyPressed);
+	handleSpecialKey(specKeyPressed);
+}
+
+void gameEngine::keyBoardHandler::handleSpecialKey(int specKeyPressed) {
 
 	if (gameState.gameOver == true)
 		return;
+	std::lock_guard<std::mutex> lock(simulationMutex);
 
 	switch (specKeyPressed) {
 	case GLUT_KEY_RIGHT:
@@ -618,9 +1145,17 @@ void gameEngine::keyBoardHandler::specialKeyboardCallback(int specKeyPressed, in
 
 // special keys released
 void gameEngine::keyBoardHandler::specialKeyboardUpCallback(int specKeyReleased, int mouseX, int mouseY) {
+	if (inputLog.isReplaying())
+		return;
+	inputLog.record(INPUT_SPECIAL_UP, specKeyReleased);
+	handleSpecialKeyUp(specKeyReleased);
+}
+
+void gameEngine::keyBoardHandler::handleSpecialKeyUp(int specKeyReleased) {
 
 	if (gameState.gameOver == true)
 		return;
+	std::lock_guard<std::mutex> lock(simulationMutex);
 
 	switch (specKeyReleased) {
 	case GLUT_KEY_RIGHT:
@@ -642,6 +1177,18 @@ void gameEngine::keyBoardHandler::specialKeyboardUpCallback(int specKeyReleased,
 //---------------------------------------------------------CREATING MENU----------------------------------------------------------
 // Function processing game menu
 void gameEngine::gameMenu(int choice) {
+	if (choice == 9) { // exit, never recorded
+		glutLeaveMainLoop();
+		return;
+	}
+	if (inputLog.isReplaying())
+		return;
+	inputLog.record(INPUT_MENU, choice);
+	handleMenu(choice);
+}
+
+void gameEngine::handleMenu(int choice) {
+	std::unique_lock<std::mutex> lock(simulationMutex);
 	switch (choice)
 	{
 	case 0:
@@ -692,12 +1239,11 @@ void gameEngine::gameMenu(int choice) {
 		gameHandler->changePointLight();
 		break;
 	case 8:
+		lock.unlock(); // stops the simulation thread
 		gameHandler->initializeApplication();
+		lock.lock();
 		gameHandler->restartGame();
 		break;
-	case 9:
-		glutLeaveMainLoop();
-		break;
 	}
 }
 
@@ -737,24 +1283,37 @@ void gameEngine::createMenu(void) {
 
 // Called after the window and OpenGL are initialized. Called exactly once, before the main loop.
 void gameEngine::initializeApplication() {
+	PROFILE_ZONE("initializeApplication");
+	screenHandler::stopSimulationThread();
 	m_loadProps = loadConfig(CONFIG_PATH); //load data from config to map - only for restart
-
-	glutDisplayFunc(m_screenHandler.displayCallback);
-	// register callback for change of window size
-	glutReshapeFunc(m_screenHandler.reshapeCallback);
-	// register callbacks for keyboard
-	glutKeyboardFunc(m_keyBoardHandler.keyboardCallback);     // key pressed
-	glutSpecialFunc(m_keyBoardHandler.specialKeyboardCallback);     // special key pressed
-	glutSpecialUpFunc(m_keyBoardHandler.specialKeyboardUpCallback); // key released
-
-	glutTimerFunc(33, m_screenHandler.timerCallback, 0);
+	gameSettings = loadSettings(SETTINGS_PATH);
+	// frames follow the virtual clock one by one, recorded input falls between steps
+	if (headlessMode || inputLog.isActive())
+		gameSettings.renderThread = false;
+	jobs.init(gameSettings.jobThreads);
+	GL_COUNT_DUMP_EVERY(gameSettings.glCountersEvery);
+	ALLOC_DUMP_EVERY(gameSettings.allocEvery);
+
+	// headless benchmark has no window to get callbacks from
+	if (!headlessMode) {
+		glutDisplayFunc(m_screenHandler.displayCallback);
+		// register callback for change of window size
+		glutReshapeFunc(m_screenHandler.reshapeCallback);
+		// register callbacks for keyboard
+		glutKeyboardFunc(m_keyBoardHandler.keyboardCallback);     // key pressed
+		glutSpecialFunc(m_keyBoardHandler.specialKeyboardCallback);     // special key pressed
+		glutSpecialUpFunc(m_keyBoardHandler.specialKeyboardUpCallback); // key released
+
+		glutIdleFunc(m_screenHandler.idleCallback);
+	}
 
 	// initialize PGR framework (GL, DevIl, etc.)
 	if (!pgr::initialize(pgr::OGL_VER_MAJOR, pgr::OGL_VER_MINOR))
 		pgr::dieWithError("pgr init failed, required OpenGL not supported?");
+	PROFILE_GPU_INIT();
 
-	// initialize random seed
-	srand((unsigned int)time(NULL));
+	// initialize random seed, recorded session keeps its own
+	srand(inputLog.isActive() ? inputLog.getSeed() : (unsigned int)time(NULL));
 	glClearColor(0.06f, 0.08f, 0.16f, 1.0f);
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_BLEND); // enable blending
@@ -769,33 +1328,350 @@ void gameEngine::initializeApplication() {
 	waterFBOHandler= new waterBufferMaker();
 	// initialize shaders
 	renderHandler.getInitHandler().initializeShaderPrograms();
+	startupTimes.mark("shaderPrograms");
 	setupLights();
 	renderHandler.getInitHandler().setLight( sun, cameraReflector, sphereLight );
-	// create geometry for all models used
+	// create geometry for all models used, restart loads them again so the counts start over
+	renderCounters.textureBytes = 0;
+	renderCounters.texturesLoaded = 0;
+	renderCounters.meshesLoaded = 0;
 	renderHandler.getInitHandler().initializeModels(waterFBOHandler);
-	glutMouseFunc(m_screenHandler.mouseCallback);
-	gameObjects.camera = NULL;
-
-	createMenu();
+	startupTimes.mark("models");
+	renderHandler.getInitHandler().initOcean(gameSettings);
+	renderHandler.getInitHandler().initReflectionProbe(gameSettings);
+	renderHandler.getInitHandler().initRipples();
+	initBuoyancy();
+	if (gameSettings.layeredWater)
+		waterFBOHandler->initialiseLayeredFrameBuffer();
+
+	if (!headlessMode) {
+		glutMouseFunc(m_screenHandler.mouseCallback);
+		createMenu();
+	}
 
+	simulationClock.start();
 	gameHandler->restartGame();
+	if (gameSettings.renderThread)
+		screenHandler::startSimulationThread();
 }
 
 
+void gameEngine::initBuoyancy() {
+	renderHandler.getInitHandler().initBuoyancy(m_loadProps);
+}
+
 // Clean all structures
 void gameEngine::finalizeApplication() {
+	screenHandler::stopSimulationThread();
+	inputLog.stop();
+	metrics.stop();
+	if (gameSettings.renderThread)
+		std::cout << "Simulation published " << simulationFrames.getPublished() << " frames, "
+			<< simulationFrames.getAcquired() << " of them were drawn" << std::endl;
+
+	std::cout << "Water passes skipped in " << waterVisible.getCulledFrames() << " frames out of view and "
+		<< waterVisible.getOccludedFrames() << " occluded frames, " << waterVisible.getTestedFrames() << " frames total" << std::endl;
+#ifdef _DEBUG
+	renderArena.printReport(std::cout, "render");
+	simulationArena.printReport(std::cout, "simulation");
+	jobs.printArenaReport(std::cout);
+#endif
+
+	PROFILE_WRITE(PROFILER_TRACE_FILE);
+	PROFILE_SHUTDOWN();
 
-	delete gameObjects.camera;
+	cameras.reset();
+	animatedObjects.reset();
+	explosions.reset();
 	gameObjects.camera = NULL;
-	delete gameObjects.duck;
+	gameObjects.duck = NULL;
+	gameObjects.maxwellObj = NULL;
+	gameObjects.poolObj = NULL;
+	gameObjects.ballObj = NULL;
 	delete gameHandler;
 	delete waterFBOHandler;
 	renderHandler.cleanupModels();
 	renderHandler.cleanupShaderPrograms();
+	jobs.shutdown();
+}
+
+// frames on virtual time with the pass timer collecting every one of them
+static void drawHeadlessFrames(int frames, double frameTime = HEADLESS_FRAME_TIME) {
+	passTimes.init(true, frames);
+	for (int i = 0; i < frames; i++) {
+		if (i == ALLOC_WARMUP_FRAMES) // caches and buffers have grown by now
+			ALLOC_RESET_TOTALS();
+		passTimes.begin(PASS_FRAME);
+		simulationClock.addTime(frameTime);
+		runSimulationSteps(simulationClock.advance());
+		gameEngine::screenHandler::displayCallback();
+		passTimes.end(PASS_FRAME);
+	}
+	passTimes.finish();
+	ALLOC_PRINT_SUMMARY(std::cout);
+}
+
+// the application on an offscreen context of the settings size and on virtual time
+static void initializeHeadless() {
+	gameHandler->initializeApplication();
+	glViewport(0, 0, gameState.windowWidth, gameState.windowHeight);
+}
+
+// common start of the benchmark modes, startup times the initialization itself and
+// calls initializeHeadless on its own
+static bool setupHeadless(headlessContext& context, const GameSettings& settings, bool initialize = true) {
+	if (!context.create(settings.headlessWidth, settings.headlessHeight))
+		return false;
+	headlessMode = true;
+	gameState.windowWidth = settings.headlessWidth;
+	gameState.windowHeight = settings.headlessHeight;
+	simulationClock.setManual(true);
+	if (initialize)
+		initializeHeadless();
+	return true;
+}
+
+// "-" writes the report to standard output, so does a file that cannot be opened
+static std::ostream& openReport(const std::string& fileName, std::ofstream& file) {
+	if (fileName == "-")
+		return std::cout;
+	file.open(fileName);
+	if (file.is_open())
+		return file;
+	std::cerr << "Error: report '" << fileName << "' cannot be written" << std::endl;
+	return std::cout;
+}
+
+// first fields of the JSON reports, the caller continues with its own
+static void writeReportHeader(std::ostream& out, headlessContext& context, double frameTime) {
+	out << "{\n  \"backend\": \"" << context.getBackend() << "\",\n"
+		<< "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+		<< "  \"width\": " << gameState.windowWidth << ",\n"
+		<< "  \"height\": " << gameState.windowHeight << ",\n"
+		<< "  \"frameTime\": " << frameTime << ",\n"
+		<< "  \"waterQuality\": " << gameSettings.waterQuality << ",\n";
+}
+
+// benchmark without a display - offscreen context, scripted camera and virtual time,
+// timings of every pass are printed and written as JSON
+static int runHeadless() {
+	headlessContext context;
+	if (!setupHeadless(context, loadSettings(SETTINGS_PATH)))
+		return 1;
+	if (!benchCamera.load(gameSettings.headlessCamera))
+		std::cerr << "headless: camera stays at its default position" << std::endl;
+
+	drawHeadlessFrames(gameSettings.headlessFrames);
+	passTimes.printReport(std::cout);
+
+	std::ofstream file;
+	std::ostream& out = openReport(gameSettings.headlessReport, file);
+	writeReportHeader(out, context, HEADLESS_FRAME_TIME);
+	out << "  \"frames\": " << gameSettings.headlessFrames << ",\n"
+		<< "  \"passes\": ";
+	passTimes.writeJson(out);
+	out << "\n}" << std::endl;
+
+	passTimes.cleanUp();
+	gameEngine::finalizeApplication();
+	context.destroy();
+	return 0;
+}
+
+// time to the first frame, every asset split into loading stages - the cold scenario drops
+// the assets from the page cache first, the warm one reads them all in advance
+static int runStartup(const std::string& scenario) {
+	if (scenario != "cold" && scenario != "warm") {
+		std::cerr << "Error: startup scenario has to be cold or warm" << std::endl;
+		return 1;
+	}
+	headlessContext context;
+	if (!setupHeadless(context, loadSettings(SETTINGS_PATH), false))
+		return 1;
+
+	// shaders lie next to the executable, everything else in data
+	int files = 0;
+	if (scenario == "cold")
+		files = startupTimer::evictFiles("data", true) + startupTimer::evictFiles(".", false);
+	else
+		files = startupTimer::touchFiles("data", true) + startupTimer::touchFiles(".", false);
+	std::cout << "startup: " << files << " files " << (scenario == "cold" ? "evicted" : "cached") << std::endl;
+
+	startupTimes.start(scenario);
+	initializeHeadless();
+	startupTimes.mark("initialized");
+	simulationClock.addTime(HEADLESS_FRAME_TIME);
+	runSimulationSteps(simulationClock.advance());
+	gameEngine::screenHandler::displayCallback();
+	glFinish();
+	startupTimes.mark("firstFrame");
+	startupTimes.printReport(std::cout);
+
+	std::ofstream file;
+	startupTimes.writeJson(openReport(gameSettings.startupReport, file));
+
+	gameEngine::finalizeApplication();
+	context.destroy();
+	return 0;
+}
+
+// scaling benchmark - the scene gets generated props of every count in turn, median pass
+// times and the config loading time are written as one CSV row per count
+static int runSweep() {
+	GameSettings settings = loadSettings(SETTINGS_PATH);
+	SceneLayout layout;
+	layout.distribution = sceneGenerator::parseDistribution(settings.sweepDistribution);
+	if (layout.distribution < 0) {
+		std::cerr << "Error: unknown distribution '" << settings.sweepDistribution << "'" << std::endl;
+		return 1;
+	}
+	std::vector<int> counts;
+	std::stringstream list(settings.sweepCounts);
+	std::string count;
+	while (std::getline(list, count, ',')) {
+		// whole item has to be a positive number, "10,,20" or "abc" is a config error
+		size_t parsed = 0;
+		int value = 0;
+		try {
+			value = std::stoi(count, &parsed);
+		}
+		catch (const std::exception&) {
+			parsed = 0;
+		}
+		if (parsed == 0 || count.find_first_not_of(" \t", parsed) != std::string::npos || value <= 0) {
+			std::cerr << "Error: sweep count '" << count << "' in '" << settings.sweepCounts << "' is not a positive number" << std::endl;
+			return 1;
+		}
+		counts.push_back(value);
+	}
+
+	headlessContext context;
+	if (!setupHeadless(context, settings))
+		return 1;
+	if (!benchCamera.load(gameSettings.headlessCamera))
+		std::cerr << "headless: camera stays at its default position" << std::endl;
+
+	std::ofstream report(gameSettings.sweepReport);
+	if (!report.is_open())
+		std::cerr << "Error: report '" << gameSettings.sweepReport << "' cannot be written" << std::endl;
+	report << "props,loadConfig";
+	for (int pass = 0; pass < PASS_COUNT; pass++)
+		report << "," << passTimer::getName(pass) << " cpu," << passTimer::getName(pass) << " gpu";
+	report << std::endl;
+
+	const char* sweepConfig = "data/sweepConfig.txt";
+	std::vector<double> frameTimes;
+	for (size_t i = 0; i < counts.size(); i++) {
+		layout.count = counts[i];
+		if (!sceneGenerator::write(sweepConfig, CONFIG_PATH, layout))
+			break;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		m_loadProps = loadConfig(sweepConfig);
+		double loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		gameHandler->initBuoyancy();
+		remove(sweepConfig);
+
+		drawHeadlessFrames(gameSettings.sweepFrames);
+		report << std::fixed << std::setprecision(4) << counts[i] << "," << loadTime;
+		for (int pass = 0; pass < PASS_COUNT; pass++)
+			report << "," << passTimes.getMedian(pass, false) << "," << passTimes.getMedian(pass, true);
+		report << std::endl;
+		frameTimes.push_back(passTimes.getMedian(PASS_FRAME, false));
+		std::cout << "sweep: " << counts[i] << " props, loadConfig " << loadTime << " ms, frame "
+			<< frameTimes.back() << " ms" << std::endl;
+	}
+
+	// frame time against the prop count, bars relative to the slowest run
+	double slowest = 0.0;
+	for (size_t i = 0; i < frameTimes.size(); i++)
+		slowest = std::max(slowest, frameTimes[i]);
+	std::cout << "Median frame time (" << settings.sweepDistribution << "):" << std::endl;
+	for (size_t i = 0; i < frameTimes.size(); i++) {
+		int bar = slowest > 0.0 ? (int)(50.0 * frameTimes[i] / slowest + 0.5) : 0;
+		std::cout << std::setw(10) << counts[i] << " | " << std::string(bar, '#') << " " << frameTimes[i] << " ms" << std::endl;
+	}
+
+	passTimes.cleanUp();
+	gameEngine::finalizeApplication();
+	context.destroy();
+	return 0;
+}
+
+// worst case views - every named flythrough is flown once at the fixed frame rate of the
+// settings, pass timings of each one are printed and written as JSON
+static int runFlythroughs(const std::string& list) {
+	GameSettings settings = loadSettings(SETTINGS_PATH);
+	std::vector<std::string> names = flythroughRecorder::parseNames(list.empty() ? settings.flythroughs : list);
+	if (names.empty()) {
+		std::cerr << "Error: no flythrough to fly" << std::endl;
+		return 1;
+	}
+	headlessContext context;
+	if (!setupHeadless(context, settings))
+		return 1;
+	double frameTime = 1.0 / std::max(gameSettings.flythroughRate, 1);
+
+	std::ofstream file;
+	std::ostream& out = openReport(gameSettings.flythroughReport, file);
+	writeReportHeader(out, context, frameTime);
+	out << "  \"flythroughs\": {";
+
+	bool first = true;
+	for (size_t i = 0; i < names.size(); i++) {
+		if (!benchCamera.load(flythroughRecorder::getPath(names[i])))
+			continue;
+		// the path starts with the first frame whatever the flythroughs before took
+		benchCameraStart = (float)simulationClock.getSimulationTime();
+		int frames = (int)ceil(benchCamera.getDuration() / frameTime) + 1;
+		drawHeadlessFrames(frames, frameTime);
+		std::cout << "flythrough: " << names[i] << ", " << benchCamera.getDuration() << " s" << std::endl;
+		passTimes.printReport(std::cout);
+
+		out << (first ? "" : ",") << "\n    \"" << names[i] << "\": { \"duration\": " << benchCamera.getDuration()
+			<< ", \"frames\": " << frames << ", \"passes\": ";
+		passTimes.writeJson(out);
+		out << " }";
+		first = false;
+	}
+	out << "\n  }\n}" << std::endl;
+
+	passTimes.cleanUp();
+	gameEngine::finalizeApplication();
+	context.destroy();
+	return 0;
 }
 
 // init application
 int main(int argc, char** argv) {
+	PROFILE_THREAD_NAME("main");
+	frameArena::makeCurrent(&renderArena);
+
+	std::string recordFile, replayFile;
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		// benchmark machines have no display, the headless run draws offscreen and exits
+		if (argument == "--headless")
+			return runHeadless();
+		if (argument == "--startup")
+			return runStartup(i + 1 < argc ? argv[i + 1] : "warm");
+		if (argument == "--sweep")
+			return runSweep();
+		if (argument == "--flythrough")
+			return runFlythroughs(i + 1 < argc ? argv[i + 1] : "");
+		if (argument == "--record" && i + 1 < argc)
+			recordFile = argv[++i];
+		else if (argument == "--replay" && i + 1 < argc)
+			replayFile = argv[++i];
+	}
+
+	// replayed session runs on virtual time with the pass timer on
+	if (!replayFile.empty()) {
+		if (inputLog.startReplay(replayFile))
+			simulationClock.setManual(true);
+	}
+	else if (!recordFile.empty()) {
+		inputLog.startRecording(recordFile, (unsigned int)time(NULL));
+	}
 
 	// initialize windowing system
 	glutInit(&argc, argv);
@@ -815,6 +1691,13 @@ int main(int argc, char** argv) {
 
 
 	gameHandler->initializeApplication();
+	if (inputLog.isReplaying())
+		passTimes.init();
+	// kiosk without a console, statistics are read from the socket
+	if (!gameSettings.metricsSocket.empty() && metrics.start(gameSettings.metricsSocket, gameSettings.metricsInterval)) {
+		if (!passTimes.isEnabled())
+			passTimes.init(false);
+	}
 
 #ifndef __APPLE__
 	glutCloseFunc(gameHandler->finalizeApplication);
@@ -823,6 +1706,7 @@ int main(int argc, char** argv) {
 #endif
 
 	glutMainLoop();
+	inputLog.stop();
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,247 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       metricsServer.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/18
+ * \brief      Frame statistics served as line delimited JSON on a local Unix domain socket
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "metricsServer.h"
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <cstdio>
+#include <cstring>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// render thread: the slot is marked odd, filled, marked even, then the frame is published
+void metricsServer::publish(const FrameMetrics& metrics) {
+	unsigned long long index = published.load(std::memory_order_relaxed);
+	MetricsSlot& slot = ring[index % METRICS_RING_FRAMES];
+	slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.metrics = metrics;
+	slot.sequence.store(2 * index + 2, std::memory_order_release);
+	published.store(index + 1, std::memory_order_release);
+}
+
+// false when the render thread is writing the slot or has already reused it
+bool metricsServer::readFrame(unsigned long long index, FrameMetrics& metrics) {
+	const MetricsSlot& slot = ring[index % METRICS_RING_FRAMES];
+	unsigned long long before = slot.sequence.load(std::memory_order_acquire);
+	if (before != 2 * index + 2)
+		return false;
+	metrics = slot.metrics;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.sequence.load(std::memory_order_relaxed) == before;
+}
+
+// resident memory of the process in kilobytes
+static long long residentMemory() {
+#if defined(__linux__)
+	long long pages = 0, resident = 0;
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm == NULL)
+		return 0;
+	if (fscanf(statm, "%lld %lld", &pages, &resident) != 2)
+		resident = 0;
+	fclose(statm);
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#elif !defined(_WIN32)
+	// peak instead of current, the only portable number
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024;
+#else
+	return 0;
+#endif
+}
+
+// frames published since the last line, frame time percentiles and mean pass times
+std::string metricsServer::summarize(unsigned long long& nextFrame) {
+	unsigned long long end = published.load(std::memory_order_acquire);
+	if (end - nextFrame > (unsigned long long)METRICS_RING_FRAMES)
+		nextFrame = end - METRICS_RING_FRAMES;
+
+	std::vector<double> frameTimes;
+	double cpuSum[PASS_COUNT] = {}, gpuSum[PASS_COUNT] = {};
+	int passFrames[PASS_COUNT] = {};
+	long long allocations = 0, allocatedBytes = 0;
+	FrameMetrics metrics, last;
+	for (; nextFrame < end; nextFrame++) {
+		if (!readFrame(nextFrame, metrics))
+			continue;
+		frameTimes.push_back(metrics.frameTime);
+		allocations += metrics.allocations.allocations;
+		allocatedBytes += metrics.allocations.bytes;
+		for (int pass = 0; pass < PASS_COUNT; pass++) {
+			if (metrics.passCpu[pass] <= 0.0)
+				continue;
+			cpuSum[pass] += metrics.passCpu[pass];
+			gpuSum[pass] += metrics.passGpu[pass];
+			passFrames[pass]++;
+		}
+		last = metrics;
+	}
+	if (frameTimes.empty())
+		return "";
+
+	double total = 0.0;
+	for (size_t i = 0; i < frameTimes.size(); i++)
+		total += frameTimes[i];
+	std::sort(frameTimes.begin(), frameTimes.end());
+	size_t count = frameTimes.size();
+
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(3);
+	line << "{\"frame\":" << last.frame << ",\"frames\":" << count
+		<< ",\"fps\":" << (total > 0.0 ? count * 1000.0 / total : 0.0)
+		<< ",\"frameTime\":{\"p50\":" << frameTimes[count / 2]
+		<< ",\"p95\":" << frameTimes[std::min(count - 1, (size_t)(count * 0.95))]
+		<< ",\"p99\":" << frameTimes[std::min(count - 1, (size_t)(count * 0.99))]
+		<< ",\"max\":" << frameTimes.back() << "},\"passes\":{";
+	bool first = true;
+	for (int pass = 0; pass < PASS_COUNT; pass++) {
+		if (passFrames[pass] == 0)
+			continue;
+		line << (first ? "" : ",") << "\"" << passTimer::getName(pass) << "\":{\"cpu\":" << cpuSum[pass] / passFrames[pass]
+			<< ",\"gpu\":" << gpuSum[pass] / passFrames[pass] << "}";
+		first = false;
+	}
+	line << "},\"drawCalls\":" << last.counters.drawCalls << ",\"triangles\":" << last.counters.triangles
+		<< ",\"memoryKB\":" << residentMemory()
+		<< ",\"textures\":" << last.counters.texturesLoaded
+		<< ",\"textureMB\":" << last.counters.textureBytes / (1024.0 * 1024.0)
+		<< ",\"meshes\":" << last.counters.meshesLoaded
+		<< ",\"allocations\":" << (double)allocations / count << ",\"allocatedBytes\":" << (double)allocatedBytes / count << "}\n";
+	return line.str();
+}
+
+#ifndef _WIN32
+
+bool metricsServer::start(const std::string& socketPath, int intervalMs) {
+	stop();
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(address.sun_path)) {
+		std::cerr << "Error: metrics socket path '" << socketPath << "' is too long" << std::endl;
+		return false;
+	}
+	strcpy(address.sun_path, socketPath.c_str());
+
+	listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenSocket < 0) {
+		std::cerr << "Error: metrics socket cannot be created" << std::endl;
+		return false;
+	}
+	// socket left behind by a crashed run, any other file at the path is kept and bind fails
+	struct stat status;
+	if (lstat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+		unlink(socketPath.c_str());
+	if (bind(listenSocket, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, METRICS_MAX_CLIENTS) != 0) {
+		std::cerr << "Error: metrics socket '" << socketPath << "' cannot be bound" << std::endl;
+		close(listenSocket);
+		return false;
+	}
+	if (lstat(socketPath.c_str(), &status) == 0) {
+		boundDevice = (unsigned long long)status.st_dev;
+		boundInode = (unsigned long long)status.st_ino;
+	}
+
+	this->socketPath = socketPath;
+	this->intervalMs = std::max(intervalMs, 10);
+	running = true;
+	thread = std::thread(&metricsServer::serverLoop, this);
+	std::cout << "Metrics served on " << socketPath << std::endl;
+	return true;
+}
+
+void metricsServer::stop() {
+	if (!running)
+		return;
+	running = false;
+	thread.join();
+	close(listenSocket);
+	// only the socket this server bound, the path may have been replaced since
+	struct stat status;
+	if (lstat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)
+		&& (unsigned long long)status.st_dev == boundDevice && (unsigned long long)status.st_ino == boundInode)
+		unlink(socketPath.c_str());
+}
+
+void metricsServer::serverLoop() {
+	ALLOC_SCOPE("metrics server");
+	std::vector<int> clients;
+	unsigned long long nextFrame = published.load();
+	std::chrono::steady_clock::time_point nextLine = std::chrono::steady_clock::now() + std::chrono::milliseconds(intervalMs);
+
+	while (running) {
+		// new clients are accepted while waiting for the next line
+		int wait = (int)std::chrono::duration_cast<std::chrono::milliseconds>(nextLine - std::chrono::steady_clock::now()).count();
+		pollfd listener = { listenSocket, POLLIN, 0 };
+		if (poll(&listener, 1, std::max(wait, 0)) > 0) {
+			int client = accept(listenSocket, NULL, NULL);
+			if (client >= 0 && (int)clients.size() < METRICS_MAX_CLIENTS) {
+				fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+				clients.push_back(client);
+			}
+			else if (client >= 0) {
+				close(client);
+			}
+		}
+		if (std::chrono::steady_clock::now() < nextLine)
+			continue;
+		nextLine += std::chrono::milliseconds(intervalMs);
+
+		std::string line = summarize(nextFrame);
+		if (line.empty())
+			continue;
+		// a client that cannot take a whole line is dropped, a half line would break its parser
+		for (size_t i = 0; i < clients.size();) {
+			ssize_t sent = send(clients[i], line.data(), line.size(), MSG_NOSIGNAL);
+			if (sent != (ssize_t)line.size()) {
+				close(clients[i]);
+				clients.erase(clients.begin() + i);
+			}
+			else {
+				i++;
+			}
+		}
+	}
+	for (size_t i = 0; i < clients.size(); i++)
+		close(clients[i]);
+}
+
+#else
+
+bool metricsServer::start(const std::string&, int) {
+	std::cerr << "metrics: Unix domain sockets are not supported in the Windows build" << std::endl;
+	return false;
+}
+
+void metricsServer::stop() {
+}
+
+void metricsServer::serverLoop() {
+}
+
+#endif
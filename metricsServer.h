@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       metricsServer.h
+ * \author     rka Prokopov
+ * \date       2025/5/18
+ * \brief      Frame statistics served as line delimited JSON on a local Unix domain socket
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __METRICS_SERVER_H
+#define __METRICS_SERVER_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include "passTimer.h"
+#include "hud.h"
+#include "allocTracker.h"
+
+const int METRICS_RING_FRAMES = 512;   // frames the server can fall behind before they are lost
+const int METRICS_MAX_CLIENTS = 8;
+
+// what the render thread publishes about one frame
+typedef struct FrameMetrics {
+	long long frame;
+	double frameTime;                 // milliseconds
+	double passCpu[PASS_COUNT];
+	double passGpu[PASS_COUNT];
+	RenderCounters counters;
+	AllocCounters allocations;        // zero unless built with ALLOC_TRACKING
+} FrameMetrics;
+
+// slot of the ring, odd sequence while the render thread writes it
+typedef struct MetricsSlot {
+	std::atomic<unsigned long long> sequence;
+	FrameMetrics metrics;
+} MetricsSlot;
+
+/// <summary>
+/// the render thread only copies the frame into a ring slot and bumps two atomics, the server
+/// thread reads new slots, summarizes them and writes one JSON line to every connected client
+/// </summary>
+class metricsServer {
+public:
+	metricsServer() : running(false), boundDevice(0), boundInode(0), published(0) {}
+
+	bool start(const std::string& socketPath, int intervalMs);
+	void stop();
+	bool isRunning() { return running; }
+
+	void publish(const FrameMetrics& metrics);   // render thread, never blocks
+
+private:
+	void serverLoop();
+	bool readFrame(unsigned long long index, FrameMetrics& metrics);
+	std::string summarize(unsigned long long& nextFrame);
+
+	std::atomic<bool> running;
+	std::thread thread;
+	std::string socketPath;
+	int intervalMs;
+	int listenSocket;
+	unsigned long long boundDevice;   // identity of the socket file, stop removes only that one
+	unsigned long long boundInode;
+
+	MetricsSlot ring[METRICS_RING_FRAMES];
+	std::atomic<unsigned long long> published;   // frames written so far
+};
+
+#endif
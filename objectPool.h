@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       objectPool.h
+ * \author     rka Prokopov
+ * \date       2025/5/25
+ * \brief      Fixed pools of game objects with generation checked handles, a restart
+ *				resets the whole pool instead of deleting objects one by one
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __OBJECT_POOL_H
+#define __OBJECT_POOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+const unsigned int POOL_INVALID_SLOT = 0xFFFFFFFF;
+
+// reference to a pooled object, it goes stale when the object is destroyed or the pool reset
+typedef struct PoolHandle {
+	unsigned int slot = POOL_INVALID_SLOT;
+	unsigned int generation = 0;
+} PoolHandle;
+
+/// <summary>
+/// objects of one type in one array allocated by the constructor - slots never move, so
+/// pointers stay valid until the object is destroyed, the lowest free slot is reused first
+/// and iteration walks the array up to the highest slot in use
+/// </summary>
+template <typename T>
+class objectPool {
+public:
+	objectPool(size_t capacity) : objects(capacity), generations(capacity, 0), alive(capacity, false), slotEnd(0) {
+		freeSlots.reserve(capacity);
+		reset();
+	}
+
+	// value initialized object, invalid handle when the pool is full
+	PoolHandle create() {
+		PoolHandle handle;
+		if (freeSlots.empty())
+			return handle;
+		handle.slot = freeSlots.back();
+		handle.generation = generations[handle.slot];
+		freeSlots.pop_back();
+		objects[handle.slot] = T();
+		alive[handle.slot] = true;
+		if (handle.slot >= slotEnd)
+			slotEnd = handle.slot + 1;
+		return handle;
+	}
+
+	// stale handles are ignored
+	void destroy(PoolHandle handle) {
+		if (get(handle) == NULL)
+			return;
+		alive[handle.slot] = false;
+		generations[handle.slot]++;
+		// kept in descending order, create takes the lowest slot from the back
+		freeSlots.insert(std::upper_bound(freeSlots.begin(), freeSlots.end(), handle.slot, std::greater<unsigned int>()), handle.slot);
+	}
+
+	// NULL when the object of the handle is gone
+	T* get(PoolHandle handle) {
+		if (handle.slot >= objects.size() || !alive[handle.slot] || generations[handle.slot] != handle.generation)
+			return NULL;
+		return &objects[handle.slot];
+	}
+
+	// every object is destroyed at once, all handles go stale, nothing is freed
+	void reset() {
+		for (size_t slot = 0; slot < slotEnd; slot++) {
+			if (alive[slot])
+				generations[slot]++;
+			alive[slot] = false;
+		}
+		freeSlots.clear();
+		for (size_t slot = objects.size(); slot > 0; slot--)
+			freeSlots.push_back((unsigned int)slot - 1);
+		slotEnd = 0;
+	}
+
+	size_t getCapacity() const { return objects.size(); }
+	size_t getCount() const { return objects.size() - freeSlots.size(); }
+
+	// for (size_t slot = 0; slot < pool.getSlotEnd(); slot++) if (pool.isAlive(slot)) ...
+	size_t getSlotEnd() const { return slotEnd; }
+	bool isAlive(size_t slot) const { return alive[slot]; }
+	T& operator[](size_t slot) { return objects[slot]; }
+	PoolHandle getHandle(size_t slot) const {
+		PoolHandle handle;
+		handle.slot = (unsigned int)slot;
+		handle.generation = generations[slot];
+		return handle;
+	}
+
+private:
+	std::vector<T> objects;
+	std::vector<unsigned int> generations;
+	std::vector<bool> alive;
+	std::vector<unsigned int> freeSlots;   // lowest slot at the back
+	size_t slotEnd;
+};
+
+#endif
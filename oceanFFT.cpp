@@ -0,0 +1,402 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       oceanFFT.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/2
+ * \brief      Phillips spectrum evaluated every step and inverse 2D FFT (rows, then columns)
+ *				split between worker threads. Butterflies use SSE when it is available.
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "oceanFFT.h"
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCEAN_SIMD 1
+#endif
+
+const float OCEAN_GRAVITY = 9.81f;
+const float OCEAN_WIND_SPEED = 4.0f;
+const float OCEAN_PI = 3.14159265f;
+
+oceanSimulator::oceanSimulator()
+	: resolution(0), patchSize(1.0f), choppiness(0.0f), threadCount(0), stepGeneration(0), stepTime(0.0f),
+	quit(false), barrierCount(0), barrierGeneration(0), finishedWorkers(0) {
+}
+
+oceanSimulator::~oceanSimulator() {
+	shutdown();
+}
+
+// stop and join workers
+void oceanSimulator::shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	startCondition.notify_all();
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+	workers.clear();
+	threadCount = 0;
+}
+
+void oceanSimulator::init(int newResolution, float newPatchSize, float amplitude, float newChoppiness, int threads) {
+	shutdown();
+
+	// power of two inside supported range
+	int size = OCEAN_MIN_RESOLUTION;
+	while (size * 2 <= newResolution && size * 2 <= OCEAN_MAX_RESOLUTION)
+		size *= 2;
+	if (size != newResolution)
+		std::cerr << "oceanSimulator: resolution " << newResolution << " changed to " << size << std::endl;
+
+	resolution = size;
+	patchSize = newPatchSize;
+	choppiness = newChoppiness;
+
+	const int n = resolution;
+	height.re.assign(n * n, 0.0f);
+	height.im.assign(n * n, 0.0f);
+	displaceX = height;
+	displaceY = height;
+	displacement.assign(4 * n * n, 0.0f);
+	normals.assign(4 * n * n, 0);
+
+	// bit reversal and twiddles, stage with half size h keeps its twiddles at [h, 2h)
+	int bits = 0;
+	while ((1 << bits) < n)
+		bits++;
+	bitReverse.resize(n);
+	for (int i = 0; i < n; i++) {
+		int reversed = 0;
+		for (int b = 0; b < bits; b++) {
+			if (i & (1 << b))
+				reversed |= 1 << (bits - 1 - b);
+		}
+		bitReverse[i] = reversed;
+	}
+	twiddleRe.assign(n, 0.0f);
+	twiddleIm.assign(n, 0.0f);
+	for (int half = 1; half < n; half *= 2) {
+		for (int k = 0; k < half; k++) {
+			float angle = OCEAN_PI * k / half; // positive sign - inverse transform
+			twiddleRe[half + k] = cos(angle);
+			twiddleIm[half + k] = sin(angle);
+		}
+	}
+
+	initSpectrum(amplitude);
+
+	if (threads <= 0)
+		threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	threads = std::min(threads, n / 4);
+
+	quit = false;
+	barrierCount = 0;
+	threadCount = threads;
+	finishedWorkers = threads;
+	for (int i = 0; i < threads; i++) {
+		workers.push_back(std::thread(&oceanSimulator::workerLoop, this, i, stepGeneration));
+	}
+}
+
+// initial amplitudes from Phillips spectrum, scaled so average wave height equals amplitude
+void oceanSimulator::initSpectrum(float amplitude) {
+	const int n = resolution;
+	h0Re.assign(n * n, 0.0f);
+	h0Im.assign(n * n, 0.0f);
+	omega.assign(n * n, 0.0f);
+	kxNorm.assign(n * n, 0.0f);
+	kyNorm.assign(n * n, 0.0f);
+
+	std::mt19937 generator(1337); // same waves after every start
+	std::normal_distribution<float> gauss(0.0f, 1.0f);
+
+	float windX = 1.0f, windY = 0.4f;
+	float windLength = sqrt(windX * windX + windY * windY);
+	windX /= windLength;
+	windY /= windLength;
+
+	const float largestWave = OCEAN_WIND_SPEED * OCEAN_WIND_SPEED / OCEAN_GRAVITY;
+	const float smallestWave = largestWave * 0.001f;
+	double total = 0.0;
+
+	for (int row = 0; row < n; row++) {
+		int ny = row < n / 2 ? row : row - n;
+		for (int col = 0; col < n; col++) {
+			int nx = col < n / 2 ? col : col - n;
+			int idx = row * n + col;
+
+			float kx = 2.0f * OCEAN_PI * nx / patchSize;
+			float ky = 2.0f * OCEAN_PI * ny / patchSize;
+			float k = sqrt(kx * kx + ky * ky);
+			float r1 = gauss(generator);
+			float r2 = gauss(generator);
+			if (k < 1e-6f)
+				continue;
+
+			float kDotWind = (kx * windX + ky * windY) / k;
+			float phillips = exp(-1.0f / (k * largestWave * k * largestWave)) / (k * k * k * k)
+				* kDotWind * kDotWind * exp(-k * k * smallestWave * smallestWave);
+			float scale = sqrt(phillips * 0.5f);
+
+			h0Re[idx] = r1 * scale;
+			h0Im[idx] = r2 * scale;
+			omega[idx] = sqrt(OCEAN_GRAVITY * k);
+			kxNorm[idx] = kx / k;
+			kyNorm[idx] = ky / k;
+			total += h0Re[idx] * h0Re[idx] + h0Im[idx] * h0Im[idx];
+		}
+	}
+
+	float normalize = total > 0.0 ? amplitude / (float)sqrt(2.0 * total) : 0.0f;
+	for (int i = 0; i < n * n; i++) {
+		h0Re[i] *= normalize;
+		h0Im[i] *= normalize;
+	}
+}
+
+void oceanSimulator::kick(float time) {
+	if (!finished())
+		return; // previous step still running
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stepTime = time;
+		finishedWorkers = 0;
+		stepGeneration++;
+	}
+	startCondition.notify_all();
+}
+
+bool oceanSimulator::finished() {
+	return finishedWorkers == threadCount;
+}
+
+void oceanSimulator::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [this] { return finishedWorkers == threadCount; });
+}
+
+void oceanSimulator::barrier() {
+	std::unique_lock<std::mutex> lock(mutex);
+	int generation = barrierGeneration;
+	if (++barrierCount == threadCount) {
+		barrierCount = 0;
+		barrierGeneration++;
+		barrierCondition.notify_all();
+	}
+	else {
+		barrierCondition.wait(lock, [&] { return generation != barrierGeneration; });
+	}
+}
+
+// each worker owns a band of rows and a band of columns
+void oceanSimulator::workerLoop(int index, int generation) {
+	const int n = resolution;
+	int rowBegin = index * n / threadCount;
+	int rowEnd = (index + 1) * n / threadCount;
+	int columnChunk = ((n / threadCount + 3) / 4) * 4;
+	int columnBegin = std::min(index * columnChunk, n);
+	int columnEnd = index == threadCount - 1 ? n : std::min(columnBegin + columnChunk, n);
+
+	int seenGeneration = generation; // generation at spawn, a kick may come before the thread runs
+	while (true) {
+		float time;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(lock, [&] { return quit || stepGeneration != seenGeneration; });
+			if (quit)
+				return;
+			seenGeneration = stepGeneration;
+			time = stepTime;
+		}
+
+		evaluateSpectrumRows(rowBegin, rowEnd, time);
+		fftRows(height, rowBegin, rowEnd);
+		fftRows(displaceX, rowBegin, rowEnd);
+		fftRows(displaceY, rowBegin, rowEnd);
+		barrier();
+
+		fftColumns(height, columnBegin, columnEnd);
+		fftColumns(displaceX, columnBegin, columnEnd);
+		fftColumns(displaceY, columnBegin, columnEnd);
+		barrier();
+
+		writeOutputRows(rowBegin, rowEnd);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (++finishedWorkers == threadCount)
+			doneCondition.notify_all();
+	}
+}
+
+// h(k, t) = h0(k) e^(i w t) + conj(h0(-k)) e^(-i w t), horizontal displacement is -i k/|k| h
+void oceanSimulator::evaluateSpectrumRows(int rowBegin, int rowEnd, float time) {
+	const int n = resolution;
+	for (int row = rowBegin; row < rowEnd; row++) {
+		int rowMinus = (n - row) % n;
+		for (int col = 0; col < n; col++) {
+			int idx = row * n + col;
+			int idxMinus = rowMinus * n + (n - col) % n;
+
+			float c = cos(omega[idx] * time);
+			float s = sin(omega[idx] * time);
+
+			float re = h0Re[idx] * c - h0Im[idx] * s + h0Re[idxMinus] * c - h0Im[idxMinus] * s;
+			float im = h0Re[idx] * s + h0Im[idx] * c - h0Re[idxMinus] * s - h0Im[idxMinus] * c;
+
+			height.re[idx] = re;
+			height.im[idx] = im;
+			displaceX.re[idx] = kxNorm[idx] * im;
+			displaceX.im[idx] = -kxNorm[idx] * re;
+			displaceY.re[idx] = kyNorm[idx] * im;
+			displaceY.im[idx] = -kyNorm[idx] * re;
+		}
+	}
+}
+
+// radix-2 inverse FFT of each row, one stage is vectorized along the row
+void oceanSimulator::fftRows(oceanField& field, int rowBegin, int rowEnd) {
+	const int n = resolution;
+	for (int row = rowBegin; row < rowEnd; row++) {
+		float* re = &field.re[row * n];
+		float* im = &field.im[row * n];
+
+		for (int i = 0; i < n; i++) {
+			int j = bitReverse[i];
+			if (i < j) {
+				std::swap(re[i], re[j]);
+				std::swap(im[i], im[j]);
+			}
+		}
+
+		for (int half = 1; half < n; half *= 2) {
+			const float* wRe = &twiddleRe[half];
+			const float* wIm = &twiddleIm[half];
+			for (int start = 0; start < n; start += 2 * half) {
+				float* aRe = re + start;
+				float* aIm = im + start;
+				float* bRe = aRe + half;
+				float* bIm = aIm + half;
+				int k = 0;
+#ifdef OCEAN_SIMD
+				for (; k + 4 <= half; k += 4) {
+					__m128 wr = _mm_loadu_ps(wRe + k);
+					__m128 wi = _mm_loadu_ps(wIm + k);
+					__m128 br = _mm_loadu_ps(bRe + k);
+					__m128 bi = _mm_loadu_ps(bIm + k);
+					__m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+					__m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+					__m128 ar = _mm_loadu_ps(aRe + k);
+					__m128 ai = _mm_loadu_ps(aIm + k);
+					_mm_storeu_ps(aRe + k, _mm_add_ps(ar, tr));
+					_mm_storeu_ps(aIm + k, _mm_add_ps(ai, ti));
+					_mm_storeu_ps(bRe + k, _mm_sub_ps(ar, tr));
+					_mm_storeu_ps(bIm + k, _mm_sub_ps(ai, ti));
+				}
+#endif
+				for (; k < half; k++) {
+					float tr = bRe[k] * wRe[k] - bIm[k] * wIm[k];
+					float ti = bRe[k] * wIm[k] + bIm[k] * wRe[k];
+					bRe[k] = aRe[k] - tr;
+					bIm[k] = aIm[k] - ti;
+					aRe[k] += tr;
+					aIm[k] += ti;
+				}
+			}
+		}
+	}
+}
+
+// inverse FFT of columns, butterflies are vectorized across neighbouring columns so loads stay contiguous
+void oceanSimulator::fftColumns(oceanField& field, int columnBegin, int columnEnd) {
+	const int n = resolution;
+	float* re = field.re.data();
+	float* im = field.im.data();
+
+	for (int i = 0; i < n; i++) {
+		int j = bitReverse[i];
+		if (i < j) {
+			for (int c = columnBegin; c < columnEnd; c++) {
+				std::swap(re[i * n + c], re[j * n + c]);
+				std::swap(im[i * n + c], im[j * n + c]);
+			}
+		}
+	}
+
+	for (int half = 1; half < n; half *= 2) {
+		for (int start = 0; start < n; start += 2 * half) {
+			for (int k = 0; k < half; k++) {
+				float wr = twiddleRe[half + k];
+				float wi = twiddleIm[half + k];
+				float* aRe = re + (start + k) * n;
+				float* aIm = im + (start + k) * n;
+				float* bRe = aRe + half * n;
+				float* bIm = aIm + half * n;
+				int c = columnBegin;
+#ifdef OCEAN_SIMD
+				__m128 wr4 = _mm_set1_ps(wr);
+				__m128 wi4 = _mm_set1_ps(wi);
+				for (; c + 4 <= columnEnd; c += 4) {
+					__m128 br = _mm_loadu_ps(bRe + c);
+					__m128 bi = _mm_loadu_ps(bIm + c);
+					__m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr4), _mm_mul_ps(bi, wi4));
+					__m128 ti = _mm_add_ps(_mm_mul_ps(br, wi4), _mm_mul_ps(bi, wr4));
+					__m128 ar = _mm_loadu_ps(aRe + c);
+					__m128 ai = _mm_loadu_ps(aIm + c);
+					_mm_storeu_ps(aRe + c, _mm_add_ps(ar, tr));
+					_mm_storeu_ps(aIm + c, _mm_add_ps(ai, ti));
+					_mm_storeu_ps(bRe + c, _mm_sub_ps(ar, tr));
+					_mm_storeu_ps(bIm + c, _mm_sub_ps(ai, ti));
+				}
+#endif
+				for (; c < columnEnd; c++) {
+					float tr = bRe[c] * wr - bIm[c] * wi;
+					float ti = bRe[c] * wi + bIm[c] * wr;
+					bRe[c] = aRe[c] - tr;
+					bIm[c] = aIm[c] - ti;
+					aRe[c] += tr;
+					aIm[c] += ti;
+				}
+			}
+		}
+	}
+}
+
+// displacement (dx, dy, height) and normals from central differences of the height
+void oceanSimulator::writeOutputRows(int rowBegin, int rowEnd) {
+	const int n = resolution;
+	const float cellSize = patchSize / n;
+	const float* h = height.re.data();
+
+	for (int row = rowBegin; row < rowEnd; row++) {
+		int up = ((row + 1) % n) * n;
+		int down = ((row - 1 + n) % n) * n;
+		for (int col = 0; col < n; col++) {
+			int idx = row * n + col;
+			int right = row * n + (col + 1) % n;
+			int left = row * n + (col - 1 + n) % n;
+
+			displacement[4 * idx + 0] = choppiness * displaceX.re[idx];
+			displacement[4 * idx + 1] = choppiness * displaceY.re[idx];
+			displacement[4 * idx + 2] = h[idx];
+			displacement[4 * idx + 3] = 0.0f;
+
+			float dx = (h[right] - h[left]) / (2.0f * cellSize);
+			float dy = (h[up + col] - h[down + col]) / (2.0f * cellSize);
+			float length = sqrt(dx * dx + dy * dy + 1.0f);
+
+			normals[4 * idx + 0] = (unsigned char)((-dx / length * 0.5f + 0.5f) * 255.0f);
+			normals[4 * idx + 1] = (unsigned char)((-dy / length * 0.5f + 0.5f) * 255.0f);
+			normals[4 * idx + 2] = (unsigned char)((1.0f / length * 0.5f + 0.5f) * 255.0f);
+			normals[4 * idx + 3] = 255;
+		}
+	}
+}
@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       oceanFFT.h
+ * \author     rka Prokopov
+ * \date       2025/5/2
+ * \brief      Tessendorf FFT waves computed on worker threads
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __OCEAN_FFT_H
+#define __OCEAN_FFT_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+const int OCEAN_MIN_RESOLUTION = 64;
+const int OCEAN_MAX_RESOLUTION = 512;
+
+/// <summary>
+/// complex field stored as separate real and imaginary planes so butterflies can use SIMD
+/// </summary>
+struct oceanField {
+	std::vector<float> re;
+	std::vector<float> im;
+};
+
+/// <summary>
+/// ocean spectrum simulation - every step evaluates spectrum for given time and runs
+/// inverse FFT, result is displacement map (dx, dy, height) and normal map
+/// </summary>
+class oceanSimulator {
+public:
+	oceanSimulator();
+	~oceanSimulator();
+
+	void init(int resolution, float patchSize, float amplitude, float choppiness, int threads);
+	void shutdown();
+
+	void kick(float time);   // start one step on workers, returns immediately
+	bool finished();         // last step is done and results can be read
+	void wait();             // block until last step is done
+	void simulate(float time) { kick(time); wait(); }
+
+	const float* getDisplacement() { return displacement.data(); }          // RGBA float per texel
+	const unsigned char* getNormals() { return normals.data(); }            // RGBA byte per texel
+	int getResolution() { return resolution; }
+	float getPatchSize() { return patchSize; }
+	int getThreadCount() { return threadCount; }
+
+private:
+	void initSpectrum(float amplitude);
+	void workerLoop(int index, int generation);
+	void barrier();
+
+	void evaluateSpectrumRows(int rowBegin, int rowEnd, float time);
+	void fftRows(oceanField& field, int rowBegin, int rowEnd);
+	void fftColumns(oceanField& field, int columnBegin, int columnEnd);
+	void writeOutputRows(int rowBegin, int rowEnd);
+
+	int resolution;
+	float patchSize;
+	float choppiness;
+	int threadCount;
+
+	// initial spectrum and dispersion
+	std::vector<float> h0Re;
+	std::vector<float> h0Im;
+	std::vector<float> omega;
+	std::vector<float> kxNorm;   // kx / |k|
+	std::vector<float> kyNorm;   // ky / |k|
+
+	// FFT tables
+	std::vector<int> bitReverse;
+	std::vector<float> twiddleRe;
+	std::vector<float> twiddleIm;
+
+	oceanField height;
+	oceanField displaceX;
+	oceanField displaceY;
+
+	std::vector<float> displacement;
+	std::vector<unsigned char> normals;
+
+	// workers
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable startCondition;
+	std::condition_variable doneCondition;
+	std::condition_variable barrierCondition;
+	int stepGeneration;
+	float stepTime;
+	bool quit;
+	int barrierCount;
+	int barrierGeneration;
+	std::atomic<int> finishedWorkers;
+};
+
+#endif
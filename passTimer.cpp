@@ -0,0 +1,186 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       passTimer.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/13
+ * \brief      CPU and GPU time of every render pass, for the headless benchmark
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "passTimer.h"
+#include <algorithm>
+#include <iomanip>
+#include "glCounters.h"
+
+// passes without GL work, or containing other passes, have no GPU query
+static bool hasQuery(int pass) {
+	return pass != PASS_SIMULATION && pass != PASS_FRAME;
+}
+
+const char* passTimer::getName(int pass) {
+	static const char* names[PASS_COUNT] = {
+		"simulation", "update", "water layers", "reflection", "refraction", "main", "hud", "frame"
+	};
+	return names[pass];
+}
+
+// samples of the expected frames are reserved so that timed frames do not allocate
+void passTimer::init(bool keepSamples, int frames) {
+	cleanUp();
+	this->keepSamples = keepSamples;
+	glGenQueries(PASS_TIMER_LATENCY * PASS_COUNT, &queries[0][0]);
+	for (int slot = 0; slot < PASS_TIMER_LATENCY; slot++)
+		for (int pass = 0; pass < PASS_COUNT; pass++)
+			issued[slot][pass] = false;
+	for (int pass = 0; pass < PASS_COUNT; pass++) {
+		cpuTimes[pass].clear();
+		gpuTimes[pass].clear();
+		if (keepSamples) {
+			cpuTimes[pass].reserve(frames);
+			gpuTimes[pass].reserve(frames);
+		}
+		ran[pass] = false;
+		lastCpu[pass] = lastGpu[pass] = 0.0;
+	}
+	origin = std::chrono::steady_clock::now();
+	frame = 0;
+	enabled = true;
+}
+
+void passTimer::begin(int pass) {
+	GL_COUNT_PASS(pass);
+	if (!enabled)
+		return;
+	cpuStart[pass] = now();
+	ran[pass] = true;
+	if (hasQuery(pass))
+		glBeginQuery(GL_TIME_ELAPSED, queries[frame % PASS_TIMER_LATENCY][pass]);
+}
+
+void passTimer::end(int pass) {
+	GL_COUNT_PASS(PASS_FRAME);
+	if (!enabled)
+		return;
+	if (hasQuery(pass)) {
+		glEndQuery(GL_TIME_ELAPSED);
+		issued[frame % PASS_TIMER_LATENCY][pass] = true;
+	}
+	lastCpu[pass] = now() - cpuStart[pass];
+	if (keepSamples)
+		cpuTimes[pass].push_back(lastCpu[pass]);
+}
+
+void passTimer::addCpu(int pass, double milliseconds) {
+	if (!enabled)
+		return;
+	ran[pass] = true;
+	lastCpu[pass] = milliseconds;
+	if (keepSamples)
+		cpuTimes[pass].push_back(milliseconds);
+}
+
+// the slot used next was issued PASS_TIMER_LATENCY frames ago, its results are ready by now
+void passTimer::endFrame() {
+	if (!enabled)
+		return;
+	for (int pass = 0; pass < PASS_COUNT; pass++) {
+		if (!ran[pass])
+			lastCpu[pass] = 0.0;
+		ran[pass] = false;
+	}
+	frame++;
+	collect(frame % PASS_TIMER_LATENCY);
+}
+
+void passTimer::finish() {
+	if (!enabled)
+		return;
+	glFinish();
+	for (int slot = 0; slot < PASS_TIMER_LATENCY; slot++)
+		collect(slot);
+}
+
+void passTimer::collect(int slot) {
+	for (int pass = 0; pass < PASS_COUNT; pass++) {
+		if (!issued[slot][pass]) {
+			if (hasQuery(pass))
+				lastGpu[pass] = 0.0;
+			continue;
+		}
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[slot][pass], GL_QUERY_RESULT, &nanoseconds);
+		lastGpu[pass] = nanoseconds / 1000000.0;
+		if (keepSamples)
+			gpuTimes[pass].push_back(lastGpu[pass]);
+		issued[slot][pass] = false;
+	}
+}
+
+void passTimer::cleanUp() {
+	if (enabled)
+		glDeleteQueries(PASS_TIMER_LATENCY * PASS_COUNT, &queries[0][0]);
+	enabled = false;
+}
+
+double passTimer::now() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// mean, median and 95th percentile of the samples
+static void summarize(std::vector<double> samples, double& mean, double& median, double& p95) {
+	mean = median = p95 = 0.0;
+	if (samples.empty())
+		return;
+	std::sort(samples.begin(), samples.end());
+	for (size_t i = 0; i < samples.size(); i++)
+		mean += samples[i];
+	mean /= samples.size();
+	median = samples[samples.size() / 2];
+	p95 = samples[std::min(samples.size() - 1, (size_t)(samples.size() * 0.95))];
+}
+
+double passTimer::getMedian(int pass, bool gpu) {
+	double mean, median, p95;
+	summarize(gpu ? gpuTimes[pass] : cpuTimes[pass], mean, median, p95);
+	return median;
+}
+
+void passTimer::printReport(std::ostream& out) {
+	out << std::fixed << std::setprecision(3);
+	out << "Pass timings over " << frame << " frames, mean / median / p95 in ms:" << std::endl;
+	for (int pass = 0; pass < PASS_COUNT; pass++) {
+		if (cpuTimes[pass].empty())
+			continue;
+		double mean, median, p95;
+		summarize(cpuTimes[pass], mean, median, p95);
+		out << "  " << std::setw(14) << std::left << getName(pass) << std::right
+			<< " cpu " << mean << " / " << median << " / " << p95;
+		if (!gpuTimes[pass].empty()) {
+			summarize(gpuTimes[pass], mean, median, p95);
+			out << "   gpu " << mean << " / " << median << " / " << p95;
+		}
+		out << "   (" << cpuTimes[pass].size() << " frames)" << std::endl;
+	}
+}
+
+// one object per pass, times in milliseconds
+void passTimer::writeJson(std::ostream& out) {
+	out << std::fixed << std::setprecision(4);
+	out << "{";
+	bool first = true;
+	for (int pass = 0; pass < PASS_COUNT; pass++) {
+		if (cpuTimes[pass].empty())
+			continue;
+		double mean, median, p95;
+		out << (first ? "" : ",") << "\n    \"" << getName(pass) << "\": { \"frames\": " << cpuTimes[pass].size();
+		summarize(cpuTimes[pass], mean, median, p95);
+		out << ", \"cpuMean\": " << mean << ", \"cpuMedian\": " << median << ", \"cpuP95\": " << p95;
+		if (!gpuTimes[pass].empty()) {
+			summarize(gpuTimes[pass], mean, median, p95);
+			out << ", \"gpuMean\": " << mean << ", \"gpuMedian\": " << median << ", \"gpuP95\": " << p95;
+		}
+		out << " }";
+		first = false;
+	}
+	out << "\n  }";
+}
@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       passTimer.h
+ * \author     rka Prokopov
+ * \date       2025/5/13
+ * \brief      CPU and GPU time of every render pass, for the headless benchmark
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __PASS_TIMER_H
+#define __PASS_TIMER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ostream>
+#include "pgr.h"
+
+// measured parts of a frame
+enum {
+	PASS_SIMULATION,      // fixed steps before the frame, CPU only
+	PASS_UPDATE,          // ocean, ripples, probe and the draw list
+	PASS_WATER_LAYERS,    // reflection and refraction in one layered pass
+	PASS_REFLECTION,
+	PASS_REFRACTION,
+	PASS_MAIN,
+	PASS_HUD,             // speed bar and performance overlay
+	PASS_FRAME,           // whole frame on the CPU
+	PASS_COUNT
+};
+
+const int PASS_TIMER_LATENCY = 4;   // frames of GPU queries in flight before they are read
+
+/// <summary>
+/// wall time of each pass on the CPU and GL_TIME_ELAPSED queries on the GPU, query
+/// results are read a few frames later so the timer never stalls the pipeline
+/// </summary>
+class passTimer {
+public:
+	passTimer() : enabled(false), keepSamples(true), frame(0) {}
+
+	void init(bool keepSamples = true, int frames = 0);   // without samples only the last frame is kept, for the HUD
+	void begin(int pass);
+	void end(int pass);
+	void addCpu(int pass, double milliseconds);   // pass timed by another thread, no GPU query
+	void endFrame();
+	void finish();        // waits for queries still in flight
+	void cleanUp();
+
+	bool isEnabled() { return enabled; }
+	double getLastCpu(int pass) { return lastCpu[pass]; }   // 0 when the pass did not run
+	double getLastGpu(int pass) { return lastGpu[pass]; }   // PASS_TIMER_LATENCY frames old
+	double getMedian(int pass, bool gpu);                    // over the kept samples, 0 without them
+	void printReport(std::ostream& out);
+	void writeJson(std::ostream& out);
+
+	static const char* getName(int pass);
+
+private:
+	void collect(int slot);
+	double now();
+
+	bool enabled;
+	bool keepSamples;
+	long long frame;
+	std::chrono::steady_clock::time_point origin;
+
+	GLuint queries[PASS_TIMER_LATENCY][PASS_COUNT];
+	bool issued[PASS_TIMER_LATENCY][PASS_COUNT];
+	double cpuStart[PASS_COUNT];
+	bool ran[PASS_COUNT];
+	double lastCpu[PASS_COUNT];
+	double lastGpu[PASS_COUNT];
+
+	std::vector<double> cpuTimes[PASS_COUNT];   // milliseconds of every frame the pass ran
+	std::vector<double> gpuTimes[PASS_COUNT];
+};
+
+#endif
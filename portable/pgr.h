@@ -0,0 +1,25 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       pgr.h
+ * \author     rka Prokopov
+ * \date       2025/5/19
+ * \brief      Stand-in for the pgr framework header in the CMake build of the core -
+ *				glm and the GL scalar types only, the core sources make no GL calls
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __PORTABLE_PGR_H
+#define __PORTABLE_PGR_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+
+#endif
@@ -0,0 +1,231 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       profiler.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/15
+ * \brief      Scoped CPU and GPU zones written as a Chrome / Perfetto trace
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "profiler.h"
+
+#ifdef TRACE_PROFILER
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+
+// one finished zone, times in microseconds since the profiler started
+typedef struct TraceEvent {
+	const char* name;
+	char detail[PROFILER_DETAIL_LENGTH];
+	double start;
+	double duration;
+} TraceEvent;
+
+// zones of one thread, only that thread writes into it
+typedef struct TraceRing {
+	std::string threadName;
+	int threadID;
+	std::vector<TraceEvent> events;
+	long long written;
+} TraceRing;
+
+// GPU zone waiting for its timestamps
+typedef struct GpuZone {
+	const char* name;
+	GLuint queries[2];
+} GpuZone;
+
+static const int GPU_THREAD_ID = 0;   // GPU track of the trace
+
+static std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+static std::mutex ringsMutex;
+static std::vector<std::unique_ptr<TraceRing>> rings;   // rings outlive their threads
+static thread_local TraceRing* threadRing = NULL;
+
+static bool gpuReady = false;
+static long long gpuFrame = 0;
+static double gpuOffset = 0.0;   // CPU time minus GPU time, microseconds
+static GpuZone gpuZones[PROFILER_GPU_LATENCY][PROFILER_GPU_ZONES];
+static int gpuZoneCount[PROFILER_GPU_LATENCY];
+static TraceRing gpuRing;
+
+static double now() {
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin).count();
+}
+
+static void pushEvent(TraceRing* ring, const char* name, const char* detail, double start, double duration) {
+	TraceEvent& event = ring->events[ring->written % PROFILER_RING_SIZE];
+	event.name = name;
+	event.detail[0] = '\0';
+	if (detail != NULL) {
+		strncpy(event.detail, detail, PROFILER_DETAIL_LENGTH - 1);
+		event.detail[PROFILER_DETAIL_LENGTH - 1] = '\0';
+	}
+	event.start = start;
+	event.duration = duration;
+	ring->written++;
+}
+
+// ring of the calling thread, created on its first zone
+static TraceRing* getThreadRing() {
+	if (threadRing == NULL) {
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		rings.push_back(std::unique_ptr<TraceRing>(new TraceRing()));
+		threadRing = rings.back().get();
+		threadRing->threadID = (int)rings.size();
+		threadRing->threadName = "thread " + std::to_string(threadRing->threadID);
+		threadRing->events.resize(PROFILER_RING_SIZE);
+		threadRing->written = 0;
+	}
+	return threadRing;
+}
+
+profileZone::profileZone(const char* name, const char* detail) : name(name), detail(detail) {
+	start = now();
+}
+
+profileZone::~profileZone() {
+	double end = now();
+	pushEvent(getThreadRing(), name, detail, start, end - start);
+}
+
+profileGpuZone::profileGpuZone(const char* name) : cpuZone(name), index(-1) {
+	if (!gpuReady)
+		return;
+	int slot = (int)(gpuFrame % PROFILER_GPU_LATENCY);
+	if (gpuZoneCount[slot] >= PROFILER_GPU_ZONES)
+		return;
+	index = gpuZoneCount[slot]++;
+	gpuZones[slot][index].name = name;
+	glQueryCounter(gpuZones[slot][index].queries[0], GL_TIMESTAMP);
+}
+
+profileGpuZone::~profileGpuZone() {
+	if (index < 0)
+		return;
+	int slot = (int)(gpuFrame % PROFILER_GPU_LATENCY);
+	glQueryCounter(gpuZones[slot][index].queries[1], GL_TIMESTAMP);
+}
+
+void profiler::setThreadName(const char* name) {
+	TraceRing* ring = getThreadRing();
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	ring->threadName = name;
+}
+
+void profiler::initGpu() {
+	if (gpuReady)
+		return;
+	for (int slot = 0; slot < PROFILER_GPU_LATENCY; slot++) {
+		for (int i = 0; i < PROFILER_GPU_ZONES; i++)
+			glGenQueries(2, gpuZones[slot][i].queries);
+		gpuZoneCount[slot] = 0;
+	}
+	// GPU clock has its own origin, one sample maps it onto the CPU timeline
+	GLint64 gpuTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	gpuOffset = now() - gpuTime / 1000.0;
+
+	gpuRing.threadName = "GPU";
+	gpuRing.threadID = GPU_THREAD_ID;
+	gpuRing.events.resize(PROFILER_RING_SIZE);
+	gpuRing.written = 0;
+	gpuFrame = 0;
+	gpuReady = true;
+}
+
+// timestamps of the slot are read back into the GPU ring and the slot is free again
+static void collectSlot(int slot) {
+	for (int i = 0; i < gpuZoneCount[slot]; i++) {
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(gpuZones[slot][i].queries[0], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(gpuZones[slot][i].queries[1], GL_QUERY_RESULT, &end);
+		pushEvent(&gpuRing, gpuZones[slot][i].name, NULL, begin / 1000.0 + gpuOffset, (end - begin) / 1000.0);
+	}
+	gpuZoneCount[slot] = 0;
+}
+
+void profiler::endFrame() {
+	if (!gpuReady)
+		return;
+	gpuFrame++;
+	collectSlot((int)(gpuFrame % PROFILER_GPU_LATENCY));
+}
+
+void profiler::cleanUpGpu() {
+	if (!gpuReady)
+		return;
+	for (int slot = 0; slot < PROFILER_GPU_LATENCY; slot++)
+		for (int i = 0; i < PROFILER_GPU_ZONES; i++)
+			glDeleteQueries(2, gpuZones[slot][i].queries);
+	gpuReady = false;
+}
+
+// names are string literals, only details come from data and need escaping
+static void writeEscaped(std::ostream& out, const char* text) {
+	for (; *text != '\0'; text++) {
+		if (*text == '"' || *text == '\\')
+			out << '\\';
+		out << *text;
+	}
+}
+
+static void writeRing(std::ostream& out, const TraceRing& ring, bool& first) {
+	out << (first ? "" : ",\n") << "  { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << ring.threadID
+		<< ", \"args\": { \"name\": \"";
+	writeEscaped(out, ring.threadName.c_str());
+	out << "\" } }";
+	first = false;
+
+	long long count = std::min(ring.written, (long long)PROFILER_RING_SIZE);
+	for (long long i = ring.written - count; i < ring.written; i++) {
+		const TraceEvent& event = ring.events[i % PROFILER_RING_SIZE];
+		out << ",\n  { \"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << ring.threadID
+			<< ", \"ts\": " << event.start << ", \"dur\": " << event.duration;
+		if (event.detail[0] != '\0') {
+			out << ", \"args\": { \"detail\": \"";
+			writeEscaped(out, event.detail);
+			out << "\" }";
+		}
+		out << " }";
+	}
+}
+
+// Chrome trace event format, opens in chrome://tracing and ui.perfetto.dev,
+// other threads should be idle while the rings are read
+bool profiler::writeTrace(const std::string& fileName) {
+	if (gpuReady) {
+		glFinish();
+		for (int slot = 0; slot < PROFILER_GPU_LATENCY; slot++)
+			collectSlot(slot);
+	}
+
+	std::ofstream file(fileName);
+	if (!file.is_open()) {
+		std::cerr << "Error: trace '" << fileName << "' cannot be written" << std::endl;
+		return false;
+	}
+	file << std::fixed << std::setprecision(3);
+	file << "{ \"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	bool first = true;
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		for (size_t i = 0; i < rings.size(); i++)
+			writeRing(file, *rings[i], first);
+	}
+	if (gpuRing.written > 0)
+		writeRing(file, gpuRing, first);
+	file << "\n] }" << std::endl;
+	std::cout << "Trace written to " << fileName << std::endl;
+	return true;
+}
+
+#endif
@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       profiler.h
+ * \author     rka Prokopov
+ * \date       2025/5/15
+ * \brief      Scoped CPU and GPU zones written as a Chrome / Perfetto trace,
+ *				built only with TRACE_PROFILER defined (Profile configuration), otherwise the
+ *				macros are empty
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef TRACE_PROFILER
+
+#include <string>
+#include "pgr.h"
+
+const int PROFILER_RING_SIZE = 65536;     // zones kept per thread, the oldest are overwritten
+const int PROFILER_DETAIL_LENGTH = 48;    // characters of a zone detail, e.g. file name
+const int PROFILER_GPU_LATENCY = 4;       // frames before timestamp queries are read
+const int PROFILER_GPU_ZONES = 32;        // GPU zones of one frame, more are dropped
+const char* const PROFILER_TRACE_FILE = "frameTrace.json";
+
+/// <summary>
+/// CPU time of a scope, stored in the ring of the calling thread when the scope ends
+/// </summary>
+class profileZone {
+public:
+	profileZone(const char* name, const char* detail = NULL);
+	~profileZone();
+
+private:
+	const char* name;
+	const char* detail;
+	double start;
+};
+
+/// <summary>
+/// CPU zone plus GL timestamps around the same scope, only on the thread owning the context
+/// </summary>
+class profileGpuZone {
+public:
+	profileGpuZone(const char* name);
+	~profileGpuZone();
+
+private:
+	profileZone cpuZone;
+	int index;
+};
+
+/// <summary>
+/// thread rings, GPU query slots and the trace output
+/// </summary>
+class profiler {
+public:
+	static void setThreadName(const char* name);
+	static void initGpu();       // after the GL context exists, repeated calls are ignored
+	static void endFrame();      // reads the queries issued PROFILER_GPU_LATENCY frames ago
+	static void cleanUpGpu();
+	static bool writeTrace(const std::string& fileName);
+};
+
+#define PROFILE_ZONE(name) profileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_ZONE_DETAIL(name, detail) profileZone PROFILE_CONCAT(profileZone, __LINE__)(name, detail)
+#define PROFILE_GPU_ZONE(name) profileGpuZone PROFILE_CONCAT(profileGpuZone, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) profiler::setThreadName(name)
+#define PROFILE_GPU_INIT() profiler::initGpu()
+#define PROFILE_FRAME() profiler::endFrame()
+#define PROFILE_WRITE(fileName) profiler::writeTrace(fileName)
+#define PROFILE_SHUTDOWN() profiler::cleanUpGpu()
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_ZONE_DETAIL(name, detail) ((void)0)
+#define PROFILE_GPU_ZONE(name) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#define PROFILE_GPU_INIT() ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_WRITE(fileName) ((void)0)
+#define PROFILE_SHUTDOWN() ((void)0)
+
+#endif
+
+#endif
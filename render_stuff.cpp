@@ -8,18 +8,100 @@
 */
 //-----------------------------------------------------------------------------------------
 #include "render_stuff.h"
-
-GLint SQUARES_AMOUNT = 500;  // amount of squares
-GLfloat  waterVertices[SQUARE_SIZE * 10000]; // array for terrain
+#include "glCounters.h"
+#include <algorithm>
+#include <IL/il.h>
+
+waterMeshGenerator waterMesh; // clipmap rings of the lake
+oceanSimulator ocean;         // FFT waves computed on worker threads
+oceanTextureUploader oceanMaps;
+reflectionProbe probe;        // static reflections for lower water quality
+rippleSimulator ripples;      // interactive ripples from duck, boat and clicks
+buoyancySystem buoyancy;      // props floating on the ocean
+waterVisibility waterVisible; // skips water passes when the lake is not seen
+jobSystem jobs;               // frame work spread over all cores
+FrameSnapshot renderFrame;    // simulation state of the frame being drawn
+std::mutex simulationMutex;   // held by simulation steps and input that changes their state
+GameSettings gameSettings;
+drawList frameDrawList;       // meshes of the frame, recorded once and replayed by every pass
+passUniforms passBlock;       // view and projection of the current pass
+spriteBatch overlayBatch;     // speed bar and HUD, one draw call
+perfHud performanceHud;       // toggled by 'h'
+RenderCounters renderCounters;
+startupTimer startupTimes;     // stages of every asset, enabled by --startup
+// state baked into the probe
+float probeLightIntensity = -1.0f;
+bool probeFog = false;
 GLfloat WAVE_SPEED = 0.03f;
 
+// every texture of the startup goes through here so it shows up in the trace, decoded
+// with DevIL like pgr::createTexture but in separate steps timed by the startup benchmark
+static GLuint loadTexture(const std::string& fileName) {
+	PROFILE_ZONE_DETAIL("createTexture", fileName.c_str());
+	double start = startupTimes.now();
+	std::vector<char> fileData;
+	if (!startupTimer::readFile(fileName, fileData)) {
+		std::cerr << "Error: texture '" << fileName << "' cannot be read" << std::endl;
+		return 0;
+	}
+	startupTimes.add(fileName, "texture", STARTUP_READ, start);
+	startupTimes.setBytes(fileName, "texture", fileData.size());
+
+	start = startupTimes.now();
+	ILuint image;
+	ilGenImages(1, &image);
+	ilBindImage(image);
+	ilEnable(IL_ORIGIN_SET);
+	ilOriginFunc(IL_ORIGIN_LOWER_LEFT);
+	if (!ilLoadL(IL_TYPE_UNKNOWN, fileData.data(), (ILuint)fileData.size()) || !ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE)) {
+		std::cerr << "Error: texture '" << fileName << "' cannot be decoded" << std::endl;
+		ilDeleteImages(1, &image);
+		return 0;
+	}
+	GLsizei width = ilGetInteger(IL_IMAGE_WIDTH);
+	GLsizei height = ilGetInteger(IL_IMAGE_HEIGHT);
+	startupTimes.add(fileName, "texture", STARTUP_DECODE, start);
+
+	start = startupTimes.now();
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, ilGetData());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	startupTimes.add(fileName, "texture", STARTUP_UPLOAD, start);
+	ilDeleteImages(1, &image);
+
+	// RGBA8 with the mipmap chain
+	renderCounters.textureBytes += (size_t)width * height * 4 * 4 / 3;
+	renderCounters.texturesLoaded++;
+	return texture;
+}
+
+// shaders of the startup, compile and link times go to the startup benchmark
+static GLuint loadShader(GLenum type, const std::string& fileName) {
+	startupTimes.readAsset(fileName, "shader");
+	double start = startupTimes.now();
+	GLuint shader = pgr::createShaderFromFile(type, fileName);
+	startupTimes.add(fileName, "shader", STARTUP_COMPILE, start);
+	return shader;
+}
+
+static GLuint linkProgram(const std::string& name, const std::vector<GLuint>& shaderList) {
+	double start = startupTimes.now();
+	GLuint program = pgr::createProgram(shaderList);
+	startupTimes.add(name + " program", "shader", STARTUP_COMPILE, start);
+	return program;
+}
+
 // set object geometry to NULL
 MeshGeometry* towerGeometry = NULL;
 MeshGeometry* skyboxGeometry = NULL;
 MeshGeometry* waterGeometry = NULL;
 MeshGeometry* explosionGeometry = NULL;
 MeshGeometry* platformGeometry = NULL;
-MeshGeometry* barGeometry = NULL;
 MeshGeometry* houseGeometry = NULL;
 MeshGeometry* cubeGeometry = NULL;
 MeshGeometry* sphereGeometry = NULL;
@@ -73,9 +155,11 @@ glm::vec3 housePosition = glm::vec3(2.0, -2.8, 1.5);
 skyboxFarPlaneShaderProgram  skyboxShader;
 SCommonShaderProgram shaderProgram;
 SCommonShaderProgram waterShader;
+SCommonShaderProgram layeredShader;     // lighting into both water layers at once
+SCommonShaderProgram mainShaderProgram; // main program saved during layered pass
 ExplosionShaderProgram explosionShader;
 BannerShaderProgram bannerShaderProgram;
-BarShaderProgram barShaderProgram;
+RippleShaderProgram rippleShader;
 
 // uniform variables
 GameUniformVariables gameUniVars;
@@ -83,11 +167,14 @@ GameUniformVariables gameUniVars;
 GameState gameState;
 //booleans
 bool fog = false;
+bool layeredPass = false;
 
 setUniforms renderObjects::uniSetter;
 
 //---------------------------------------------------LOAD MESHES-----------------------------------------------------------------------------
 bool renderObjects::initHandler::loadSingleMesh(const std::string& fileName, SCommonShaderProgram& shader, MeshGeometry** geometry) {
+	PROFILE_ZONE_DETAIL("loadSingleMesh", fileName.c_str());
+	renderCounters.meshesLoaded++;
 	std::cout << "loading model: " << fileName << "\n";
 	Assimp::Importer importer;
 
@@ -95,11 +182,19 @@ bool renderObjects::initHandler::loadSingleMesh(const std::string& fileName, SCo
 	importer.SetPropertyInteger(AI_CONFIG_PP_PTV_NORMALIZE, 1);
 
 	// Load asset from the file - you can play with various processing steps
-	const aiScene* scn = importer.ReadFile(fileName.c_str(), 0
-		| aiProcess_Triangulate             // Triangulate polygons (if any).
-		| aiProcess_PreTransformVertices    // Transforms scene hierarchy into one root with geometry-leafs only. For more see Doc.
-		| aiProcess_GenSmoothNormals        // Calculate normals per vertex.
-		| aiProcess_JoinIdenticalVertices);
+	// import and post-processing are separate steps for the startup benchmark
+	startupTimes.readAsset(fileName, "mesh");
+	double start = startupTimes.now();
+	const aiScene* scn = importer.ReadFile(fileName.c_str(), 0);
+	startupTimes.add(fileName, "mesh", STARTUP_PARSE, start);
+	start = startupTimes.now();
+	if (scn != NULL)
+		scn = importer.ApplyPostProcessing(0
+			| aiProcess_Triangulate             // Triangulate polygons (if any).
+			| aiProcess_PreTransformVertices    // Transforms scene hierarchy into one root with geometry-leafs only. For more see Doc.
+			| aiProcess_GenSmoothNormals        // Calculate normals per vertex.
+			| aiProcess_JoinIdenticalVertices);
+	startupTimes.add(fileName, "mesh", STARTUP_POSTPROCESS, start);
 
 	// abort if the loader fails
 	if (scn == NULL) {
@@ -120,6 +215,7 @@ bool renderObjects::initHandler::loadSingleMesh(const std::string& fileName, SCo
 
 	*geometry = new MeshGeometry;
 
+	start = startupTimes.now();
 	// vertex buffer object, store all vertex positions and normals
 	glGenBuffers(1, &((*geometry)->vertexBufferObject));
 	glBindBuffer(GL_ARRAY_BUFFER, (*geometry)->vertexBufferObject);
@@ -162,6 +258,7 @@ bool renderObjects::initHandler::loadSingleMesh(const std::string& fileName, SCo
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 3 * sizeof(unsigned) * mesh->mNumFaces, indices, GL_STATIC_DRAW);
 
 	delete[] indices;
+	startupTimes.add(fileName, "mesh", STARTUP_UPLOAD, start);
 
 	// copy the material info to MeshGeometry structure
 	const aiMaterial* mat = scn->mMaterials[mesh->mMaterialIndex];
@@ -214,7 +311,7 @@ bool renderObjects::initHandler::loadSingleMesh(const std::string& fileName, SCo
 		}
 
 		std::cout << "Loading texture file: " << textureName << std::endl;
-		(*geometry)->texture = pgr::createTexture(textureName);
+		(*geometry)->texture = loadTexture(textureName);
 	}
 	CHECK_GL_ERROR();
 
@@ -250,6 +347,8 @@ bool renderObjects::initHandler::loadSingleMesh(const std::string& fileName, SCo
 }
 
 bool renderObjects::initHandler::loadMesh(const std::string& fileName, SCommonShaderProgram& shader, std::vector<MeshGeometry*>* geometryFull) {
+	PROFILE_ZONE_DETAIL("loadMesh", fileName.c_str());
+	renderCounters.meshesLoaded++;
 	std::cout << "loading model: " << fileName << "\n";
 	Assimp::Importer importer;
 
@@ -257,11 +356,19 @@ bool renderObjects::initHandler::loadMesh(const std::string& fileName, SCommonSh
 	importer.SetPropertyInteger(AI_CONFIG_PP_PTV_NORMALIZE, 1);
 
 	// Load asset from the file - you can play with various processing steps
-	const aiScene* scn = importer.ReadFile(fileName.c_str(), 0
-		| aiProcess_Triangulate             // Triangulate polygons (if any).
-		| aiProcess_PreTransformVertices    // Transforms scene hierarchy into one root with geometry-leafs only. For more see Doc.
-		| aiProcess_GenSmoothNormals        // Calculate normals per vertex.
-		| aiProcess_JoinIdenticalVertices);
+	// import and post-processing are separate steps for the startup benchmark
+	startupTimes.readAsset(fileName, "mesh");
+	double start = startupTimes.now();
+	const aiScene* scn = importer.ReadFile(fileName.c_str(), 0);
+	startupTimes.add(fileName, "mesh", STARTUP_PARSE, start);
+	start = startupTimes.now();
+	if (scn != NULL)
+		scn = importer.ApplyPostProcessing(0
+			| aiProcess_Triangulate             // Triangulate polygons (if any).
+			| aiProcess_PreTransformVertices    // Transforms scene hierarchy into one root with geometry-leafs only. For more see Doc.
+			| aiProcess_GenSmoothNormals        // Calculate normals per vertex.
+			| aiProcess_JoinIdenticalVertices);
+	startupTimes.add(fileName, "mesh", STARTUP_POSTPROCESS, start);
 
 	// abort if the loader fails
 
@@ -279,7 +386,7 @@ bool renderObjects::initHandler::loadMesh(const std::string& fileName, SCommonSh
 
 		geometry = new MeshGeometry;
 
-
+		start = startupTimes.now();
 		// vertex buffer object, store all vertex positions and normals
 		glGenBuffers(1, &(geometry->vertexBufferObject));
 		glBindBuffer(GL_ARRAY_BUFFER, geometry->vertexBufferObject);
@@ -322,6 +429,7 @@ bool renderObjects::initHandler::loadMesh(const std::string& fileName, SCommonSh
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, 3 * sizeof(unsigned) * mesh->mNumFaces, indices, GL_STATIC_DRAW);
 
 		delete[] indices;
+		startupTimes.add(fileName, "mesh", STARTUP_UPLOAD, start);
 
 		// copy the material info to MeshGeometry structure
 		const aiMaterial* mat = scn->mMaterials[mesh->mMaterialIndex];
@@ -374,7 +482,7 @@ bool renderObjects::initHandler::loadMesh(const std::string& fileName, SCommonSh
 			}
 
 			std::cout << "Loading texture file: " << textureName << std::endl;
-			geometry->texture = pgr::createTexture(textureName);
+			geometry->texture = loadTexture(textureName);
 		}
 
 		glGenVertexArrays(1, &(geometry->vertexArrayObject));
@@ -426,6 +534,8 @@ void renderObjects::drawHandler::drawSkybox(const glm::mat4& viewMatrix, const g
 	glBindVertexArray((*geometry)->vertexArrayObject);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, (*geometry)->texture);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, (*geometry)->numTriangles + 2);
+	renderCounters.drawCalls++;
+	renderCounters.triangles += (*geometry)->numTriangles;
 
 	glBindVertexArray(0);
 	glUseProgram(0);
@@ -485,74 +595,83 @@ void renderObjects::initHandler::initSkyboxGeometry(skyboxFarPlaneShaderProgram
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
 
-// initialize all shaders
-void renderObjects::initHandler::initializeShaderPrograms() {
-
-	std::vector<GLuint> shaderList;
-
-	// MAIN SHADER
-	shaderList.push_back(pgr::createShaderFromFile(GL_VERTEX_SHADER, "lighting.vert"));
-	shaderList.push_back(pgr::createShaderFromFile(GL_FRAGMENT_SHADER, "lighting.frag"));
-	// create the shader program with two shaders
-	shaderProgram.program = pgr::createProgram(shaderList);
-
+// locations of everything lighting.frag uses, shared by the main and the layered program
+static void getLightingLocations(SCommonShaderProgram& shader) {
 	// get vertex attributes locations
-	shaderProgram.posLocation = glGetAttribLocation(shaderProgram.program, "position");
-	shaderProgram.normalLocation = glGetAttribLocation(shaderProgram.program, "normal");
-	shaderProgram.texCoordLocation = glGetAttribLocation(shaderProgram.program, "texCoord");
-	shaderProgram.colorLocation = glGetAttribLocation(shaderProgram.program, "color");
+	shader.posLocation = glGetAttribLocation(shader.program, "position");
+	shader.normalLocation = glGetAttribLocation(shader.program, "normal");
+	shader.texCoordLocation = glGetAttribLocation(shader.program, "texCoord");
+	shader.colorLocation = glGetAttribLocation(shader.program, "color");
 	// -----------------
 	//  get uniforms locations
-	shaderProgram.PVMmatrixLocation = glGetUniformLocation(shaderProgram.program, "PVMmatrix");
-	shaderProgram.VmatrixLocation = glGetUniformLocation(shaderProgram.program, "Vmatrix");
-	shaderProgram.MmatrixLocation = glGetUniformLocation(shaderProgram.program, "Mmatrix");
-	shaderProgram.normalMatrixLocation = glGetUniformLocation(shaderProgram.program, "normalMatrix");
-	shaderProgram.timeLocation = glGetUniformLocation(shaderProgram.program, "time");
+	shader.PVMmatrixLocation = glGetUniformLocation(shader.program, "PVMmatrix");
+	shader.VmatrixLocation = glGetUniformLocation(shader.program, "Vmatrix");
+	shader.MmatrixLocation = glGetUniformLocation(shader.program, "Mmatrix");
+	shader.normalMatrixLocation = glGetUniformLocation(shader.program, "normalMatrix");
+	shader.timeLocation = glGetUniformLocation(shader.program, "time");
 	// material
-	shaderProgram.ambientLocation = glGetUniformLocation(shaderProgram.program, "material.ambient");
-	shaderProgram.diffuseLocation = glGetUniformLocation(shaderProgram.program, "material.diffuse");
-	shaderProgram.specularLocation = glGetUniformLocation(shaderProgram.program, "material.specular");
-	shaderProgram.shininessLocation = glGetUniformLocation(shaderProgram.program, "material.shininess");
+	shader.ambientLocation = glGetUniformLocation(shader.program, "material.ambient");
+	shader.diffuseLocation = glGetUniformLocation(shader.program, "material.diffuse");
+	shader.specularLocation = glGetUniformLocation(shader.program, "material.specular");
+	shader.shininessLocation = glGetUniformLocation(shader.program, "material.shininess");
 	// texture
-	shaderProgram.secTextureLocation = glGetUniformLocation(shaderProgram.program, "secTexture");
-	shaderProgram.texSamplerLocation = glGetUniformLocation(shaderProgram.program, "texSampler");
-	shaderProgram.texSampler2Location = glGetUniformLocation(shaderProgram.program, "texSampler2");
-	shaderProgram.useTextureLocation = glGetUniformLocation(shaderProgram.program, "material.useTexture");
+	shader.secTextureLocation = glGetUniformLocation(shader.program, "secTexture");
+	shader.texSamplerLocation = glGetUniformLocation(shader.program, "texSampler");
+	shader.texSampler2Location = glGetUniformLocation(shader.program, "texSampler2");
+	shader.useTextureLocation = glGetUniformLocation(shader.program, "material.useTexture");
 	// reflector
-	shaderProgram.reflectorPositionLocation = glGetUniformLocation(shaderProgram.program, "reflectorPosition");
-	shaderProgram.reflectorDirectionLocation = glGetUniformLocation(shaderProgram.program, "reflectorDirection");
+	shader.reflectorPositionLocation = glGetUniformLocation(shader.program, "reflectorPosition");
+	shader.reflectorDirectionLocation = glGetUniformLocation(shader.program, "reflectorDirection");
 	// fog switch
-	shaderProgram.isFogLocation = glGetUniformLocation(shaderProgram.program, "fog");
+	shader.isFogLocation = glGetUniformLocation(shader.program, "fog");
 	// LIGHTS: sun
-	shaderProgram.sunLocation.ambient = glGetUniformLocation(shaderProgram.program, "sunUni.ambient");
-	shaderProgram.sunLocation.diffuse = glGetUniformLocation(shaderProgram.program, "sunUni.diffuse");
-	shaderProgram.sunLocation.specular = glGetUniformLocation(shaderProgram.program, "sunUni.specular");
+	shader.sunLocation.ambient = glGetUniformLocation(shader.program, "sunUni.ambient");
+	shader.sunLocation.diffuse = glGetUniformLocation(shader.program, "sunUni.diffuse");
+	shader.sunLocation.specular = glGetUniformLocation(shader.program, "sunUni.specular");
 
 	// LIGHTS: reflLocation
-	shaderProgram.reflLocation.ambient = glGetUniformLocation(shaderProgram.program, "cameraReflectorUni.ambient");
-	shaderProgram.reflLocation.diffuse = glGetUniformLocation(shaderProgram.program, "cameraReflectorUni.diffuse");
-	shaderProgram.reflLocation.specular = glGetUniformLocation(shaderProgram.program, "cameraReflectorUni.specular");
-	shaderProgram.reflLocation.spotCosCutOff = glGetUniformLocation(shaderProgram.program, "cameraReflectorUni.spotCosCutOff");
-	shaderProgram.reflLocation.spotExponent = glGetUniformLocation(shaderProgram.program, "cameraReflectorUni.spotExponent");
+	shader.reflLocation.ambient = glGetUniformLocation(shader.program, "cameraReflectorUni.ambient");
+	shader.reflLocation.diffuse = glGetUniformLocation(shader.program, "cameraReflectorUni.diffuse");
+	shader.reflLocation.specular = glGetUniformLocation(shader.program, "cameraReflectorUni.specular");
+	shader.reflLocation.spotCosCutOff = glGetUniformLocation(shader.program, "cameraReflectorUni.spotCosCutOff");
+	shader.reflLocation.spotExponent = glGetUniformLocation(shader.program, "cameraReflectorUni.spotExponent");
 
 	// LIGHTS: sphereLocation
-	shaderProgram.sphereLocation.ambient = glGetUniformLocation(shaderProgram.program, "sphereLightUni.ambient");
-	shaderProgram.sphereLocation.diffuse = glGetUniformLocation(shaderProgram.program, "sphereLightUni.diffuse");
-	shaderProgram.sphereLocation.specular = glGetUniformLocation(shaderProgram.program, "sphereLightUni.specular");
+	shader.sphereLocation.ambient = glGetUniformLocation(shader.program, "sphereLightUni.ambient");
+	shader.sphereLocation.diffuse = glGetUniformLocation(shader.program, "sphereLightUni.diffuse");
+	shader.sphereLocation.specular = glGetUniformLocation(shader.program, "sphereLightUni.specular");
 
-	shaderProgram.spotLightLocation = glGetUniformLocation(shaderProgram.program, "spotLight");
-	shaderProgram.pointLightIntensityLocation = glGetUniformLocation(shaderProgram.program, "pointLightIntensity");
-	shaderProgram.lightIntensityLocation = glGetUniformLocation(shaderProgram.program, "lightIntensity");
+	shader.spotLightLocation = glGetUniformLocation(shader.program, "spotLight");
+	shader.pointLightIntensityLocation = glGetUniformLocation(shader.program, "pointLightIntensity");
+	shader.lightIntensityLocation = glGetUniformLocation(shader.program, "lightIntensity");
+}
+
+// initialize all shaders
+void renderObjects::initHandler::initializeShaderPrograms() {
+	PROFILE_ZONE("initializeShaderPrograms");
+
+	std::vector<GLuint> shaderList;
+
+	// MAIN SHADER
+	shaderList.push_back(loadShader(GL_VERTEX_SHADER, "lighting.vert"));
+	shaderList.push_back(loadShader(GL_FRAGMENT_SHADER, "lighting.frag"));
+	// create the shader program with two shaders
+	shaderProgram.program = linkProgram("shaderProgram", shaderList);
+
+	getLightingLocations(shaderProgram);
+	// view of the pass is shared by all draws through a uniform block
+	passBlock.init();
+	passBlock.bind(shaderProgram.program);
 
 	//SKYBOX SHADER
 
 	shaderList.clear();
 
 	// push vertex shader and fragment shader
-	shaderList.push_back(pgr::createShaderFromFile(GL_VERTEX_SHADER, "skybox.vert"));
-	shaderList.push_back(pgr::createShaderFromFile(GL_FRAGMENT_SHADER, "skybox.frag"));
+	shaderList.push_back(loadShader(GL_VERTEX_SHADER, "skybox.vert"));
+	shaderList.push_back(loadShader(GL_FRAGMENT_SHADER, "skybox.frag"));
 
-	skyboxShader.program = pgr::createProgram(shaderList);
+	skyboxShader.program = linkProgram("skyboxShader", shaderList);
 
 	// get vertex attributes locations
 	skyboxShader.screenCoordLocation = glGetAttribLocation(skyboxShader.program, "screenCoord");
@@ -563,11 +682,10 @@ void renderObjects::initHandler::initializeShaderPrograms() {
 
 	shaderList.clear();
 	// WATER SHADER
-	// use same vertex shader
-	shaderList.push_back(pgr::createShaderFromFile(GL_VERTEX_SHADER, "lighting.vert"));
-	shaderList.push_back(pgr::createShaderFromFile(GL_FRAGMENT_SHADER, "water.frag"));
+	shaderList.push_back(loadShader(GL_VERTEX_SHADER, "water.vert"));
+	shaderList.push_back(loadShader(GL_FRAGMENT_SHADER, "water.frag"));
 
-	waterShader.program = pgr::createProgram(shaderList);
+	waterShader.program = linkProgram("waterShader", shaderList);
 	// get vertex attributes locations
 	waterShader.posLocation = glGetAttribLocation(waterShader.program, "position");
 	waterShader.normalLocation = glGetAttribLocation(waterShader.program, "normal");
@@ -595,6 +713,16 @@ void renderObjects::initHandler::initializeShaderPrograms() {
 	waterShader.refractionTextureLocation = glGetUniformLocation(waterShader.program, "refractionTexture");
 	waterShader.dudvMapLocation = glGetUniformLocation(waterShader.program, "dudvMapTexture");
 	waterShader.moveFactorLocation = glGetUniformLocation(waterShader.program, "moveFactor");
+	waterShader.displacementMapLocation = glGetUniformLocation(waterShader.program, "displacementMap");
+	waterShader.normalMapLocation = glGetUniformLocation(waterShader.program, "normalMap");
+	waterShader.oceanPatchSizeLocation = glGetUniformLocation(waterShader.program, "oceanPatchSize");
+	waterShader.reflectionProbeLocation = glGetUniformLocation(waterShader.program, "reflectionProbe");
+	waterShader.useProbeLocation = glGetUniformLocation(waterShader.program, "useProbe");
+	waterShader.useRefractionLocation = glGetUniformLocation(waterShader.program, "useRefraction");
+	waterShader.rippleMapLocation = glGetUniformLocation(waterShader.program, "rippleMap");
+	waterShader.rippleAreaLocation = glGetUniformLocation(waterShader.program, "rippleArea");
+	waterShader.waterLayersLocation = glGetUniformLocation(waterShader.program, "waterLayers");
+	waterShader.useLayersLocation = glGetUniformLocation(waterShader.program, "useLayers");
 	// fog switch
 	waterShader.isFogLocation = glGetUniformLocation(waterShader.program, "isFog");
 	// lights
@@ -605,10 +733,10 @@ void renderObjects::initHandler::initializeShaderPrograms() {
 
 	// EXPLOSION SHADER
 	// push vertex shader and fragment shader
-	shaderList.push_back(pgr::createShaderFromFile(GL_VERTEX_SHADER, "explosion.vert"));
-	shaderList.push_back(pgr::createShaderFromFile(GL_FRAGMENT_SHADER, "explosion.frag"));
+	shaderList.push_back(loadShader(GL_VERTEX_SHADER, "explosion.vert"));
+	shaderList.push_back(loadShader(GL_FRAGMENT_SHADER, "explosion.frag"));
 
-	explosionShader.program = pgr::createProgram(shaderList);
+	explosionShader.program = linkProgram("explosionShader", shaderList);
 
 	// get vertex attributes locations
 	explosionShader.posLocation = glGetAttribLocation(explosionShader.program, "position");
@@ -625,11 +753,11 @@ void renderObjects::initHandler::initializeShaderPrograms() {
 	// BANNER SHADER
 	
 	// push vertex shader and fragment shader
-	shaderList.push_back(pgr::createShaderFromFile(GL_VERTEX_SHADER, "banner.vert"));
-	shaderList.push_back(pgr::createShaderFromFile(GL_FRAGMENT_SHADER, "banner.frag"));
+	shaderList.push_back(loadShader(GL_VERTEX_SHADER, "banner.vert"));
+	shaderList.push_back(loadShader(GL_FRAGMENT_SHADER, "banner.frag"));
 
 	// Create the program with two shaders
-	bannerShaderProgram.program = pgr::createProgram(shaderList);
+	bannerShaderProgram.program = linkProgram("bannerShaderProgram", shaderList);
 
 	// get position and color attributes locations
 	bannerShaderProgram.posLocation = glGetAttribLocation(bannerShaderProgram.program, "position");
@@ -641,22 +769,45 @@ void renderObjects::initHandler::initializeShaderPrograms() {
 
 	shaderList.clear();
 
-	// LOADING BAR SHADER
-
-	// push vertex shader and fragment shader
-	shaderList.push_back(pgr::createShaderFromFile(GL_VERTEX_SHADER, "loadingBar.vert"));
-	shaderList.push_back(pgr::createShaderFromFile(GL_FRAGMENT_SHADER, "loadingBar.frag"));
-
-	barShaderProgram.program = pgr::createProgram(shaderList);
-
-	// Zskejte pozice atribut (vertex position a texture coordinates)
-	barShaderProgram.posLocation = glGetAttribLocation(barShaderProgram.program, "position");
-	barShaderProgram.texCoordLocation = glGetAttribLocation(barShaderProgram.program, "texCoord");
-
-	// Zskejte pozice uniformnch promnnch
-	barShaderProgram.PVMmatrixLocation = glGetUniformLocation(barShaderProgram.program, "PVMmatrix");
-	barShaderProgram.timeLocation = glGetUniformLocation(barShaderProgram.program, "time");
-	barShaderProgram.texSamplerLocation = glGetUniformLocation(barShaderProgram.program, "texSampler");
+	// RIPPLE SHADER
+	shaderList.push_back(loadShader(GL_VERTEX_SHADER, "ripple.vert"));
+	shaderList.push_back(loadShader(GL_FRAGMENT_SHADER, "ripple.frag"));
+
+	rippleShader.program = linkProgram("rippleShader", shaderList);
+
+	rippleShader.posLocation = glGetAttribLocation(rippleShader.program, "position");
+	rippleShader.heightMapLocation = glGetUniformLocation(rippleShader.program, "heightMap");
+	rippleShader.texelSizeLocation = glGetUniformLocation(rippleShader.program, "texelSize");
+	rippleShader.dampingLocation = glGetUniformLocation(rippleShader.program, "damping");
+	rippleShader.dropCountLocation = glGetUniformLocation(rippleShader.program, "dropCount");
+	rippleShader.dropsLocation = glGetUniformLocation(rippleShader.program, "drops");
+
+	// LAYERED SHADER
+	if (gameSettings.layeredWater) {
+		shaderList.clear();
+		shaderList.push_back(loadShader(GL_VERTEX_SHADER, "layered.vert"));
+		shaderList.push_back(loadShader(GL_GEOMETRY_SHADER, "layered.geom"));
+		shaderList.push_back(loadShader(GL_FRAGMENT_SHADER, "lighting.frag"));
+
+		layeredShader.program = linkProgram("layeredShader", shaderList);
+		if (layeredShader.program == 0) {
+			std::cerr << "layered water shader failed, using separate passes" << std::endl;
+			return;
+		}
+		// meshes keep vertex arrays of the main program, so the attributes must sit at the same locations
+		if (shaderProgram.posLocation >= 0)
+			glBindAttribLocation(layeredShader.program, shaderProgram.posLocation, "position");
+		if (shaderProgram.normalLocation >= 0)
+			glBindAttribLocation(layeredShader.program, shaderProgram.normalLocation, "normal");
+		if (shaderProgram.texCoordLocation >= 0)
+			glBindAttribLocation(layeredShader.program, shaderProgram.texCoordLocation, "texCoord");
+		glLinkProgram(layeredShader.program);
+
+		getLightingLocations(layeredShader);
+		passBlock.bind(layeredShader.program);
+		layeredShader.layerPVmatrixLocation = glGetUniformLocation(layeredShader.program, "layerPVmatrix");
+		layeredShader.waterHeightLocation = glGetUniformLocation(layeredShader.program, "waterHeight");
+	}
 }
 
 
@@ -665,6 +816,12 @@ void renderObjects::initHandler::setLight(Light& sun, Light& camR, Light& sphere
 	uniSetter.setLightUniforms(sun, shaderProgram.sunLocation);
 	uniSetter.setLightUniforms(camR, shaderProgram.reflLocation);
 	uniSetter.setLightUniforms(sphere, shaderProgram.sphereLocation);
+	if (layeredShader.program) {
+		glUseProgram(layeredShader.program);
+		uniSetter.setLightUniforms(sun, layeredShader.sunLocation);
+		uniSetter.setLightUniforms(camR, layeredShader.reflLocation);
+		uniSetter.setLightUniforms(sphere, layeredShader.sphereLocation);
+	}
 	glUseProgram(0);
 }
 
@@ -711,21 +868,22 @@ void renderObjects::initHandler::initMaterial(MeshGeometry** geometry, Material
 	(*geometry)->diffuse = material.diffuse;
 	(*geometry)->specular = material.specular;
 	(*geometry)->shininess = material.shininess;
-	(*geometry)->texture = pgr::createTexture(material.texture);
+	(*geometry)->texture = loadTexture(material.texture);
 }
 
 // initialize water
 void renderObjects::initHandler::initWater(SCommonShaderProgram& shader, MeshGeometry** geometry, waterBufferMaker* waterFBOHandler) {
-	generateWater(waterVertices);
-
 	*geometry = new MeshGeometry;
-	(*geometry)->numTriangles = SQUARES_AMOUNT * 2;
 	glGenVertexArrays(1, &((*geometry)->vertexArrayObject));
 	glBindVertexArray((*geometry)->vertexArrayObject);
 
 	glGenBuffers(1, &((*geometry)->vertexBufferObject));
-	glBindBuffer(GL_ARRAY_BUFFER, (*geometry)->vertexBufferObject);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(waterVertices), waterVertices, GL_STATIC_DRAW);
+	glGenBuffers(1, &((*geometry)->elementBufferObject));
+
+	// rings around the lake center, drawWater moves them with the camera
+	waterMesh.update(glm::vec3(0.0f));
+	waterMesh.upload((*geometry)->vertexBufferObject, (*geometry)->elementBufferObject);
+	(*geometry)->numTriangles = waterMesh.getTriangleCount();
 
 	glEnableVertexAttribArray(shader.posLocation);
 	glVertexAttribPointer(shader.posLocation, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
@@ -750,6 +908,7 @@ void renderObjects::initHandler::initWater(SCommonShaderProgram& shader, MeshGeo
 	glBindTexture(GL_TEXTURE_2D, 0);
 
 	glBindVertexArray(0);
+	waterVisible.init();
 	CHECK_GL_ERROR();
 }
 
@@ -765,7 +924,7 @@ void renderObjects::initHandler::initExplosion(ExplosionShaderProgram& explosion
 	glBindBuffer(GL_ARRAY_BUFFER, (*geometry)->vertexBufferObject);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(explosionVertexData), explosionVertexData, GL_STATIC_DRAW);
 
-	(*geometry)->texture = pgr::createTexture(EXPLOSION_TEXTURE_PATH);
+	(*geometry)->texture = loadTexture(EXPLOSION_TEXTURE_PATH);
 
 	glEnableVertexAttribArray(explosionShader.posLocation);
 	glVertexAttribPointer(explosionShader.posLocation, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), 0);
@@ -776,15 +935,54 @@ void renderObjects::initHandler::initExplosion(ExplosionShaderProgram& explosion
 	(*geometry)->numTriangles = explosionVertexCount;
 }
 
+// start ocean workers and fill the maps with the first step
+void renderObjects::initHandler::initOcean(const GameSettings& settings) {
+	ocean.init(settings.oceanResolution, settings.oceanPatchSize, settings.oceanAmplitude,
+		settings.oceanChoppiness, settings.oceanThreads);
+	oceanMaps.init(ocean.getResolution());
+	std::cout << "Ocean: " << ocean.getResolution() << "x" << ocean.getResolution() << ", "
+		<< ocean.getThreadCount() << " threads" << std::endl;
+
+	ocean.simulate(0.0f);
+	oceanMaps.upload(ocean.getDisplacement(), ocean.getNormals());
+}
+
+// probe is filled on the first frame, it has to wait for models and lights
+void renderObjects::initHandler::initReflectionProbe(const GameSettings& settings) {
+	probe.init(settings.probeSize, REFLECTION_PROBE_POSITION);
+	probeLightIntensity = -1.0f;
+}
+
+void renderObjects::initHandler::initRipples() {
+	ripples.init(&rippleShader);
+}
+
+// every prop with float=true gets its body, hull size follows object size
+void renderObjects::initHandler::initBuoyancy(std::map<std::string, ObjectProp>& loadProps) {
+	buoyancy.clear();
+	for (std::map<std::string, ObjectProp>::iterator it = loadProps.begin(); it != loadProps.end(); ++it) {
+		if (it->second.floating) {
+			it->second.buoyancyBody = buoyancy.addBody(it->second.position, std::max(0.5f * it->second.size, 0.05f));
+		}
+	}
+	// a step kicked by the last frame may still be writing the displacement
+	ocean.wait();
+	buoyancy.setHeightField(ocean.getDisplacement(), ocean.getResolution(), ocean.getPatchSize());
+}
+
 // initialize all models
 void renderObjects::initHandler::initializeModels(waterBufferMaker* waterFBOHandler) {
 	initSkyboxGeometry(skyboxShader, &skyboxGeometry);
 	std::cout << "Loading texture file: " << "dudv" << std::endl;
-	waterFBOHandler->setDudvMapTex(pgr::createTexture(DUDV_MAP));
+	waterFBOHandler->setDudvMapTex(loadTexture(DUDV_MAP));
 	initWater(waterShader, &waterGeometry, waterFBOHandler);
-	initBarGeometry(barShaderProgram.program, &barGeometry);
+	loadingBarTexture = loadTexture(LOADING_BAR_PATH);
+	glBindTexture(GL_TEXTURE_2D, loadingBarTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	overlayBatch.init();
 	initExplosion(explosionShader, &explosionGeometry);
-	platformTexture = pgr::createTexture(GOLD_TEXTURE_PATH);
+	platformTexture = loadTexture(GOLD_TEXTURE_PATH);
 	initplatformGeometry(shaderProgram, &platformGeometry);
 	if (loadSingleMesh(TOWER_MODEL_PATH, shaderProgram, &towerGeometry) != true) {
 		std::cerr << "initializeModels(): tower model loading failed." << std::endl;
@@ -792,7 +990,7 @@ void renderObjects::initHandler::initializeModels(waterBufferMaker* waterFBOHand
 	if (loadSingleMesh(CUBE_MODEL_PATH, shaderProgram, &cubeGeometry) != true) {
 		std::cerr << "initializeModels(): Cube model loading failed." << std::endl;
 	}
-	grassTexture = pgr::createTexture(GRASS_TEXTURE_PATH);
+	grassTexture = loadTexture(GRASS_TEXTURE_PATH);
 	cubeGeometry->secTex = grassTexture;
 	if(!grassTexture) {
 		std::cerr << "loading failed." << std::endl;
@@ -826,41 +1024,36 @@ void renderObjects::initHandler::initializeModels(waterBufferMaker* waterFBOHand
 	}
 }
 
-// initialize banner geometry
-void renderObjects::initHandler::initBarGeometry(GLuint shader, MeshGeometry** geometry) {
-	*geometry = new MeshGeometry;
-
-	(*geometry)->texture = pgr::createTexture(LOADING_BAR_PATH);
-	loadingBarTexture = (*geometry)->texture;
-	glBindTexture(GL_TEXTURE_2D, (*geometry)->texture);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-
-	glGenVertexArrays(1, &((*geometry)->vertexArrayObject));
-	glBindVertexArray((*geometry)->vertexArrayObject);
-
-	glGenBuffers(1, &((*geometry)->vertexBufferObject));
-	glBindBuffer(GL_ARRAY_BUFFER, (*geometry)->vertexBufferObject);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(barVertexData), barVertexData, GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(barShaderProgram.posLocation);
-	glEnableVertexAttribArray(barShaderProgram.texCoordLocation);
-	// vertices of triangles - start at the beginning of the interlaced array
-	glVertexAttribPointer(barShaderProgram.posLocation, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), 0);
-	// texture coordinates of each vertices are stored just after its position
-	glVertexAttribPointer(barShaderProgram.texCoordLocation, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-
-	glBindVertexArray(0);
+//--------------------------------------------------------------------------------TEXTURES--------------------------------------------------------
 
-	(*geometry)->numTriangles = barNumQuadVertices;
+// clipmap rings rebuilt on a worker while the water targets are drawn, the job is not
+// one of the frame jobs, so beginFrame of the simulation never hands it out again
+static job waterMeshTask;
+static job* waterMeshJob = NULL;
+static bool waterMeshChanged = false;
+
+void renderObjects::drawHandler::prepareWaterMesh(const glm::vec3& cameraPosition) {
+	finishWaterMesh();
+	waterMeshJob = &waterMeshTask;
+	jobs.prepare(waterMeshJob, "water mesh", [cameraPosition]() {
+		if (waterMesh.update(cameraPosition))
+			waterMeshChanged = true;
+	});
+	jobs.submit(waterMeshJob);
 }
 
-//--------------------------------------------------------------------------------TEXTURES--------------------------------------------------------
+// job has to end before it is prepared again
+void renderObjects::drawHandler::finishWaterMesh() {
+	if (waterMeshJob == NULL)
+		return;
+	jobs.wait(waterMeshJob);
+	waterMeshJob = NULL;
+}
 
 // draw water
 void renderObjects::drawHandler::drawWater(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni, waterBufferMaker* waterFBOHandler) {
 
-	GLfloat factor = WAVE_SPEED * gameState.elapsedTime;
+	GLfloat factor = WAVE_SPEED * renderFrame.time;
 	factor = std::fmod(factor, 1.0);
 	glUseProgram(shaderProgram.program);
 
@@ -876,62 +1069,231 @@ void renderObjects::drawHandler::drawWater(const glm::mat4& viewMatrix, const gl
 	glActiveTexture(GL_TEXTURE2);
 	glBindTexture(GL_TEXTURE_2D, waterFBOHandler->getdudvMapTexID());
 	glUniform1i(shaderProgram.dudvMapLocation, 2);
+
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_2D, oceanMaps.getDisplacementTexture());
+	glActiveTexture(GL_TEXTURE4);
+	glBindTexture(GL_TEXTURE_2D, oceanMaps.getNormalTexture());
+
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, probe.getTexture());
+	glUniform1i(shaderProgram.reflectionProbeLocation, 5);
+	glUniform1i(shaderProgram.useProbeLocation, gameSettings.waterQuality != WATER_QUALITY_HIGH);
+	glUniform1i(shaderProgram.useRefractionLocation, gameSettings.waterQuality != WATER_QUALITY_LOW);
+
+	glActiveTexture(GL_TEXTURE6);
+	glBindTexture(GL_TEXTURE_2D, ripples.getHeightTexture());
+	glUniform1i(shaderProgram.rippleMapLocation, 6);
+	glUniform1f(shaderProgram.rippleAreaLocation, RIPPLE_AREA);
+
+	glActiveTexture(GL_TEXTURE7);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, waterFBOHandler->getLayeredTexture());
+	glUniform1i(shaderProgram.waterLayersLocation, 7);
+	glUniform1i(shaderProgram.useLayersLocation, layeredWaterActive(waterFBOHandler));
 	glActiveTexture(GL_TEXTURE0);
 
-	uniSetter.setWaterUni(shaderProgram, factor);
+	uniSetter.setWaterUni(shaderProgram, factor, ocean.getPatchSize());
 	glm::mat4 modelMatrix = glm::mat4(1.0f);
 	modelMatrix = glm::scale(modelMatrix, glm::vec3(1, 1, 1));
 	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-	glUniform1f(shaderProgram.timeLocation, gameState.elapsedTime);
+	glUniform1f(shaderProgram.timeLocation, renderFrame.time);
 
 	uniSetter.setMaterialUniforms( *geometry, shaderProgram, gameUni );
 
 	glBindVertexArray((*geometry)->vertexArrayObject);
-	glDrawArrays(GL_TRIANGLES, 0, 3 * (*geometry)->numTriangles);
+
+	// keep the dense rings under the camera, usually already rebuilt by the water mesh job
+	if (waterMeshJob != NULL)
+		finishWaterMesh();
+	else if (waterMesh.update(glm::vec3(glm::inverse(viewMatrix)[3])))
+		waterMeshChanged = true;
+	if (waterMeshChanged) {
+		waterMesh.upload((*geometry)->vertexBufferObject, (*geometry)->elementBufferObject);
+		(*geometry)->numTriangles = waterMesh.getTriangleCount();
+		waterMeshChanged = false;
+	}
+
+	glEnable(GL_PRIMITIVE_RESTART);
+	glPrimitiveRestartIndex(WATER_RESTART_INDEX);
+	// visible samples decide about water passes in the next frame
+	waterVisible.beginQuery();
+	glDrawElements(GL_TRIANGLE_STRIP, waterMesh.getIndexCount(), GL_UNSIGNED_INT, (void*)0);
+	renderCounters.drawCalls++;
+	renderCounters.triangles += waterMesh.getTriangleCount();
+	waterVisible.endQuery();
+	glDisable(GL_PRIMITIVE_RESTART);
+
 	glBindVertexArray(0);
 	glUseProgram(0);
 }
 
-// draws banner with credits
-void renderObjects::drawHandler::drawBar(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, float loadingBarWidth) {
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_BLEND);                     // alpha 
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+// upload last finished ocean step and start the next one, workers compute while the frame renders
+void renderObjects::drawHandler::updateOcean(float time) {
+	if (!ocean.finished())
+		return;
+	// keep the results until they are really uploaded
+	if (oceanMaps.upload(ocean.getDisplacement(), ocean.getNormals())) {
+		// heights are read by simulation steps, when one is running they wait for the next wave step
+		std::unique_lock<std::mutex> lock(simulationMutex, std::try_to_lock);
+		if (lock.owns_lock())
+			buoyancy.setHeightField(ocean.getDisplacement(), ocean.getResolution(), ocean.getPatchSize());
+		ocean.kick(time);
+	}
+}
 
-	glUseProgram(barShaderProgram.program);
+// ripple steps render into their own framebuffer
+void renderObjects::drawHandler::updateRipples(float time) {
+	ripples.update(time);
+	glViewport(0, 0, gameState.windowWidth, gameState.windowHeight);
+}
 
-	glm::mat4 P = glm::ortho(-1.f, 1.f, -1.f, 1.f);    // 2-D projectionviewport
-	glm::mat4 V = glm::mat4(1.f);                      //no view
-	glm::mat4 M = glm::translate(glm::mat4(1.f), glm::vec3(0.0f, 0.95f, 0.f)) // right up
-		* glm::scale(glm::mat4(1.f), glm::vec3(1.0f, 0.2f, 1.f));
+// meshes of the frame are recorded once, every pass replays the list
+void renderObjects::drawHandler::beginDrawList() {
+	frameDrawList.clear();
+}
 
-	glm::mat4 PVM = P * V * M;
-	glUniformMatrix4fv(barShaderProgram.PVMmatrixLocation, 1, GL_FALSE, glm::value_ptr(PVM));
+// floating props bob on the waves, the reflection probe must not bake them in one pose
+static int propGroup(const ObjectProp& prop) {
+	return prop.buoyancyBody >= 0 ? DRAW_ANIMATED : DRAW_STATIC;
+}
 
-	// Pass the speed to the shader
-	glUniform1f(barShaderProgram.timeLocation, loadingBarWidth);  // Pass 'speed' directly to the shader to control texture cut-off
+// buildings and props from config, all of it still unless it floats
+void renderObjects::drawHandler::recordStaticScene(std::map<std::string, ObjectProp>& loadProps) {
+	recordTower(towerPosition);
+	recordCube(cubePosition, 8.0f);
+	recordCube(cube2Position, 3.0f);
+	recordCube(cube3Position, 11.0f);
+	recordObject(&maxwellGeometry, loadProps["maxwell2"], propGroup(loadProps["maxwell2"]));
+	recordPlatform(loadProps["platform"]);
+	recordObject(&duckGeometry, loadProps["duck2"], propGroup(loadProps["duck2"]));
+	recordObject(&duckGeometry, loadProps["duck3"], propGroup(loadProps["duck3"]));
+	recordObject(&balloonGeometry, loadProps["balloon"], propGroup(loadProps["balloon"]));
+	recordObject(&boatGeometry, loadProps["boat"], propGroup(loadProps["boat"]));
+	recordHouse(housePosition);
+	recordSphere(spherePosition);
+	recordModelProps(loadProps);
+}
 
-	// Bind texture
-	glBindTexture(GL_TEXTURE_2D, loadingBarTexture);
-	glUniform1i(barShaderProgram.texSamplerLocation, 0); // Assuming texture unit 0 is used
+// mesh named by the model key of config
+static std::vector<MeshGeometry*>* modelGeometry(const std::string& model) {
+	if (model == "duck")
+		return &duckGeometry;
+	if (model == "balloon")
+		return &balloonGeometry;
+	if (model == "boat")
+		return &boatGeometry;
+	if (model == "maxwell")
+		return &maxwellGeometry;
+	if (model == "pool")
+		return &poolGeometry;
+	if (model == "ball")
+		return &ballGeometry;
+	if (model == "hat")
+		return &hatGeometry;
+	return NULL;
+}
 
-	// Bind the vertex array object and draw the geometry
-	glBindVertexArray(barGeometry->vertexArrayObject);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, barGeometry->numTriangles);
+// props that name their mesh - generated scenes of the scaling benchmark
+void renderObjects::drawHandler::recordModelProps(std::map<std::string, ObjectProp>& loadProps) {
+	for (std::map<std::string, ObjectProp>::iterator it = loadProps.begin(); it != loadProps.end(); ++it) {
+		if (it->second.model.empty())
+			continue;
+		std::vector<MeshGeometry*>* geometry = modelGeometry(it->second.model);
+		if (geometry != NULL)
+			recordObject(geometry, it->second, propGroup(it->second));
+	}
+}
 
-	glBindVertexArray(0);
+// skybox alone, used for single layers of the water framebuffer
+void renderObjects::drawHandler::drawSky(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) {
+	drawSkybox(viewMatrix, projectionMatrix, skyboxShader, &skyboxGeometry, gameUniVars);
+}
+
+// single pass water targets need high quality, the layered program and the array framebuffer
+bool renderObjects::drawHandler::layeredWaterActive(waterBufferMaker* waterFBOHandler) {
+	return gameSettings.waterQuality == WATER_QUALITY_HIGH && layeredShader.program != 0 && waterFBOHandler->hasLayers();
+}
+
+// following draw calls go through the geometry shader and land in both layers
+void renderObjects::drawHandler::beginLayeredPass(const glm::mat4& reflectionView, const glm::mat4& refractionView, const glm::mat4& projectionMatrix) {
+	glm::mat4 layerPV[WATER_LAYER_COUNT];
+	layerPV[WATER_LAYER_REFLECTION] = projectionMatrix * reflectionView;
+	layerPV[WATER_LAYER_REFRACTION] = projectionMatrix * refractionView;
 
+	glUseProgram(layeredShader.program);
+	glUniformMatrix4fv(layeredShader.layerPVmatrixLocation, WATER_LAYER_COUNT, GL_FALSE, glm::value_ptr(layerPV[0]));
+	glUniform1f(layeredShader.waterHeightLocation, WATER_Z);
 	glUseProgram(0);
 
-	glEnable(GL_DEPTH_TEST);
-	glDisable(GL_BLEND);
+	// draw methods use the global program, swap it for the pass
+	mainShaderProgram = shaderProgram;
+	shaderProgram = layeredShader;
+	layeredPass = true;
+	glEnable(GL_CLIP_DISTANCE0);
+}
+
+void renderObjects::drawHandler::endLayeredPass() {
+	glDisable(GL_CLIP_DISTANCE0);
+	shaderProgram = mainShaderProgram;
+	layeredPass = false;
+}
+
+// render invalidated probe faces - all of them when the probe is empty, later one face per frame
+void renderObjects::drawHandler::updateReflectionProbe() {
+	if (gameSettings.waterQuality == WATER_QUALITY_HIGH)
+		return; // planar reflection is used
+
+	// light and fog are baked into the faces
+	if (fabs(gameUniVars.lightIntensity - probeLightIntensity) > 0.05f || gameUniVars.isFog != probeFog) {
+		probeLightIntensity = gameUniVars.lightIntensity;
+		probeFog = gameUniVars.isFog;
+		probe.invalidate();
+	}
+	if (!probe.needsUpdate())
+		return;
+
+	int faces = probe.isComplete() ? 1 : 6;
+	for (int i = 0; i < faces && probe.needsUpdate(); i++) {
+		glm::mat4 viewMatrix, projectionMatrix;
+		probe.bindNextFace(viewMatrix, projectionMatrix);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+		drawSkybox(viewMatrix, projectionMatrix, skyboxShader, &skyboxGeometry, gameUniVars);
+		viewFrustum frustum(projectionMatrix * viewMatrix);
+		replayDrawList(viewMatrix, projectionMatrix, &frustum, DRAW_STATIC);
+		probe.finishFace();
+	}
+	glViewport(0, 0, gameState.windowWidth, gameState.windowHeight);
+}
+
+// speed bar and the performance overlay in one batch
+void renderObjects::drawHandler::drawOverlay(float loadingBarWidth, passTimer& passes) {
+	overlayBatch.begin(gameState.windowWidth, gameState.windowHeight);
+
+	// bar grows from the left, the texture is stretched over the visible part
+	if (loadingBarWidth > 0.0f) {
+		overlayBatch.setImage(loadingBarTexture);
+		overlayBatch.addImage(0.0f, 0.01f * gameState.windowHeight, loadingBarWidth * gameState.windowWidth,
+			0.03f * gameState.windowHeight, glm::vec4(0.0f, 1.0f, 1.0f, 0.0f), glm::vec4(1.0f));
+	}
+	if (performanceHud.isVisible())
+		performanceHud.build(overlayBatch, passes, renderCounters, gameState.windowWidth, gameState.windowHeight);
+
+	overlayBatch.flush();
+	renderCounters.drawCalls++;
+	renderCounters.triangles += overlayBatch.getQuadCount() * 2;
 }
 
 //--------------------------------------------------------------------------------MODELS----------------------------------------------------------
 
-// draw single object
-void renderObjects::drawHandler::drawObject(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, std::vector<MeshGeometry*>* geometry, GameUniformVariables gameUni, ObjectProp param) {
-	glUseProgram(shaderProgram.program);
+// motion of a floating body as the simulation published it for this frame
+static glm::mat4 floatingMotion(int body) {
+	if (body < 0 || body >= (int)renderFrame.floatingMotion.size())
+		return glm::mat4(1.0f);
+	return renderFrame.floatingMotion[body];
+}
+
+// add meshes of a single object from config
+void renderObjects::drawHandler::recordObject(std::vector<MeshGeometry*>* geometry, const ObjectProp& param, int group) {
 	glm::mat4 modelMatrix = glm::mat4(1.0f);
 
 	if (param.align) {
@@ -942,23 +1304,16 @@ void renderObjects::drawHandler::drawObject(const glm::mat4& viewMatrix, const g
 		modelMatrix = glm::rotate(modelMatrix, param.angle, param.front);
 	}
 
-	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0, 1.0, 1.0) * param.size);
-	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-
-	for (int i = 0; i < (*geometry).size(); i++) {
-
-		uniSetter.setMaterialUniforms((*geometry)[i],shaderProgram, gameUni);
-
-		glBindVertexArray((*geometry)[i]->vertexArrayObject);
-		glDrawElements(GL_TRIANGLES, (*geometry)[i]->numTriangles * 3, GL_UNSIGNED_INT, 0);
+	if (param.buoyancyBody >= 0) {
+		modelMatrix = floatingMotion(param.buoyancyBody) * modelMatrix;
 	}
-	glBindVertexArray(0);
-	glUseProgram(0);
-	return;
+
+	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0, 1.0, 1.0) * param.size);
+	frameDrawList.addMeshes(*geometry, modelMatrix, group);
 }
 
-//draw ang align objects - hierarchical transformation
-void renderObjects::drawHandler::drawPoolMethod( float time, const glm::mat4& viewMatrix, SCommonShaderProgram& shaderProgram, Object* poolObj, Object* ballObj, GameUniformVariables gameUni, std::map<std::string, ObjectProp>& props, const glm::mat4& projectionMatrix) {
+//add ang align objects - hierarchical transformation
+void renderObjects::drawHandler::recordPool(float time, Object* poolObj, std::map<std::string, ObjectProp>& props) {
 	
 	float baseAngle = sin(time) * 5.0f;
 	glm::mat4 waveMatrix = glm::rotate(glm::mat4(1.0f),
@@ -969,22 +1324,13 @@ void renderObjects::drawHandler::drawPoolMethod( float time, const glm::mat4& vi
 
 	// first - parent, pool realistic transformation (depends on elapsedTime)
 	glm::mat4 poolTransform = alignMatrix * waveMatrix;
+	if (props["pool"].buoyancyBody >= 0) { // rocks on real waves
+		poolTransform = floatingMotion(props["pool"].buoyancyBody) * alignMatrix;
+	}
 
-	// draw Pool
-	glUseProgram(shaderProgram.program);
-
+	// Pool
 	poolTransform = glm::scale(poolTransform, glm::vec3(1.0, 1.0, 1.0) * props["pool"].size);
-	uniSetter.setTransformUniforms(poolTransform, viewMatrix, projectionMatrix, shaderProgram);
-
-	for (int i = 0; i < poolGeometry.size(); i++) {
-
-		uniSetter.setMaterialUniforms(poolGeometry[i], shaderProgram, gameUni);
-
-		glBindVertexArray(poolGeometry[i]->vertexArrayObject);
-		glDrawElements(GL_TRIANGLES, poolGeometry[i]->numTriangles * 3, GL_UNSIGNED_INT, 0);
-	}
-	glBindVertexArray(0);
-	glUseProgram(0);
+	frameDrawList.addMeshes(poolGeometry, poolTransform, DRAW_ANIMATED);
 
 	// ball - second transformation, inherits from pool
 	glm::mat4 ballTransform = poolTransform;
@@ -996,21 +1342,9 @@ void renderObjects::drawHandler::drawPoolMethod( float time, const glm::mat4& vi
 
 	ballTransform = ballTransform * ballLocalOffset;
 
-	// draw Ball
-	glUseProgram(shaderProgram.program);
-
+	// Ball
 	ballTransform = glm::scale(ballTransform, glm::vec3(1.0, 1.0, 1.0) * props["ball"].size);
-	uniSetter.setTransformUniforms(ballTransform, viewMatrix, projectionMatrix, shaderProgram);
-
-	for (int i = 0; i < ballGeometry.size(); i++) {
-
-		uniSetter.setMaterialUniforms(ballGeometry[i], shaderProgram, gameUni);
-
-		glBindVertexArray(ballGeometry[i]->vertexArrayObject);
-		glDrawElements(GL_TRIANGLES, ballGeometry[i]->numTriangles * 3, GL_UNSIGNED_INT, 0);
-	}
-	glBindVertexArray(0);
-	glUseProgram(0);
+	frameDrawList.addMeshes(ballGeometry, ballTransform, DRAW_ANIMATED);
 
 	// hat - third hierarchical transformation, inherits from ball, tilting and moving
 	glm::mat4 hatTransform = ballTransform;
@@ -1029,34 +1363,15 @@ void renderObjects::drawHandler::drawPoolMethod( float time, const glm::mat4& vi
 
 	hatTransform = hatTransform * localOffset * wobbleTilt;
 
-	//glm::mat4 localWobble = glm::translate(glm::mat4(1.0f), glm::vec3(tinySlideX, liftY, tinySlideZ));
-	//thirdBallTransform = thirdBallTransform * localWobble;
-
 	// Scale
 	hatTransform = glm::scale(hatTransform, glm::vec3(1.0, 1.0, 1.0) * (props["ball"].size));
 
-	// Draw hat
-	glUseProgram(shaderProgram.program);
-
-	uniSetter.setTransformUniforms(hatTransform, viewMatrix, projectionMatrix, shaderProgram);
-
-	for (int i = 0; i < hatGeometry.size(); i++) {
-
-		uniSetter.setMaterialUniforms(hatGeometry[i], shaderProgram, gameUni);
-
-		glBindVertexArray(hatGeometry[i]->vertexArrayObject);
-		glDrawElements(GL_TRIANGLES, hatGeometry[i]->numTriangles * 3, GL_UNSIGNED_INT, 0);
-	}
-	glBindVertexArray(0);
-	glUseProgram(0);
+	// hat
+	frameDrawList.addMeshes(hatGeometry, hatTransform, DRAW_ANIMATED);
 }
 
-// draw platform model
-void renderObjects::drawHandler::drawPlatform(ObjectProp platformProps, const glm::mat4& viewMatrix, SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni, const glm::mat4& projectionMatrix) {
-	//data texture
-	glUseProgram(shaderProgram.program);
-	uniSetter.setMaterialUniforms((*geometry), shaderProgram, gameUni);
-
+// add platform model, its geometry is not unitized so it is never culled
+void renderObjects::drawHandler::recordPlatform(const ObjectProp& platformProps) {
 	glm::mat4 modelMatrix;
 	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0, 1.0, 1.0) * platformProps.size);
 
@@ -1068,140 +1383,124 @@ void renderObjects::drawHandler::drawPlatform(ObjectProp platformProps, const gl
 		modelMatrix = glm::rotate(modelMatrix, platformProps.angle, platformProps.front);
 	}
 
-	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-
-
-	glBindTexture(GL_TEXTURE_CUBE_MAP, (*geometry)->texture);
-	glBindVertexArray((*geometry)->vertexArrayObject);
-	glDrawElements(GL_TRIANGLES, 3 * (*geometry)->numTriangles, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
-	glUseProgram(0);
-
-	return;
+	frameDrawList.add(platformGeometry, modelMatrix, DRAW_STATIC).radius = -1.0f;
 }
 
-// draw cube model
-void renderObjects::drawHandler::drawCube(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni, glm::vec3 cubePosition, float angle) {
-	glUseProgram(shaderProgram.program);
-	uniSetter.setMaterialUniforms((*geometry), shaderProgram, gameUni);
-
+// add cube model, drawn with two textures
+void renderObjects::drawHandler::recordCube(glm::vec3 cubePosition, float angle) {
 	glm::mat4 modelMatrix;
 	modelMatrix = splineHandler::alignObject(cubePosition, glm::vec3(0.4, 1.0, 0.0), glm::vec3(0.0f, 0.5f, 1.0f));
 	modelMatrix = glm::scale(modelMatrix, glm::vec3(0.2, 0.2, 0.2));
 	modelMatrix = glm::rotate(modelMatrix, angle, glm::vec3(1.0, 0.0, 0.0));
-	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-	//set material uniforms with two textures
-	glUniform3fv(shaderProgram.diffuseLocation, 1, glm::value_ptr(cubeGeometry->diffuse));
-	glUniform3fv(shaderProgram.ambientLocation, 1, glm::value_ptr(cubeGeometry->ambient));
-	glUniform3fv(shaderProgram.specularLocation, 1, glm::value_ptr(cubeGeometry->specular));
-	glUniform1f(shaderProgram.shininessLocation, cubeGeometry->shininess);
-
-
-	glUniform1i(shaderProgram.useTextureLocation, 1);
-	glUniform1i(shaderProgram.texSamplerLocation, 0);
-
-	if (cubeGeometry->secTex) {
-		glUniform1i(shaderProgram.secTextureLocation, 1);
-		glUniform1i(shaderProgram.texSampler2Location, 1);
-	}
-
-	glActiveTexture(GL_TEXTURE0 + 0);
-	glBindTexture(GL_TEXTURE_2D, cubeGeometry->texture);
-	glActiveTexture(GL_TEXTURE0 + 1);
-	glBindTexture(GL_TEXTURE_2D, cubeGeometry->secTex);
-
-	glBindVertexArray(cubeGeometry->vertexArrayObject);
-	glDrawElements(GL_TRIANGLES, cubeGeometry->numTriangles * 3, GL_UNSIGNED_INT, 0);
-
-	// to make sure we have texture only at cube
-	glUniform1i(shaderProgram.secTextureLocation, 0);
-	glBindVertexArray(0);
-	glUseProgram(0);
-	return;
+	frameDrawList.add(cubeGeometry, modelMatrix, DRAW_STATIC).secondTexture = true;
 }
 
-// draws tower model
-void renderObjects::drawHandler::drawTower(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni, glm::vec3 towerPosition) {
-	glUseProgram(shaderProgram.program);
-	uniSetter.setMaterialUniforms(*geometry, shaderProgram, gameUni);
-
+// add tower model
+void renderObjects::drawHandler::recordTower(glm::vec3 towerPosition) {
 	glm::mat4 modelMatrix;
 	modelMatrix = splineHandler::alignObject(towerPosition, glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0f, 0.0f, 1.0f));
 	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.5, 1.5, 1.5));
-	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-	glBindVertexArray((*geometry)->vertexArrayObject);
-	glDrawElements(GL_TRIANGLES, (*geometry)->numTriangles * 3, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-	glUseProgram(0);
-	return;
+	frameDrawList.add(towerGeometry, modelMatrix, DRAW_STATIC);
 }
 
-// draw sphere model
-void renderObjects::drawHandler::drawSphere(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni, glm::vec3 spherePosition) {
-	glUseProgram(shaderProgram.program);
-	uniSetter.setMaterialUniforms( (*geometry), shaderProgram, gameUni);
-
+// add sphere model, v=1
+void renderObjects::drawHandler::recordSphere(glm::vec3 spherePosition) {
 	glm::mat4 modelMatrix;
 	modelMatrix = splineHandler::alignObject(spherePosition, glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0f, 0.0f, 1.0f));
 	modelMatrix = glm::scale(modelMatrix, glm::vec3(0.05, 0.05, 0.05));
-	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-	glBindVertexArray((*geometry)->vertexArrayObject);
-	glDrawElements(GL_TRIANGLES, (*geometry)->numTriangles * 3, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-	glUseProgram(0);
-	return;
+	frameDrawList.add(sphereGeometry, modelMatrix, DRAW_STATIC, 1);
 }
 
-// draw house model
-void renderObjects::drawHandler::drawHouse(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni, glm::vec3 houePosition) {
-	glUseProgram(shaderProgram.program);
-	uniSetter.setMaterialUniforms( (*geometry), shaderProgram, gameUni);
-
+// add house model
+void renderObjects::drawHandler::recordHouse(glm::vec3 housePosition) {
 	glm::mat4 modelMatrix;
 	modelMatrix = splineHandler::alignObject(housePosition, glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0f, 0.0f, 1.0f));
 	modelMatrix = glm::scale(modelMatrix, glm::vec3(0.7, 0.7, 0.7));
 	modelMatrix = glm::rotate(modelMatrix, 4.7f, glm::vec3(1.0, 0.0, 0.0));
 	modelMatrix = glm::rotate(modelMatrix, 4.7f, glm::vec3(0.0, 0.0, 1.0));
-	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-	glBindVertexArray((*geometry)->vertexArrayObject);
-	glDrawElements(GL_TRIANGLES, (*geometry)->numTriangles * 3, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-	glUseProgram(0);
-	return;
+	frameDrawList.add(houseGeometry, modelMatrix, DRAW_STATIC);
 }
 
-// draw duck
-void renderObjects::drawHandler::drawDuck(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, GameUniformVariables gameUni, ObjectProp param, glm::vec3 position, glm::vec3 dir) {
-	glUseProgram(shaderProgram.program);
-
+// add duck, v=2
+void renderObjects::drawHandler::recordDuck(const ObjectProp& param, glm::vec3 position, glm::vec3 dir) {
 	glm::mat4 modelMatrix = splineHandler::alignObject(position,
 		dir, glm::vec3(0.0f, 0.0f, 1.0f));
 
 	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0, 1.0, 1.0) * param.size);
-	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-	for (int i = 0; i < duckGeometry.size(); i++) {
+	frameDrawList.addMeshes(duckGeometry, modelMatrix, DRAW_ANIMATED, 2);
+}
 
-		uniSetter.setMaterialUniforms( duckGeometry[i], shaderProgram, gameUni);
-		glBindVertexArray(duckGeometry[i]->vertexArrayObject);
-		glDrawElements(GL_TRIANGLES, duckGeometry[i]->numTriangles * 3, GL_UNSIGNED_INT, 0);
-	}
-	glBindVertexArray(0);
-	glUseProgram(0);
+// add maxwell, v=3
+void renderObjects::drawHandler::recordMaxwell(const ObjectProp& param, glm::vec3 position, glm::vec3 dir) {
+	glm::mat4 modelMatrix = splineHandler::alignObject(position, dir, glm::vec3(0.0f, 0.0f, 1.0f));
+	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0, 1.0, 1.0) * param.size);
+	frameDrawList.addMeshes(maxwellGeometry, modelMatrix, DRAW_ANIMATED, 3);
 }
 
-void renderObjects::drawHandler::drawMaxwell(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, GameUniformVariables gameUni, ObjectProp param, glm::vec3 position, glm::vec3 dir) {
+// draws recorded meshes of the given groups for one pass, only the pass block and
+// per mesh model and material change between passes, frustum NULL draws everything -
+// visible items and their sort keys are scratch of the frame arena
+void renderObjects::drawHandler::replayDrawList(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const viewFrustum* frustum, int groups) {
+	passBlock.setPass(viewMatrix, projectionMatrix);
+
+	arenaVector<DrawKey> visible;
+	visible.reserve(frameDrawList.size());
+	for (size_t i = 0; i < frameDrawList.size(); i++) {
+		const DrawItem& item = frameDrawList[i];
+		if ((item.group & groups) == 0)
+			continue;
+		if (frustum != NULL && item.radius >= 0.0f && !frustum->containsSphere(item.center, item.radius))
+			continue;
+		DrawKey key = { ((unsigned long long)item.stencil << 32) | item.geometry->vertexArrayObject, (unsigned int)i };
+		visible.push_back(key);
+	}
+	std::sort(visible.begin(), visible.end());
+
 	glUseProgram(shaderProgram.program);
+	glUniform1f(shaderProgram.timeLocation, renderFrame.time);
+	uniSetter.setFrameUniforms(shaderProgram, gameUniVars);
+
+	int stencil = 0;
+	MeshGeometry* geometry = NULL;
+	for (size_t i = 0; i < visible.size(); i++) {
+		const DrawItem& item = frameDrawList[visible[i].item];
+		if (item.stencil != stencil) {
+			if (item.stencil != 0) {
+				glEnable(GL_STENCIL_TEST);
+				glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+				glStencilFunc(GL_ALWAYS, item.stencil, -1);
+			}
+			else {
+				glDisable(GL_STENCIL_TEST);
+			}
+			stencil = item.stencil;
+		}
 
-	glm::mat4 modelMatrix = splineHandler::alignObject(position, dir, glm::vec3(0.0f, 0.0f, 1.0f));
-	modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0, 1.0, 1.0) * param.size);
-	uniSetter.setTransformUniforms(modelMatrix, viewMatrix, projectionMatrix, shaderProgram);
-	for (int i = 0; i < maxwellGeometry.size(); i++) {
+		uniSetter.setModelUniforms(item.modelMatrix, item.normalMatrix, shaderProgram);
+		if (item.geometry != geometry) {
+			uniSetter.setMeshUniforms(item.geometry, shaderProgram);
+			glBindVertexArray(item.geometry->vertexArrayObject);
+			geometry = item.geometry;
+		}
 
-		uniSetter.setMaterialUniforms(maxwellGeometry[i], shaderProgram, gameUni);
-		glBindVertexArray(maxwellGeometry[i]->vertexArrayObject);
-		glDrawElements(GL_TRIANGLES, maxwellGeometry[i]->numTriangles * 3, GL_UNSIGNED_INT, 0);
+		//set material uniforms with two textures
+		if (item.secondTexture && item.geometry->secTex) {
+			glUniform1i(shaderProgram.secTextureLocation, 1);
+			glUniform1i(shaderProgram.texSampler2Location, 1);
+			glActiveTexture(GL_TEXTURE0 + 1);
+			glBindTexture(GL_TEXTURE_2D, item.geometry->secTex);
+			glActiveTexture(GL_TEXTURE0 + 0);
+		}
+
+		glDrawElements(GL_TRIANGLES, item.geometry->numTriangles * 3, GL_UNSIGNED_INT, 0);
+		renderCounters.drawCalls++;
+		renderCounters.triangles += item.geometry->numTriangles;
+
+		// to make sure we have texture only at cube
+		if (item.secondTexture)
+			glUniform1i(shaderProgram.secTextureLocation, 0);
 	}
+	glDisable(GL_STENCIL_TEST);
 	glBindVertexArray(0);
 	glUseProgram(0);
 }
@@ -1234,6 +1533,8 @@ void renderObjects::drawHandler::drawExplosionMet(const glm::mat4& viewMatrix, c
 	glBindVertexArray((*geometry)->vertexArrayObject);
 	glBindTexture(GL_TEXTURE_2D, (*geometry)->texture);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, (*geometry)->numTriangles);
+	renderCounters.drawCalls++;
+	renderCounters.triangles += (*geometry)->numTriangles - 2;
 	glBindVertexArray(0);
 
 	glUseProgram(0);
@@ -1246,27 +1547,10 @@ void renderObjects::drawHandler::drawExplosion(const glm::mat4& viewMatrix, cons
 }
 
 // draw all models and animations
-void renderObjects::drawHandler::drawEverything(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, bool drawWaterBool, std::map<std::string, ObjectProp> loadProps, waterBufferMaker* waterFBOHandler) {
-	//glStencilFunc(GL_ALWAYS, 0, -1);
-	drawSkybox(viewMatrix, projectionMatrix, skyboxShader, &skyboxGeometry, gameUniVars);
-	drawTower(viewMatrix, projectionMatrix, shaderProgram, &towerGeometry, gameUniVars, towerPosition);
-	drawCube(viewMatrix, projectionMatrix, shaderProgram, &cubeGeometry, gameUniVars, cubePosition, 8.0f);
-	drawCube(viewMatrix, projectionMatrix, shaderProgram, &cubeGeometry, gameUniVars, cube2Position, 3.0f);
-	drawCube(viewMatrix, projectionMatrix, shaderProgram, &cubeGeometry, gameUniVars, cube3Position, 11.0f);
-	//glStencilFunc(GL_ALWAYS, 3, -1);
-	drawObject(viewMatrix, projectionMatrix, shaderProgram, &maxwellGeometry, gameUniVars, loadProps["maxwell2"]);
-	//glDisable(GL_STENCIL_TEST);
-	drawPlatform(loadProps["platform"], viewMatrix, shaderProgram, &platformGeometry, gameUniVars, projectionMatrix);
-	drawObject(viewMatrix, projectionMatrix, shaderProgram, &duckGeometry, gameUniVars, loadProps["duck2"]);
-	drawObject(viewMatrix, projectionMatrix, shaderProgram, &duckGeometry, gameUniVars, loadProps["duck3"]);
-	drawObject(viewMatrix, projectionMatrix, shaderProgram, &balloonGeometry, gameUniVars, loadProps["balloon"]);
-	drawObject(viewMatrix, projectionMatrix, shaderProgram, &boatGeometry, gameUniVars, loadProps["boat"]);
-	drawHouse(viewMatrix, projectionMatrix, shaderProgram, &houseGeometry, gameUniVars, housePosition);
-	glEnable(GL_STENCIL_TEST);
-	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-	glStencilFunc(GL_ALWAYS, 1, -1);
-	drawSphere(viewMatrix, projectionMatrix, shaderProgram, &sphereGeometry, gameUniVars, spherePosition);
-	glDisable(GL_STENCIL_TEST);
+void renderObjects::drawHandler::drawEverything(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const viewFrustum* frustum, bool drawWaterBool, waterBufferMaker* waterFBOHandler) {
+	if (!layeredPass) // layers get the skybox one by one before the pass
+		drawSkybox(viewMatrix, projectionMatrix, skyboxShader, &skyboxGeometry, gameUniVars);
+	replayDrawList(viewMatrix, projectionMatrix, frustum, DRAW_ALL);
 
 	if (drawWaterBool) {
 		drawWater(viewMatrix, projectionMatrix, waterShader, &waterGeometry, gameUniVars, waterFBOHandler);
@@ -1283,7 +1567,10 @@ void renderObjects::cleanupShaderPrograms(void) {
 	pgr::deleteProgramAndShaders(waterShader.program);
 	pgr::deleteProgramAndShaders(bannerShaderProgram.program);
 	pgr::deleteProgramAndShaders(explosionShader.program);
-	pgr::deleteProgramAndShaders(barShaderProgram.program);
+	pgr::deleteProgramAndShaders(rippleShader.program);
+	if (layeredShader.program)
+		pgr::deleteProgramAndShaders(layeredShader.program);
+	passBlock.cleanUp();
 
 }
 
@@ -1301,13 +1588,19 @@ void cleanupGeometry(MeshGeometry* geometry) {
 
 // clean model's geometry
 void renderObjects::cleanupModels() {
+	ocean.shutdown();
+	oceanMaps.cleanUp();
+	probe.cleanUp();
+	ripples.cleanUp();
+	waterVisible.cleanUp();
 	cleanupGeometry(towerGeometry);
 	cleanupGeometry(skyboxGeometry);
 	cleanupGeometry(waterGeometry);
 	cleanupGeometry(houseGeometry);
 	cleanupGeometry(cubeGeometry);
 	cleanupGeometry(sphereGeometry);
-	cleanupGeometry(barGeometry);
+	glDeleteTextures(1, &loadingBarTexture);
+	overlayBatch.cleanUp();
 	std::vector<MeshGeometry*> v = maxwellGeometry;
 	for (std::vector<MeshGeometry*>::iterator it = v.begin(); it != v.end(); ++it) {
 		cleanupGeometry(*it);
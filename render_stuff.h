@@ -20,7 +20,16 @@
 #include "setUni.h"
 #include "spline.h"
 #include "water.h"
+#include "oceanFFT.h"
+#include "ripple.h"
+#include "buoyancy.h"
+#include "jobSystem.h"
+#include "frameStream.h"
+#include "drawList.h"
 #include "model.h"
+#include "profiler.h"
+#include "hud.h"
+#include "startupTimer.h"
 
 class renderObjects {
 public:
@@ -36,11 +45,14 @@ public:
 		bool loadSingleMesh(const std::string& fileName, SCommonShaderProgram& shader, MeshGeometry** geometry);
 		bool loadMesh(const std::string& fileName, SCommonShaderProgram& shader, std::vector<MeshGeometry*>* geometryFull);
 		void initMaterial(MeshGeometry** geometry, Material material);
-		void initBarGeometry(GLuint shader, MeshGeometry** geometry);
 		void initSkyboxGeometry(skyboxFarPlaneShaderProgram  skyboxShader, MeshGeometry** geometry);
 		void initWater(SCommonShaderProgram& shader, MeshGeometry** geometry, waterBufferMaker* waterFBOHandler);
 		void initplatformGeometry(SCommonShaderProgram& shader, MeshGeometry** geometry);
 		void initExplosion(ExplosionShaderProgram& explosionShader, MeshGeometry** geometry);
+		void initOcean(const GameSettings& settings);
+		void initReflectionProbe(const GameSettings& settings);
+		void initRipples();
+		void initBuoyancy(std::map<std::string, ObjectProp>& loadProps);
 
 		void initializeShaderPrograms();
 
@@ -58,30 +70,36 @@ public:
 	public:
 		void drawSkybox(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
 			skyboxFarPlaneShaderProgram& skyboxShader, MeshGeometry** geometry, GameUniformVariables gameUni);
-		void drawTower(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
-			SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni,
-			glm::vec3 towerPosition);
-		void drawCube(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
-			SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni,
-			glm::vec3 cubePosition, float angle);
-		void drawSphere(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix,
-			SCommonShaderProgram& shaderProgram, MeshGeometry** geometry, GameUniformVariables gameUni, glm::vec3 spherePosition);
-		void drawObject(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram,
-			std::vector<MeshGeometry*>* geometry, GameUniformVariables gameUni, ObjectProp param);
 		void drawWater(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, 
 			MeshGeometry** geometry, GameUniformVariables gameUni, waterBufferMaker* waterFBOHandler);
-		void drawEverything(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, bool drawWaterBool, std::map<std::string, ObjectProp> loadProps, waterBufferMaker* waterFBOHandler);
-		void drawDuck(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, GameUniformVariables gameUni, ObjectProp param, glm::vec3 position, glm::vec3 dir);
-		void drawMaxwell(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, GameUniformVariables gameUni, ObjectProp param, glm::vec3 position, glm::vec3 dir);
+		void drawEverything(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const viewFrustum* frustum, bool drawWaterBool, waterBufferMaker* waterFBOHandler);
 		void drawExplosion(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, Explosion* explosion);
-		void drawBar(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, float loadingBarWidth);
-		void drawHouse(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram, 
-			MeshGeometry** geometry, GameUniformVariables gameUni, glm::vec3 houePosition);
-		void drawPlatform(ObjectProp platformProps, const glm::mat4& viewMatrix, SCommonShaderProgram& shaderProgram,
-			MeshGeometry** geometry, GameUniformVariables gameUni, const glm::mat4& projectionMatrix);
-		void drawPoolMethod( float time, const glm::mat4& viewMatrix, SCommonShaderProgram& shaderProgram, 
-			Object* poolObj, Object* ballObj, GameUniformVariables gameUni, std::map<std::string, ObjectProp>& props, const glm::mat4& projectionMatrix);
+		void drawOverlay(float loadingBarWidth, passTimer& passes);
 		void drawExplosionMet(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, ExplosionShaderProgram& explosionShader, Explosion* explosion, MeshGeometry** geometry);
+		void updateOcean(float time);
+		void updateReflectionProbe();
+		void updateRipples(float time);
+		void drawSky(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+		bool layeredWaterActive(waterBufferMaker* waterFBOHandler);
+		void beginLayeredPass(const glm::mat4& reflectionView, const glm::mat4& refractionView, const glm::mat4& projectionMatrix);
+		void endLayeredPass();
+		void prepareWaterMesh(const glm::vec3& cameraPosition);
+		void finishWaterMesh();
+
+		// draw list of the frame
+		void beginDrawList();
+		void recordStaticScene(std::map<std::string, ObjectProp>& loadProps);
+		void recordModelProps(std::map<std::string, ObjectProp>& loadProps);
+		void recordTower(glm::vec3 towerPosition);
+		void recordCube(glm::vec3 cubePosition, float angle);
+		void recordSphere(glm::vec3 spherePosition);
+		void recordHouse(glm::vec3 housePosition);
+		void recordPlatform(const ObjectProp& platformProps);
+		void recordObject(std::vector<MeshGeometry*>* geometry, const ObjectProp& param, int group);
+		void recordDuck(const ObjectProp& param, glm::vec3 position, glm::vec3 dir);
+		void recordMaxwell(const ObjectProp& param, glm::vec3 position, glm::vec3 dir);
+		void recordPool(float time, Object* poolObj, std::map<std::string, ObjectProp>& props);
+		void replayDrawList(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const viewFrustum* frustum, int groups);
 	};
 
 	void cleanupShaderPrograms();
@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       ripple.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/6
+ * \brief      Interactive ripples - wave equation steps in ping-pong framebuffers,
+ *				256x256 step is one full screen quad
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "ripple.h"
+#include "glCounters.h"
+
+void rippleSimulator::init(RippleShaderProgram* rippleShader) {
+	cleanUp();
+	shader = rippleShader;
+
+	for (int i = 0; i < 2; i++) {
+		glGenTextures(1, &textures[i]);
+		glBindTexture(GL_TEXTURE_2D, textures[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, RIPPLE_RESOLUTION, RIPPLE_RESOLUTION, 0, GL_RG, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glGenFramebuffers(1, &frameBuffers[i]);
+		glBindFramebuffer(GL_FRAMEBUFFER, frameBuffers[i]);
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textures[i], 0);
+		glDrawBuffer(GL_COLOR_ATTACHMENT0);
+		// still water, clear color of the scene stays untouched
+		const GLfloat zero[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		glClearBufferfv(GL_COLOR, 0, zero);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	const float quad[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+	glGenVertexArrays(1, &quadVAO);
+	glBindVertexArray(quadVAO);
+	glGenBuffers(1, &quadVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(shader->posLocation);
+	glVertexAttribPointer(shader->posLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glBindVertexArray(0);
+
+	current = 0;
+	lastTime = -1.0f;
+	accumulator = 0.0f;
+	drops.clear();
+	CHECK_GL_ERROR();
+}
+
+// drop in world coordinates, negative strength pushes the water down
+void rippleSimulator::addDrop(const glm::vec2& worldPosition, float radius, float strength) {
+	glm::vec2 mapPosition = worldPosition / RIPPLE_AREA + glm::vec2(0.5f);
+	if (mapPosition.x < 0.0f || mapPosition.x > 1.0f || mapPosition.y < 0.0f || mapPosition.y > 1.0f)
+		return;
+	if ((int)drops.size() >= RIPPLE_MAX_DROPS)
+		return;
+	drops.push_back(glm::vec4(mapPosition.x, mapPosition.y, radius / RIPPLE_AREA, strength));
+}
+
+// run fixed steps for time passed since last call
+void rippleSimulator::update(float time) {
+	if (shader == NULL)
+		return;
+	if (lastTime < 0.0f)
+		lastTime = time;
+	accumulator += time - lastTime;
+	lastTime = time;
+
+	int steps = 0;
+	while (accumulator >= RIPPLE_STEP && steps < RIPPLE_MAX_STEPS) {
+		step();
+		accumulator -= RIPPLE_STEP;
+		steps++;
+	}
+	if (steps == RIPPLE_MAX_STEPS)
+		accumulator = 0.0f;
+}
+
+void rippleSimulator::step() {
+	int target = 1 - current;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffers[target]);
+	glViewport(0, 0, RIPPLE_RESOLUTION, RIPPLE_RESOLUTION);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glUseProgram(shader->program);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, textures[current]);
+	glUniform1i(shader->heightMapLocation, 0);
+	glUniform2f(shader->texelSizeLocation, 1.0f / RIPPLE_RESOLUTION, 1.0f / RIPPLE_RESOLUTION);
+	glUniform1f(shader->dampingLocation, RIPPLE_DAMPING);
+	glUniform1i(shader->dropCountLocation, (GLint)drops.size());
+	if (!drops.empty())
+		glUniform4fv(shader->dropsLocation, (GLsizei)drops.size(), glm::value_ptr(drops[0]));
+	drops.clear();
+
+	glBindVertexArray(quadVAO);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glUseProgram(0);
+
+	glEnable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	current = target;
+}
+
+void rippleSimulator::cleanUp() {
+	for (int i = 0; i < 2; i++) {
+		if (frameBuffers[i])
+			glDeleteFramebuffers(1, &frameBuffers[i]);
+		if (textures[i])
+			glDeleteTextures(1, &textures[i]);
+		frameBuffers[i] = 0;
+		textures[i] = 0;
+	}
+	if (quadVAO)
+		glDeleteVertexArrays(1, &quadVAO);
+	if (quadVBO)
+		glDeleteBuffers(1, &quadVBO);
+	quadVAO = 0;
+	quadVBO = 0;
+	shader = NULL;
+}
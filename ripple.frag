@@ -0,0 +1,34 @@
+#version 140
+
+const int MAX_DROPS = 8;
+const float PI = 3.14159265;
+
+uniform sampler2D heightMap;   // r = current height, g = previous height
+uniform vec2 texelSize;        // 1 / map resolution
+uniform float damping;         // energy kept after one step
+
+uniform int dropCount;
+uniform vec4 drops[MAX_DROPS]; // xy = center in map, z = radius in map, w = strength
+
+smooth in vec2 texCoord_v;
+
+out vec4 color_f;
+
+void main() {
+		vec2 height = texture(heightMap, texCoord_v).rg;
+
+		// discrete wave equation, edges reflect the waves
+		float neighbours = texture(heightMap, texCoord_v + vec2(texelSize.x, 0.0)).r
+						 + texture(heightMap, texCoord_v - vec2(texelSize.x, 0.0)).r
+						 + texture(heightMap, texCoord_v + vec2(0.0, texelSize.y)).r
+						 + texture(heightMap, texCoord_v - vec2(0.0, texelSize.y)).r;
+		float next = (neighbours * 0.5 - height.g) * damping;
+
+		for (int i = 0; i < dropCount; i++) {
+				float d = distance(texCoord_v, drops[i].xy) / drops[i].z;
+				if (d < 1.0)
+						next += drops[i].w * (cos(d * PI) * 0.5 + 0.5);
+		}
+
+		color_f = vec4(next, height.r, 0.0, 1.0);
+}
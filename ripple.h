@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       ripple.h
+ * \author     rka Prokopov
+ * \date       2025/5/6
+ * \brief      Interactive ripples - height field simulated on GPU in two textures
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __RIPPLE_H
+#define __RIPPLE_H
+
+#include "pgr.h"
+#include <vector>
+#include "utilStructures.h"
+
+const int RIPPLE_RESOLUTION = 256;
+const float RIPPLE_AREA = 8.0f;            // world size of simulated square around the lake center
+const float RIPPLE_STEP = 1.0f / 60.0f;    // fixed simulation step in seconds
+const int RIPPLE_MAX_STEPS = 4;            // steps per frame, slow frames slow the ripples down
+const int RIPPLE_MAX_DROPS = 8;            // has to match ripple.frag
+const float RIPPLE_DAMPING = 0.985f;
+
+/// <summary>
+/// height field ripples, every step reads one texture and writes the other one,
+/// drops are added in the next step
+/// </summary>
+class rippleSimulator {
+public:
+	rippleSimulator() : shader(NULL), current(0), quadVAO(0), quadVBO(0), lastTime(-1.0f), accumulator(0.0f) {
+		textures[0] = textures[1] = 0;
+		frameBuffers[0] = frameBuffers[1] = 0;
+	}
+
+	void init(RippleShaderProgram* rippleShader);
+	void addDrop(const glm::vec2& worldPosition, float radius, float strength);
+	void update(float time);
+	void cleanUp();
+	GLuint getHeightTexture() { return textures[current]; }
+
+private:
+	void step();
+
+	RippleShaderProgram* shader;
+	GLuint textures[2];
+	GLuint frameBuffers[2];
+	int current;              // texture with the newest heights
+	GLuint quadVAO;
+	GLuint quadVBO;
+	float lastTime;
+	float accumulator;
+	std::vector<glm::vec4> drops;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#version 140
+
+in vec2 position;           // corner of full screen quad
+
+smooth out vec2 texCoord_v; // position in height map
+
+void main() {
+  texCoord_v = position * 0.5 + 0.5;
+  gl_Position = vec4(position, 0.0, 1.0);
+}
@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       sceneGenerator.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/21
+ * \brief      Synthetic config files with many props for scaling benchmarks
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "sceneGenerator.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// meshes a generated prop can use, same names as the model key of config.txt
+static const char* SCENE_MODELS[] = { "duck", "balloon", "boat", "maxwell", "pool", "ball", "hat" };
+const int SCENE_MODEL_COUNT = sizeof(SCENE_MODELS) / sizeof(SCENE_MODELS[0]);
+const float SCENE_TWO_PI = 6.2831853f;
+
+const char* sceneGenerator::getDistributionName(int distribution) {
+	static const char* names[SCENE_DISTRIBUTION_COUNT] = { "uniform", "ring", "cluster", "grid" };
+	return names[distribution];
+}
+
+int sceneGenerator::parseDistribution(const std::string& name) {
+	for (int distribution = 0; distribution < SCENE_DISTRIBUTION_COUNT; distribution++)
+		if (name == getDistributionName(distribution))
+			return distribution;
+	return -1;
+}
+
+bool sceneGenerator::write(const std::string& fileName, const std::string& baseConfig, const SceneLayout& layout) {
+	// the hand placed props stay, the scene keeps working with the generated ones added
+	std::ifstream base(baseConfig);
+	if (!base.is_open()) {
+		std::cerr << "Error: file '" << baseConfig << "' is unable to load" << std::endl;
+		return false;
+	}
+	std::ofstream file(fileName);
+	if (!file.is_open()) {
+		std::cerr << "Error: file '" << fileName << "' cannot be written" << std::endl;
+		return false;
+	}
+	file << base.rdbuf() << "\n";
+
+	std::mt19937 random(layout.seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> spread(0.0f, layout.radius * 0.08f);
+
+	std::vector<float> centerX(layout.clusters), centerY(layout.clusters);
+	for (int i = 0; i < layout.clusters; i++) {
+		float distance = layout.radius * 0.85f * sqrt(unit(random));
+		float angle = SCENE_TWO_PI * unit(random);
+		centerX[i] = distance * cos(angle);
+		centerY[i] = distance * sin(angle);
+	}
+	int gridSide = (int)ceil(sqrt((double)layout.count));
+
+	file << std::fixed << std::setprecision(4);
+	for (int i = 0; i < layout.count; i++) {
+		float x = 0.0f, y = 0.0f;
+		if (layout.distribution == SCENE_RING) {
+			float distance = layout.radius * (0.8f + 0.2f * unit(random));
+			float angle = SCENE_TWO_PI * unit(random);
+			x = distance * cos(angle);
+			y = distance * sin(angle);
+		}
+		else if (layout.distribution == SCENE_CLUSTER) {
+			int cluster = i % layout.clusters;
+			x = centerX[cluster] + spread(random);
+			y = centerY[cluster] + spread(random);
+		}
+		else if (layout.distribution == SCENE_GRID) {
+			float step = 2.0f * layout.radius / gridSide;
+			x = -layout.radius + step * (i % gridSide + 0.5f);
+			y = -layout.radius + step * (i / gridSide + 0.5f);
+		}
+		else {
+			// square root keeps the density even over the disc
+			float distance = layout.radius * sqrt(unit(random));
+			float angle = SCENE_TWO_PI * unit(random);
+			x = distance * cos(angle);
+			y = distance * sin(angle);
+		}
+		float heading = SCENE_TWO_PI * unit(random);
+
+		file << "[generated" << i << "]\n"
+			<< "model=" << SCENE_MODELS[random() % SCENE_MODEL_COUNT] << "\n"
+			<< "front=" << cos(heading) << "," << sin(heading) << ",0.0\n"
+			<< "up=0.0,0.0,1.0\n"
+			<< "position=" << x << "," << y << "," << layout.height << "\n"
+			<< "size=" << layout.minSize + (layout.maxSize - layout.minSize) * unit(random) << "\n"
+			<< "angle=0.0\n"
+			<< "align=true\n";
+		if (unit(random) < layout.floatingShare)
+			file << "float=true\n";
+		file << "\n";
+	}
+	return file.good();
+}
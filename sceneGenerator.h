@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       sceneGenerator.h
+ * \author     rka Prokopov
+ * \date       2025/5/21
+ * \brief      Synthetic config files with many props for scaling benchmarks, used by
+ *				tools/sceneGenerator and the --sweep benchmark
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __SCENE_GENERATOR_H
+#define __SCENE_GENERATOR_H
+
+#include <string>
+
+// how the props are spread around the lake
+enum {
+	SCENE_UNIFORM,     // evenly over the whole disc
+	SCENE_RING,        // along the shore
+	SCENE_CLUSTER,     // gaussian groups
+	SCENE_GRID,        // regular rows, no overlaps
+	SCENE_DISTRIBUTION_COUNT
+};
+
+// parameters of one generated scene
+typedef struct SceneLayout {
+	int count = 1000;
+	int distribution = SCENE_UNIFORM;
+	unsigned int seed = 1;
+	float radius = 2.8f;          // props stay inside the camera borders
+	float height = 1.1f;          // water level, WATER_Z
+	float minSize = 0.04f;
+	float maxSize = 0.12f;
+	float floatingShare = 0.0f;   // part of the props with a buoyancy body
+	int clusters = 16;
+} SceneLayout;
+
+/// <summary>
+/// writes a base config followed by layout.count props named generatedN, each one uses
+/// a mesh of the existing model set through the model key
+/// </summary>
+class sceneGenerator {
+public:
+	static bool write(const std::string& fileName, const std::string& baseConfig, const SceneLayout& layout);
+
+	static int parseDistribution(const std::string& name);   // -1 when unknown
+	static const char* getDistributionName(int distribution);
+};
+
+#endif
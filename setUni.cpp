@@ -9,6 +9,8 @@
 //-----------------------------------------------------------------------------------------
 #include "pgr.h"
 #include "setUni.h"
+#include "transform.h"
+#include "glCounters.h"
 
 void setUniforms::setLightUniforms(  Light & light, LightLocation & location ) {
 	glUniform3fv(location.ambient, 1, glm::value_ptr(light.ambient));
@@ -22,11 +24,12 @@ void setUniforms::setLightUniforms(  Light & light, LightLocation & location ) {
 
 // function to set material uniforms
 void setUniforms::setMaterialUniforms( MeshGeometry* geometry, SCommonShaderProgram& shaderProgram, GameUniformVariables gameUni) {
+	setFrameUniforms(shaderProgram, gameUni);
+	setMeshUniforms(geometry, shaderProgram);
+}
 
-	glUniform3fv(shaderProgram.diffuseLocation, 1, glm::value_ptr(geometry->diffuse));  // 2nd parameter must be 1 - it declares number of vectors in the vector array
-	glUniform3fv(shaderProgram.ambientLocation, 1, glm::value_ptr(geometry->ambient));
-	glUniform3fv(shaderProgram.specularLocation, 1, glm::value_ptr(geometry->specular));
-	glUniform1f(shaderProgram.shininessLocation, geometry->shininess);
+// uniforms which are the same for every mesh of the pass
+void setUniforms::setFrameUniforms(SCommonShaderProgram& shaderProgram, const GameUniformVariables& gameUni) {
 	glUniform1i(shaderProgram.isFogLocation, gameUni.isFog);
 	glUniform1i(shaderProgram.spotLightLocation, gameUni.spotLight);
 	glUniform1f(shaderProgram.pointLightIntensityLocation, gameUni.pointLightIntensity);
@@ -34,6 +37,14 @@ void setUniforms::setMaterialUniforms( MeshGeometry* geometry, SCommonShaderProg
 	//--- reflector ---
 	glUniform3fv(shaderProgram.reflectorPositionLocation, 1, glm::value_ptr(gameUni.reflectorPositionLocation));
 	glUniform3fv(shaderProgram.reflectorDirectionLocation, 1, glm::value_ptr(gameUni.reflectorDirectionLocation));
+}
+
+// material and texture of one mesh
+void setUniforms::setMeshUniforms(MeshGeometry* geometry, SCommonShaderProgram& shaderProgram) {
+	glUniform3fv(shaderProgram.diffuseLocation, 1, glm::value_ptr(geometry->diffuse));  // 2nd parameter must be 1 - it declares number of vectors in the vector array
+	glUniform3fv(shaderProgram.ambientLocation, 1, glm::value_ptr(geometry->ambient));
+	glUniform3fv(shaderProgram.specularLocation, 1, glm::value_ptr(geometry->specular));
+	glUniform1f(shaderProgram.shininessLocation, geometry->shininess);
 
 	if (geometry->texture != 0) {
 		glUniform1i(shaderProgram.useTextureLocation, 1);
@@ -56,20 +67,22 @@ void setUniforms::setTransformUniforms(const glm::mat4& modelMatrix, const glm::
 	glUniformMatrix4fv(shaderProgram.VmatrixLocation, 1, GL_FALSE, glm::value_ptr(viewMatrix));
 	glUniformMatrix4fv(shaderProgram.MmatrixLocation, 1, GL_FALSE, glm::value_ptr(modelMatrix));
 
-	const glm::mat4 modelRotationMatrix = glm::mat4(
-		modelMatrix[0],
-		modelMatrix[1],
-		modelMatrix[2],
-		glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)
-	);
+	glm::mat4 normalMatrix = transformHandler::normalMatrix(modelMatrix);
+	glUniformMatrix4fv(shaderProgram.normalMatrixLocation, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+}
 
-	glm::mat4 normalMatrix = glm::transpose(glm::inverse(modelRotationMatrix));
-	glUniformMatrix4fv(shaderProgram.normalMatrixLocation, 1, GL_FALSE, glm::value_ptr(normalMatrix));  // correct matrix for non-rigid transform
+// model part of the transform, view and projection come from the pass uniform block
+void setUniforms::setModelUniforms(const glm::mat4& modelMatrix, const glm::mat4& normalMatrix, SCommonShaderProgram& shaderProgram) {
+	glUniformMatrix4fv(shaderProgram.MmatrixLocation, 1, GL_FALSE, glm::value_ptr(modelMatrix));
+	glUniformMatrix4fv(shaderProgram.normalMatrixLocation, 1, GL_FALSE, glm::value_ptr(normalMatrix));
 }
 
-void setUniforms::setWaterUni(SCommonShaderProgram& waterShader, GLfloat factor) {
+void setUniforms::setWaterUni(SCommonShaderProgram& waterShader, GLfloat factor, GLfloat oceanPatchSize) {
 	glUniform1i(waterShader.reflectionTextureLocation, 0);
 	glUniform1i(waterShader.refractionTextureLocation, 1);
 	glUniform1i(waterShader.dudvMapLocation, 2);
+	glUniform1i(waterShader.displacementMapLocation, 3);
+	glUniform1i(waterShader.normalMapLocation, 4);
 	glUniform1f(waterShader.moveFactorLocation, factor);
+	glUniform1f(waterShader.oceanPatchSizeLocation, oceanPatchSize);
 }
@@ -17,8 +17,11 @@ public:
 	setUniforms() = default;
 	void setLightUniforms(Light& light, LightLocation& location);
 	void setMaterialUniforms( MeshGeometry* geometry, SCommonShaderProgram& shaderProgram, GameUniformVariables gameUni);
+	void setFrameUniforms(SCommonShaderProgram& shaderProgram, const GameUniformVariables& gameUni);
+	void setMeshUniforms(MeshGeometry* geometry, SCommonShaderProgram& shaderProgram);
+	void setModelUniforms(const glm::mat4& modelMatrix, const glm::mat4& normalMatrix, SCommonShaderProgram& shaderProgram);
 	void setTransformUniforms(const glm::mat4& modelMatrix, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, SCommonShaderProgram& shaderProgram);
-	void setWaterUni(SCommonShaderProgram& shaderProgram, GLfloat factor);
+	void setWaterUni(SCommonShaderProgram& shaderProgram, GLfloat factor, GLfloat oceanPatchSize);
 };
 
 
@@ -0,0 +1,57 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       simulationClock.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/9
+ * \brief      Fixed step simulation time measured by monotonic clock
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "simulationClock.h"
+
+void fixedStepClock::start() {
+	origin = std::chrono::steady_clock::now();
+	stepCount = 0;
+	accumulator = 0.0;
+	lastTime = 0.0;
+	lastFrame = 0.0;
+	droppedTime = 0.0;
+	manualTime = 0.0;
+}
+
+double fixedStepClock::now() {
+	if (manual)
+		return manualTime;
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+}
+
+int fixedStepClock::advance() {
+	double time = now();
+	accumulator += time - lastTime;
+	lastTime = time;
+
+	// manual time is added in whole steps, rounding must not lose one
+	int steps = (int)(accumulator / SIMULATION_STEP + 1e-9);
+	if (steps > SIMULATION_MAX_STEPS) {
+		// after a long stall catch up only partly, the rest of the time is lost
+		droppedTime += (steps - SIMULATION_MAX_STEPS) * SIMULATION_STEP;
+		accumulator -= (steps - SIMULATION_MAX_STEPS) * SIMULATION_STEP;
+		steps = SIMULATION_MAX_STEPS;
+	}
+	accumulator -= steps * SIMULATION_STEP;
+	return steps;
+}
+
+double fixedStepClock::getRenderTime() {
+	if (stepCount == 0)
+		return 0.0;
+	return (stepCount - 1 + getAlpha()) * SIMULATION_STEP;
+}
+
+bool fixedStepClock::frameDue(int maxFrameRate) {
+	double time = now();
+	if (maxFrameRate > 0 && time - lastFrame < 1.0 / maxFrameRate)
+		return false;
+	lastFrame = time;
+	return true;
+}
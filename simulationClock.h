@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       simulationClock.h
+ * \author     rka Prokopov
+ * \date       2025/5/9
+ * \brief      Fixed step simulation time measured by monotonic clock
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __SIMULATION_CLOCK_H
+#define __SIMULATION_CLOCK_H
+
+#include <chrono>
+
+const double SIMULATION_STEP = 1.0 / 60.0;  // seconds of one simulation step
+const int SIMULATION_MAX_STEPS = 8;         // steps per frame, longer stalls slow the game down
+
+/// <summary>
+/// accumulates real time and hands it out in fixed steps, the remainder is the
+/// interpolation factor between the last two simulated states
+/// </summary>
+class fixedStepClock {
+public:
+	fixedStepClock() : stepCount(0), accumulator(0.0), lastTime(0.0), lastFrame(0.0), droppedTime(0.0),
+		manual(false), manualTime(0.0) {}
+
+	void start();
+	int advance();      // steps to simulate before the next frame
+	void tick() { stepCount++; }
+
+	double now();       // seconds since start
+	double getSimulationTime() { return stepCount * SIMULATION_STEP; }
+	double getRenderTime();   // between the last two steps
+	float getAlpha() { return (float)(accumulator / SIMULATION_STEP); }
+	double getDroppedTime() { return droppedTime; }
+
+	bool frameDue(int maxFrameRate);  // frame cap, 0 means no cap
+
+	// virtual time moved only by addTime, runs give the same steps regardless of speed
+	void setManual(bool enabled) { manual = enabled; manualTime = 0.0; }
+	void addTime(double seconds) { manualTime += seconds; }
+
+private:
+	std::chrono::steady_clock::time_point origin;
+	long long stepCount;
+	double accumulator;
+	double lastTime;
+	double lastFrame;
+	double droppedTime;   // real time thrown away after stalls
+	bool manual;
+	double manualTime;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#version 330 core
+
+in  vec2  vTexCoord;
+in  vec4  vColor;
+flat in float vMode;
+out vec4  color;
+
+uniform sampler2D glyphAtlas;   // coverage in the red channel
+uniform sampler2D image;
+
+void main() {
+    if (vMode < 0.5)
+        color = vec4(vColor.rgb, vColor.a * texture(glyphAtlas, vTexCoord).r);
+    else
+        color = vColor * texture(image, vTexCoord);
+
+    // alpha test
+    if (color.a < 0.01) discard;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 330 core
+
+in vec2 position;      // pixels from the top left corner
+in vec2 texCoord;
+in vec4 color;
+in float mode;         // 0 = glyph atlas, 1 = image
+
+uniform vec2 screenSize;
+
+out vec2  vTexCoord;
+out vec4  vColor;
+flat out float vMode;
+
+void main() {
+    gl_Position = vec4(position.x / screenSize.x * 2.0 - 1.0, 1.0 - position.y / screenSize.y * 2.0, 0.0, 1.0);
+    vTexCoord   = texCoord;
+    vColor      = color;
+    vMode       = mode;
+}
\ No newline at end of file
@@ -0,0 +1,270 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       spriteBatch.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/16
+ * \brief      Batched 2D quads and bitmap text for overlays, one buffer and one draw call
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "spriteBatch.h"
+#include <cstring>
+#include <cstddef>
+#include "glCounters.h"
+
+const int ATLAS_COLUMNS = 16;               // cells of 8x8 pixels for ASCII 32..127
+const int ATLAS_ROWS = 6;
+const int ATLAS_CELL = 8;
+const int ATLAS_WIDTH = ATLAS_COLUMNS * ATLAS_CELL;
+const int ATLAS_HEIGHT = ATLAS_ROWS * ATLAS_CELL;
+const unsigned char SOLID_CELL = 127;       // completely filled, used by rectangles
+
+// glyph as rows of pixels, lower case letters are drawn as upper case
+typedef struct FontGlyph {
+	char character;
+	const char* rows[FONT_GLYPH_HEIGHT];
+} FontGlyph;
+
+static const FontGlyph FONT_GLYPHS[] = {
+	{ '0', { ".###.", "#...#", "#..##", "#.#.#", "##..#", "#...#", ".###." } },
+	{ '1', { "..#..", ".##..", "..#..", "..#..", "..#..", "..#..", ".###." } },
+	{ '2', { ".###.", "#...#", "....#", "...#.", "..#..", ".#...", "#####" } },
+	{ '3', { "#####", "...#.", "..#..", "...#.", "....#", "#...#", ".###." } },
+	{ '4', { "...#.", "..##.", ".#.#.", "#..#.", "#####", "...#.", "...#." } },
+	{ '5', { "#####", "#....", "####.", "....#", "....#", "#...#", ".###." } },
+	{ '6', { "..##.", ".#...", "#....", "####.", "#...#", "#...#", ".###." } },
+	{ '7', { "#####", "....#", "...#.", "..#..", ".#...", ".#...", ".#..." } },
+	{ '8', { ".###.", "#...#", "#...#", ".###.", "#...#", "#...#", ".###." } },
+	{ '9', { ".###.", "#...#", "#...#", ".####", "....#", "...#.", ".##.." } },
+	{ 'A', { ".###.", "#...#", "#...#", "#####", "#...#", "#...#", "#...#" } },
+	{ 'B', { "####.", "#...#", "#...#", "####.", "#...#", "#...#", "####." } },
+	{ 'C', { ".###.", "#...#", "#....", "#....", "#....", "#...#", ".###." } },
+	{ 'D', { "###..", "#..#.", "#...#", "#...#", "#...#", "#..#.", "###.." } },
+	{ 'E', { "#####", "#....", "#....", "####.", "#....", "#....", "#####" } },
+	{ 'F', { "#####", "#....", "#....", "####.", "#....", "#....", "#...." } },
+	{ 'G', { ".###.", "#...#", "#....", "#.###", "#...#", "#...#", ".####" } },
+	{ 'H', { "#...#", "#...#", "#...#", "#####", "#...#", "#...#", "#...#" } },
+	{ 'I', { ".###.", "..#..", "..#..", "..#..", "..#..", "..#..", ".###." } },
+	{ 'J', { "..###", "...#.", "...#.", "...#.", "...#.", "#..#.", ".##.." } },
+	{ 'K', { "#...#", "#..#.", "#.#..", "##...", "#.#..", "#..#.", "#...#" } },
+	{ 'L', { "#....", "#....", "#....", "#....", "#....", "#....", "#####" } },
+	{ 'M', { "#...#", "##.##", "#.#.#", "#.#.#", "#...#", "#...#", "#...#" } },
+	{ 'N', { "#...#", "#...#", "##..#", "#.#.#", "#..##", "#...#", "#...#" } },
+	{ 'O', { ".###.", "#...#", "#...#", "#...#", "#...#", "#...#", ".###." } },
+	{ 'P', { "####.", "#...#", "#...#", "####.", "#....", "#....", "#...." } },
+	{ 'Q', { ".###.", "#...#", "#...#", "#...#", "#.#.#", "#..#.", ".##.#" } },
+	{ 'R', { "####.", "#...#", "#...#", "####.", "#.#..", "#..#.", "#...#" } },
+	{ 'S', { ".####", "#....", "#....", ".###.", "....#", "....#", "####." } },
+	{ 'T', { "#####", "..#..", "..#..", "..#..", "..#..", "..#..", "..#.." } },
+	{ 'U', { "#...#", "#...#", "#...#", "#...#", "#...#", "#...#", ".###." } },
+	{ 'V', { "#...#", "#...#", "#...#", "#...#", "#...#", ".#.#.", "..#.." } },
+	{ 'W', { "#...#", "#...#", "#...#", "#.#.#", "#.#.#", "#.#.#", ".#.#." } },
+	{ 'X', { "#...#", "#...#", ".#.#.", "..#..", ".#.#.", "#...#", "#...#" } },
+	{ 'Y', { "#...#", "#...#", ".#.#.", "..#..", "..#..", "..#..", "..#.." } },
+	{ 'Z', { "#####", "....#", "...#.", "..#..", ".#...", "#....", "#####" } },
+	{ '.', { ".....", ".....", ".....", ".....", ".....", ".##..", ".##.." } },
+	{ ',', { ".....", ".....", ".....", ".....", ".##..", "..#..", ".#..." } },
+	{ ':', { ".....", ".##..", ".##..", ".....", ".##..", ".##..", "....." } },
+	{ '/', { ".....", "....#", "...#.", "..#..", ".#...", "#....", "....." } },
+	{ '-', { ".....", ".....", ".....", "#####", ".....", ".....", "....." } },
+	{ '+', { ".....", "..#..", "..#..", "#####", "..#..", "..#..", "....." } },
+	{ '_', { ".....", ".....", ".....", ".....", ".....", ".....", "#####" } },
+	{ '%', { "##...", "##..#", "...#.", "..#..", ".#...", "#..##", "...##" } },
+	{ '(', { "...#.", "..#..", ".#...", ".#...", ".#...", "..#..", "...#." } },
+	{ ')', { ".#...", "..#..", "...#.", "...#.", "...#.", "..#..", ".#..." } },
+	{ '?', { ".###.", "#...#", "....#", "...#.", "..#..", ".....", "..#.." } },
+};
+
+static const char* SPRITE_VERTEX_SHADER = "sprite.vert";
+static const char* SPRITE_FRAGMENT_SHADER = "sprite.frag";
+
+// characters without a glyph are shown as '?'
+static unsigned char glyphCell(char character) {
+	if (character >= 'a' && character <= 'z')
+		character = character - 'a' + 'A';
+	for (size_t i = 0; i < sizeof(FONT_GLYPHS) / sizeof(FONT_GLYPHS[0]); i++) {
+		if (FONT_GLYPHS[i].character == character)
+			return (unsigned char)character;
+	}
+	return '?';
+}
+
+static glm::vec4 cellCoords(unsigned char cell, int width, int height) {
+	int column = (cell - 32) % ATLAS_COLUMNS;
+	int row = (cell - 32) / ATLAS_COLUMNS;
+	return glm::vec4((float)(column * ATLAS_CELL) / ATLAS_WIDTH, (float)(row * ATLAS_CELL) / ATLAS_HEIGHT,
+		(float)(column * ATLAS_CELL + width) / ATLAS_WIDTH, (float)(row * ATLAS_CELL + height) / ATLAS_HEIGHT);
+}
+
+void spriteBatch::createAtlas() {
+	std::vector<unsigned char> pixels(ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+	for (size_t i = 0; i < sizeof(FONT_GLYPHS) / sizeof(FONT_GLYPHS[0]); i++) {
+		int cell = FONT_GLYPHS[i].character - 32;
+		int x0 = (cell % ATLAS_COLUMNS) * ATLAS_CELL;
+		int y0 = (cell / ATLAS_COLUMNS) * ATLAS_CELL;
+		for (int y = 0; y < FONT_GLYPH_HEIGHT; y++)
+			for (int x = 0; x < FONT_GLYPH_WIDTH; x++)
+				if (FONT_GLYPHS[i].rows[y][x] == '#')
+					pixels[(y0 + y) * ATLAS_WIDTH + x0 + x] = 255;
+	}
+	int solid = SOLID_CELL - 32;
+	for (int y = 0; y < ATLAS_CELL; y++)
+		for (int x = 0; x < ATLAS_CELL; x++)
+			pixels[((solid / ATLAS_COLUMNS) * ATLAS_CELL + y) * ATLAS_WIDTH + (solid % ATLAS_COLUMNS) * ATLAS_CELL + x] = 255;
+
+	glGenTextures(1, &atlasTexture);
+	glBindTexture(GL_TEXTURE_2D, atlasTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	// glyphs are drawn at whole multiples of their size, no filtering
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void spriteBatch::init() {
+	cleanUp();
+
+	std::vector<GLuint> shaderList;
+	shaderList.push_back(pgr::createShaderFromFile(GL_VERTEX_SHADER, SPRITE_VERTEX_SHADER));
+	shaderList.push_back(pgr::createShaderFromFile(GL_FRAGMENT_SHADER, SPRITE_FRAGMENT_SHADER));
+	program = pgr::createProgram(shaderList);
+	screenSizeLocation = glGetUniformLocation(program, "screenSize");
+	atlasLocation = glGetUniformLocation(program, "glyphAtlas");
+	imageLocation = glGetUniformLocation(program, "image");
+	GLint positionLocation = glGetAttribLocation(program, "position");
+	GLint texCoordLocation = glGetAttribLocation(program, "texCoord");
+	GLint colorLocation = glGetAttribLocation(program, "color");
+	GLint modeLocation = glGetAttribLocation(program, "mode");
+
+	createAtlas();
+
+	// quads share one index pattern, only vertices change every frame
+	std::vector<unsigned short> indices(SPRITE_BATCH_QUADS * 6);
+	for (int quad = 0; quad < SPRITE_BATCH_QUADS; quad++) {
+		unsigned short corner = (unsigned short)(quad * 4);
+		unsigned short pattern[6] = { 0, 1, 2, 2, 1, 3 };
+		for (int i = 0; i < 6; i++)
+			indices[quad * 6 + i] = corner + pattern[i];
+	}
+
+	glGenVertexArrays(1, &vertexArrayObject);
+	glBindVertexArray(vertexArrayObject);
+
+	glGenBuffers(1, &vertexBufferObject);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferObject);
+	glBufferData(GL_ARRAY_BUFFER, SPRITE_BATCH_QUADS * 4 * sizeof(SpriteVertex), NULL, GL_STREAM_DRAW);
+
+	glGenBuffers(1, &indexBufferObject);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferObject);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.data(), GL_STATIC_DRAW);
+
+	glEnableVertexAttribArray(positionLocation);
+	glVertexAttribPointer(positionLocation, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, x));
+	glEnableVertexAttribArray(texCoordLocation);
+	glVertexAttribPointer(texCoordLocation, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, u));
+	glEnableVertexAttribArray(colorLocation);
+	glVertexAttribPointer(colorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, color));
+	glEnableVertexAttribArray(modeLocation);
+	glVertexAttribPointer(modeLocation, 1, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, mode));
+
+	glBindVertexArray(0);
+	vertices.reserve(SPRITE_BATCH_QUADS * 4);
+}
+
+void spriteBatch::cleanUp() {
+	if (program == 0)
+		return;
+	pgr::deleteProgramAndShaders(program);
+	glDeleteVertexArrays(1, &vertexArrayObject);
+	glDeleteBuffers(1, &vertexBufferObject);
+	glDeleteBuffers(1, &indexBufferObject);
+	glDeleteTextures(1, &atlasTexture);
+	program = vertexArrayObject = vertexBufferObject = indexBufferObject = atlasTexture = 0;
+}
+
+void spriteBatch::begin(int screenWidth, int screenHeight) {
+	this->screenWidth = screenWidth;
+	this->screenHeight = screenHeight;
+	vertices.clear();
+}
+
+// uv is (u0, v0, u1, v1) of the top left and bottom right corner
+void spriteBatch::addQuad(float x, float y, float width, float height, const glm::vec4& uv, const glm::vec4& color, float mode) {
+	if (vertices.size() >= (size_t)SPRITE_BATCH_QUADS * 4)
+		return;
+	SpriteVertex corner;
+	for (int i = 0; i < 4; i++)
+		corner.color[i] = (unsigned char)(glm::clamp(color[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+	corner.mode = mode;
+
+	corner.x = x;          corner.y = y;           corner.u = uv.x; corner.v = uv.y;
+	vertices.push_back(corner);
+	corner.x = x;          corner.y = y + height;  corner.u = uv.x; corner.v = uv.w;
+	vertices.push_back(corner);
+	corner.x = x + width;  corner.y = y;           corner.u = uv.z; corner.v = uv.y;
+	vertices.push_back(corner);
+	corner.x = x + width;  corner.y = y + height;  corner.u = uv.z; corner.v = uv.w;
+	vertices.push_back(corner);
+}
+
+void spriteBatch::addRect(float x, float y, float width, float height, const glm::vec4& color) {
+	// middle of the filled cell, no edge of it is ever sampled
+	glm::vec4 cell = cellCoords(SOLID_CELL, ATLAS_CELL, ATLAS_CELL);
+	glm::vec2 center = glm::vec2(cell.x + cell.z, cell.y + cell.w) * 0.5f;
+	addQuad(x, y, width, height, glm::vec4(center.x, center.y, center.x, center.y), color, 0.0f);
+}
+
+void spriteBatch::addImage(float x, float y, float width, float height, const glm::vec4& uv, const glm::vec4& color) {
+	addQuad(x, y, width, height, uv, color, 1.0f);
+}
+
+float spriteBatch::addText(float x, float y, const char* text, float scale, const glm::vec4& color) {
+	float start = x;
+	for (; *text != '\0'; text++) {
+		if (*text != ' ')
+			addQuad(x, y, FONT_GLYPH_WIDTH * scale, FONT_GLYPH_HEIGHT * scale,
+				cellCoords(glyphCell(*text), FONT_GLYPH_WIDTH, FONT_GLYPH_HEIGHT), color, 0.0f);
+		x += FONT_ADVANCE * scale;
+	}
+	return x - start;
+}
+
+float spriteBatch::textWidth(const char* text, float scale) {
+	return strlen(text) * FONT_ADVANCE * scale;
+}
+
+// everything collected since begin in one upload and one draw call
+void spriteBatch::flush() {
+	if (vertices.empty() || program == 0)
+		return;
+
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glUseProgram(program);
+	glUniform2f(screenSizeLocation, (float)screenWidth, (float)screenHeight);
+	glUniform1i(atlasLocation, 0);
+	glUniform1i(imageLocation, 1);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, imageTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, atlasTexture);
+
+	// orphaning lets the driver hand out fresh memory instead of waiting for the last frame
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferObject);
+	glBufferData(GL_ARRAY_BUFFER, SPRITE_BATCH_QUADS * 4 * sizeof(SpriteVertex), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(SpriteVertex), vertices.data());
+
+	glBindVertexArray(vertexArrayObject);
+	glDrawElements(GL_TRIANGLES, (GLsizei)(vertices.size() / 4 * 6), GL_UNSIGNED_SHORT, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	glEnable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+}
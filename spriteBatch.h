@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       spriteBatch.h
+ * \author     rka Prokopov
+ * \date       2025/5/16
+ * \brief      Batched 2D quads and bitmap text for overlays, one buffer and one draw call
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __SPRITE_BATCH_H
+#define __SPRITE_BATCH_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "pgr.h"
+
+const int SPRITE_BATCH_QUADS = 4096;   // quads of one batch, more are dropped
+const int FONT_GLYPH_WIDTH = 5;        // pixels of a glyph in the atlas
+const int FONT_GLYPH_HEIGHT = 7;
+const int FONT_ADVANCE = 6;            // glyph plus one pixel of spacing
+
+// one corner of a quad, positions in pixels from the top left corner of the window
+typedef struct SpriteVertex {
+	float x, y;
+	float u, v;
+	unsigned char color[4];
+	float mode;              // 0 = glyph atlas, 1 = image
+} SpriteVertex;
+
+/// <summary>
+/// collects rectangles, text and one image into a single dynamic buffer and draws them
+/// with one glDrawElements - solid rectangles use a filled cell of the glyph atlas
+/// </summary>
+class spriteBatch {
+public:
+	spriteBatch() : program(0), vertexArrayObject(0), vertexBufferObject(0), indexBufferObject(0),
+		atlasTexture(0), imageTexture(0), screenWidth(1), screenHeight(1) {}
+
+	void init();
+	void cleanUp();
+
+	void begin(int screenWidth, int screenHeight);
+	void setImage(GLuint texture) { imageTexture = texture; }
+	void addRect(float x, float y, float width, float height, const glm::vec4& color);
+	void addImage(float x, float y, float width, float height, const glm::vec4& uv, const glm::vec4& color);
+	float addText(float x, float y, const char* text, float scale, const glm::vec4& color);   // returns the width
+	void flush();
+
+	int getQuadCount() { return (int)(vertices.size() / 4); }
+	static float textWidth(const char* text, float scale);
+
+private:
+	void addQuad(float x, float y, float width, float height, const glm::vec4& uv, const glm::vec4& color, float mode);
+	void createAtlas();
+
+	GLuint program;
+	GLint screenSizeLocation;
+	GLint atlasLocation;
+	GLint imageLocation;
+
+	GLuint vertexArrayObject;
+	GLuint vertexBufferObject;
+	GLuint indexBufferObject;
+	GLuint atlasTexture;
+	GLuint imageTexture;
+
+	int screenWidth;
+	int screenHeight;
+	std::vector<SpriteVertex> vertices;
+};
+
+#endif
@@ -0,0 +1,245 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       startupTimer.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/20
+ * \brief      Startup broken down by asset and loading stage
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "startupTimer.h"
+#include "pgr.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// how the last evictFiles dropped the cache
+static const char* evictMethod = "none";
+
+const char* startupTimer::getStageName(int stage) {
+	static const char* names[STARTUP_STAGE_COUNT] = {
+		"read", "parse", "postProcess", "decode", "compile", "upload"
+	};
+	return names[stage];
+}
+
+void startupTimer::start(const std::string& scenario) {
+	this->scenario = scenario;
+	assets.clear();
+	assetIndex.clear();
+	phases.clear();
+	enabled = true;
+	startTime = std::chrono::steady_clock::now();
+}
+
+double startupTimer::now() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+AssetTimes& startupTimer::getAsset(const std::string& asset, const char* kind) {
+	std::map<std::string, size_t>::iterator found = assetIndex.find(asset);
+	if (found != assetIndex.end())
+		return assets[found->second];
+
+	assetIndex[asset] = assets.size();
+	assets.push_back(AssetTimes());
+	AssetTimes& times = assets.back();
+	times.name = asset;
+	times.kind = kind;
+	std::fill(times.stages, times.stages + STARTUP_STAGE_COUNT, 0.0);
+	times.bytes = 0;
+	return times;
+}
+
+void startupTimer::add(const std::string& asset, const char* kind, int stage, double start) {
+	if (!enabled)
+		return;
+	// GL takes uploads asynchronously, the stage ends when the driver is done with them
+	if (stage == STARTUP_UPLOAD)
+		glFinish();
+	getAsset(asset, kind).stages[stage] += now() - start;
+}
+
+void startupTimer::setBytes(const std::string& asset, const char* kind, size_t bytes) {
+	if (!enabled)
+		return;
+	getAsset(asset, kind).bytes = bytes;
+}
+
+// assimp and pgr open the files themselves, reading it first keeps the disk out of parsing
+void startupTimer::readAsset(const std::string& fileName, const char* kind) {
+	if (!enabled)
+		return;
+	std::vector<char> data;
+	double start = now();
+	readFile(fileName, data);
+	add(fileName, kind, STARTUP_READ, start);
+	setBytes(fileName, kind, data.size());
+}
+
+void startupTimer::mark(const char* phase) {
+	if (!enabled)
+		return;
+	StartupPhase mark = { phase, now() };
+	phases.push_back(mark);
+}
+
+bool startupTimer::readFile(const std::string& fileName, std::vector<char>& data) {
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+	std::streamsize size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	data.resize((size_t)size);
+	return size == 0 || (bool)file.read(data.data(), size);
+}
+
+const char* startupTimer::getEvictMethod() {
+	return evictMethod;
+}
+
+#ifndef _WIN32
+
+// calls action for every regular file of the directory
+template <typename Action>
+static int forEachFile(const std::string& directory, bool recursive, Action action) {
+	DIR* dir = opendir(directory.c_str());
+	if (dir == NULL)
+		return 0;
+	int files = 0;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL) {
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		std::string path = directory + "/" + name;
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0)
+			continue;
+		if (S_ISDIR(info.st_mode)) {
+			if (recursive)
+				files += forEachFile(path, recursive, action);
+		}
+		else if (S_ISREG(info.st_mode)) {
+			action(path);
+			files++;
+		}
+	}
+	closedir(dir);
+	return files;
+}
+
+// as root the whole page cache is dropped, otherwise the kernel is asked to drop the pages
+// of every file - clean pages go, so the files have to be written to disk before
+int startupTimer::evictFiles(const std::string& directory, bool recursive) {
+	sync();
+	std::ofstream dropCaches("/proc/sys/vm/drop_caches");
+	if (dropCaches.is_open() && (dropCaches << "1" << std::flush))
+		evictMethod = "drop_caches";
+	else
+		evictMethod = "fadvise";
+
+	return forEachFile(directory, recursive, [](const std::string& path) {
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return;
+#ifdef POSIX_FADV_DONTNEED
+		posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+		close(file);
+	});
+}
+
+int startupTimer::touchFiles(const std::string& directory, bool recursive) {
+	return forEachFile(directory, recursive, [](const std::string& path) {
+		std::vector<char> data;
+		readFile(path, data);
+	});
+}
+
+#else
+
+int startupTimer::evictFiles(const std::string& directory, bool recursive) {
+	std::cerr << "startup: the page cache cannot be dropped in the Windows build" << std::endl;
+	evictMethod = "none";
+	return 0;
+}
+
+int startupTimer::touchFiles(const std::string& directory, bool recursive) {
+	return 0;
+}
+
+#endif
+
+// sorted by total time, slowest asset first
+void startupTimer::printReport(std::ostream& out) {
+	std::vector<size_t> order(assets.size());
+	std::vector<double> totals(assets.size(), 0.0);
+	for (size_t i = 0; i < assets.size(); i++) {
+		order[i] = i;
+		for (int stage = 0; stage < STARTUP_STAGE_COUNT; stage++)
+			totals[i] += assets[i].stages[stage];
+	}
+	std::sort(order.begin(), order.end(), [&totals](size_t a, size_t b) { return totals[a] > totals[b]; });
+
+	out << std::fixed << std::setprecision(2);
+	out << "Startup (" << scenario << " cache) in ms:" << std::endl;
+	for (size_t i = 0; i < phases.size(); i++)
+		out << "  " << std::setw(16) << std::left << phases[i].name << std::right << std::setw(10) << phases[i].time << std::endl;
+
+	out << "  " << std::setw(44) << std::left << "asset" << std::right;
+	for (int stage = 0; stage < STARTUP_STAGE_COUNT; stage++)
+		out << std::setw(12) << getStageName(stage);
+	out << std::setw(12) << "total" << std::endl;
+	for (size_t i = 0; i < order.size(); i++) {
+		const AssetTimes& times = assets[order[i]];
+		out << "  " << std::setw(44) << std::left << times.name << std::right;
+		for (int stage = 0; stage < STARTUP_STAGE_COUNT; stage++)
+			out << std::setw(12) << times.stages[stage];
+		out << std::setw(12) << totals[order[i]] << std::endl;
+	}
+}
+
+// paths of the Windows build contain backslashes
+static std::string jsonString(const std::string& text) {
+	std::string escaped;
+	for (size_t i = 0; i < text.size(); i++) {
+		if (text[i] == '\\' || text[i] == '"')
+			escaped += '\\';
+		escaped += text[i];
+	}
+	return escaped;
+}
+
+void startupTimer::writeJson(std::ostream& out) {
+	double stageTotals[STARTUP_STAGE_COUNT] = {};
+	for (size_t i = 0; i < assets.size(); i++)
+		for (int stage = 0; stage < STARTUP_STAGE_COUNT; stage++)
+			stageTotals[stage] += assets[i].stages[stage];
+
+	out << std::fixed << std::setprecision(3);
+	out << "{\n  \"scenario\": \"" << scenario << "\",\n  \"evict\": \"" << evictMethod << "\",\n  \"phases\": {";
+	for (size_t i = 0; i < phases.size(); i++)
+		out << (i ? ", " : "") << "\"" << phases[i].name << "\": " << phases[i].time;
+	out << "},\n  \"stages\": {";
+	for (int stage = 0; stage < STARTUP_STAGE_COUNT; stage++)
+		out << (stage ? ", " : "") << "\"" << getStageName(stage) << "\": " << stageTotals[stage];
+	out << "},\n  \"assets\": [";
+	for (size_t i = 0; i < assets.size(); i++) {
+		const AssetTimes& times = assets[i];
+		out << (i ? "," : "") << "\n    {\"name\": \"" << jsonString(times.name) << "\", \"kind\": \"" << times.kind
+			<< "\", \"bytes\": " << times.bytes;
+		for (int stage = 0; stage < STARTUP_STAGE_COUNT; stage++)
+			out << ", \"" << getStageName(stage) << "\": " << times.stages[stage];
+		out << "}";
+	}
+	out << "\n  ]\n}" << std::endl;
+}
@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       startupTimer.h
+ * \author     rka Prokopov
+ * \date       2025/5/20
+ * \brief      Startup broken down by asset and loading stage, written as JSON by the
+ *				--startup benchmark - disabled it only skips the extra file reads
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __STARTUP_TIMER_H
+#define __STARTUP_TIMER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <chrono>
+
+// loading stages of one asset
+enum {
+	STARTUP_READ,          // file into memory, the only stage touching the disk
+	STARTUP_PARSE,         // Assimp import without post-processing
+	STARTUP_POSTPROCESS,   // Assimp post-processing steps
+	STARTUP_DECODE,        // image to RGBA pixels
+	STARTUP_COMPILE,       // shader compilation and program linking
+	STARTUP_UPLOAD,        // buffers and textures handed to GL, finished with glFinish
+	STARTUP_STAGE_COUNT
+};
+
+// times of one file in milliseconds
+typedef struct AssetTimes {
+	std::string name;
+	const char* kind;      // mesh, texture or shader
+	double stages[STARTUP_STAGE_COUNT];
+	size_t bytes;          // size of the file
+} AssetTimes;
+
+// time since the start when a part of the startup finished
+typedef struct StartupPhase {
+	std::string name;
+	double time;
+} StartupPhase;
+
+/// <summary>
+/// collects the stage times of every asset and the phases of one startup, stages of an
+/// asset loaded twice are summed
+/// </summary>
+class startupTimer {
+public:
+	startupTimer() : enabled(false) {}
+
+	void start(const std::string& scenario);   // enables the timer, scenario is cold or warm
+	bool isEnabled() { return enabled; }
+
+	// start of a stage, add() measures from it to now
+	double now();
+	void add(const std::string& asset, const char* kind, int stage, double start);
+	void setBytes(const std::string& asset, const char* kind, size_t bytes);   // size of the file
+	void readAsset(const std::string& fileName, const char* kind);   // timed read into the page cache
+	void mark(const char* phase);
+
+	void printReport(std::ostream& out);
+	void writeJson(std::ostream& out);
+	static const char* getStageName(int stage);
+
+	// page cache of every file in the directory, returns the number of files handled
+	static int evictFiles(const std::string& directory, bool recursive);
+	static int touchFiles(const std::string& directory, bool recursive);
+	static bool readFile(const std::string& fileName, std::vector<char>& data);
+	static const char* getEvictMethod();
+
+private:
+	AssetTimes& getAsset(const std::string& asset, const char* kind);
+
+	bool enabled;
+	std::string scenario;
+	std::chrono::steady_clock::time_point startTime;
+	std::vector<AssetTimes> assets;
+	std::map<std::string, size_t> assetIndex;
+	std::vector<StartupPhase> phases;
+};
+
+#endif
@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       metricsClient.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/18
+ * \brief      Console client of the metrics socket (stats.socket in settings.txt),
+ *				usage: metricsClient [socket] [--raw]
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// value of the first "key": in the line, the server writes flat numbers only
+static double field(const std::string& line, const char* key) {
+	std::string pattern = std::string("\"") + key + "\":";
+	size_t position = line.find(pattern);
+	if (position == std::string::npos)
+		return 0.0;
+	return atof(line.c_str() + position + pattern.size());
+}
+
+static void printSummary(const std::string& line) {
+	std::cout << "frame " << (long long)field(line, "frame")
+		<< "  fps " << field(line, "fps")
+		<< "  ms p50 " << field(line, "p50") << " p95 " << field(line, "p95") << " p99 " << field(line, "p99")
+		<< "  draws " << (long long)field(line, "drawCalls")
+		<< "  tris " << (long long)field(line, "triangles")
+		<< "  allocs " << field(line, "allocations")
+		<< "  mem " << (long long)field(line, "memoryKB") / 1024 << " MB" << std::endl;
+}
+
+int main(int argc, char** argv) {
+	std::string socketPath = "/tmp/lake-metrics.sock";
+	bool raw = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--raw") == 0)
+			raw = true;
+		else
+			socketPath = argv[i];
+	}
+
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server < 0 || connect(server, (sockaddr*)&address, sizeof(address)) != 0) {
+		std::cerr << "Error: cannot connect to '" << socketPath << "'" << std::endl;
+		return 1;
+	}
+
+	std::cout.setf(std::ios::fixed);
+	std::cout.precision(2);
+	std::string pending;
+	char buffer[4096];
+	ssize_t received;
+	while ((received = read(server, buffer, sizeof(buffer))) > 0) {
+		pending.append(buffer, received);
+		size_t end;
+		while ((end = pending.find('\n')) != std::string::npos) {
+			std::string line = pending.substr(0, end);
+			pending.erase(0, end + 1);
+			if (raw)
+				std::cout << line << std::endl;
+			else
+				printSummary(line);
+		}
+	}
+	close(server);
+	return 0;
+}
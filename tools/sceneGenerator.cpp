@@ -0,0 +1,40 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       sceneGenerator.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/21
+ * \brief      Writes a config with many generated props around the lake,
+ *				usage: sceneGenerator count [uniform|ring|cluster|grid] [output] [seed] [floating share]
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "../sceneGenerator.h"
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "usage: sceneGenerator count [uniform|ring|cluster|grid] [output] [seed] [floating share]" << std::endl;
+		return 1;
+	}
+	SceneLayout layout;
+	layout.count = atoi(argv[1]);
+	if (argc > 2) {
+		layout.distribution = sceneGenerator::parseDistribution(argv[2]);
+		if (layout.distribution < 0) {
+			std::cerr << "Error: unknown distribution '" << argv[2] << "'" << std::endl;
+			return 1;
+		}
+	}
+	std::string output = argc > 3 ? argv[3] : "data/generated.txt";
+	if (argc > 4)
+		layout.seed = (unsigned int)atoi(argv[4]);
+	if (argc > 5)
+		layout.floatingShare = (float)atof(argv[5]);
+
+	if (!sceneGenerator::write(output, "data/config.txt", layout))
+		return 1;
+	std::cout << layout.count << " props (" << sceneGenerator::getDistributionName(layout.distribution)
+		<< ") written to " << output << std::endl;
+	return 0;
+}
@@ -0,0 +1,20 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       transform.cpp
+ * \author     rka Prokopov
+ * \date       2025/5/19
+ * \brief      Matrix math shared by the passes, free of GL calls
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#include "transform.h"
+
+glm::mat4 transformHandler::normalMatrix(const glm::mat4& modelMatrix) {
+	const glm::mat4 modelRotationMatrix = glm::mat4(
+		modelMatrix[0],
+		modelMatrix[1],
+		modelMatrix[2],
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)
+	);
+	return glm::transpose(glm::inverse(modelRotationMatrix));   // correct matrix for non-rigid transform
+}
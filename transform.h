@@ -0,0 +1,21 @@
+//-----------------------------------------------------------------------------------------
+/**
+ * \file       transform.h
+ * \author     rka Prokopov
+ * \date       2025/5/19
+ * \brief      Matrix math shared by the passes, free of GL calls
+ *
+*/
+//-----------------------------------------------------------------------------------------
+#ifndef __TRANSFORM_H
+#define __TRANSFORM_H
+
+#include "pgr.h"
+
+class transformHandler {
+public:
+	// inverse transposed rotation and scale of the model matrix, for normals
+	static glm::mat4 normalMatrix(const glm::mat4& modelMatrix);
+};
+
+#endif
@@ -102,6 +102,22 @@ typedef struct _commonShaderProgram {
 	GLint refractionTextureLocation;
 	GLint dudvMapLocation;
 	GLint moveFactorLocation;
+	// ocean waves
+	GLint displacementMapLocation;
+	GLint normalMapLocation;
+	GLint oceanPatchSizeLocation;
+	// reflection probe and quality switches
+	GLint reflectionProbeLocation;
+	GLint useProbeLocation;
+	GLint useRefractionLocation;
+	// interactive ripples
+	GLint rippleMapLocation;
+	GLint rippleAreaLocation;
+	// single pass water targets
+	GLint layerPVmatrixLocation;
+	GLint waterHeightLocation;
+	GLint waterLayersLocation;
+	GLint useLayersLocation;
 	// fog switcher
 	GLint isFogLocation;
 	// lights
@@ -140,6 +156,7 @@ typedef struct _gameState {
 
 	float elapsedTime;          // game time
 	bool curveMotion;           // switch to spline motion
+	bool flythroughMode = false;  // camera follows a recorded flythrough
 	bool isCloudy;
 	bool blowMaxwell;
 
@@ -177,16 +194,18 @@ typedef struct _bannerShaderProgram {
 	GLint texSamplerLocation;
 } BannerShaderProgram;
 
-// structure for loading bar
-typedef struct _barShaderProgram {
-	GLuint program; 
-	//vertex attributes locations
+// shader for one step of ripple simulation
+typedef struct _rippleShaderProgram {
+	GLuint program;
+	// vertex attributes locations
 	GLint posLocation;
-	GLint texCoordLocation;
-	GLint PVMmatrixLocation;
-	GLint timeLocation;
-	GLint texSamplerLocation;
+	// uniforms locations
+	GLint heightMapLocation;
+	GLint texelSizeLocation;
+	GLint dampingLocation;
+	GLint dropCountLocation;
+	GLint dropsLocation;
 
-} BarShaderProgram;
+} RippleShaderProgram;
 
 #endif
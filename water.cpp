@@ -9,6 +9,10 @@
 */
 //-----------------------------------------------------------------------------------------
 #include "water.h"
+#include <cstring>
+#include <iostream>
+#include "glCounters.h"
+#include "frameArena.h"
 
 
 void waterBufferMaker::cleanUp() {//call when closing the game
@@ -18,6 +22,13 @@ void waterBufferMaker::cleanUp() {//call when closing the game
 	glDeleteFramebuffers(1, &refractionFrameBuffer);
 	glDeleteTextures(1, &refractionTexture);
 	glDeleteTextures(1, &refractionDepthTexture);
+	if (layeredFrameBuffer) {
+		glDeleteFramebuffers(1, &layeredFrameBuffer);
+		glDeleteFramebuffers(WATER_LAYER_COUNT, layerFrameBuffers);
+		glDeleteTextures(1, &layeredTexture);
+		glDeleteTextures(1, &layeredDepthTexture);
+		layeredFrameBuffer = 0;
+	}
 }
 
 
@@ -113,39 +124,490 @@ GLuint waterBufferMaker::getRefractionDepthTexture() {
 	return refractionDepthTexture;
 }
 
+void waterBufferMaker::initialiseLayeredFrameBuffer() {
+	if (layeredFrameBuffer)
+		return;
 
+	glGenTextures(1, &layeredTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, layeredTexture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB, REFRACTION_WIDTH, REFRACTION_HEIGHT, WATER_LAYER_COUNT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+	glGenTextures(1, &layeredDepthTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, layeredDepthTexture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, REFRACTION_WIDTH, REFRACTION_HEIGHT, WATER_LAYER_COUNT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
-void addVertex(GLfloat* buffer, int& index, float x, float y, float z, float u, float v) {
-	buffer[index++] = x;
-	buffer[index++] = y;
-	buffer[index++] = z;
-	buffer[index++] = 0.0f; // normal x
-	buffer[index++] = 0.0f; // normal y
-	buffer[index++] = 1.0f; // normal z
-	buffer[index++] = u;
-	buffer[index++] = v;
+	layeredFrameBuffer = createFrameBuffer();
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, layeredTexture, 0);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, layeredDepthTexture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "waterBufferMaker: layered framebuffer is not complete" << std::endl;
+
+	for (int layer = 0; layer < WATER_LAYER_COUNT; layer++) {
+		layerFrameBuffers[layer] = createFrameBuffer();
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, layeredTexture, 0, layer);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, layeredDepthTexture, 0, layer);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cerr << "waterBufferMaker: framebuffer of layer " << layer << " is not complete" << std::endl;
+	}
+
+	unbindCurrentFrameBuffer();
+	CHECK_GL_ERROR();
+}
+
+void waterBufferMaker::bindLayeredFrameBuffer() {
+	bindFrameBuffer(layeredFrameBuffer, REFRACTION_WIDTH, REFRACTION_HEIGHT);
+}
+
+void waterBufferMaker::bindLayerFrameBuffer(int layer) {
+	bindFrameBuffer(layerFrameBuffers[layer], REFRACTION_WIDTH, REFRACTION_HEIGHT);
+}
+
+
+
+
+//---------------------------------------------------------------WATER MESH----------------------------------------------------------
+
+// rebuild the rings when camera moves to another snapped position, returns true if mesh changed
+bool waterMeshGenerator::update(const glm::vec3& cameraPosition) {
+	// snap to twice the coarsest cell so every level stays aligned with its own grid
+	float step = 2.0f * WATER_LOD_CELL_SIZE * (float)(1 << (WATER_LOD_LEVELS - 1));
+	glm::vec2 newCenter = glm::vec2(floor(cameraPosition.x / step + 0.5f), floor(cameraPosition.y / step + 0.5f)) * step;
+
+	if (hasCenter && newCenter == center)
+		return false;
+
+	center = newCenter;
+	hasCenter = true;
+	generate();
+	return true;
+}
+
+// copy generated data to buffers, water vertex array has to be bound
+void waterMeshGenerator::upload(GLuint vertexBuffer, GLuint elementBuffer) {
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	if (vertices.size() > vertexCapacity) {
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_DYNAMIC_DRAW);
+		vertexCapacity = vertices.size();
+	}
+	else {
+		glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(GLfloat), vertices.data());
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+	if (indices.size() > indexCapacity) {
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_DYNAMIC_DRAW);
+		indexCapacity = indices.size();
+	}
+	else {
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
+	}
+}
+
+void waterMeshGenerator::generate() {
+	vertices.clear();
+	indices.clear();
+	triangleCount = 0;
+
+	for (int level = 0; level < WATER_LOD_LEVELS; level++) {
+		generateLevel(level);
+	}
+}
+
+// vertex clamped to the lake, texture coordinates span the whole lake
+GLuint waterMeshGenerator::addVertex(float x, float y) {
+	const float half = WATER_RES / 2.0f;
+	x = glm::clamp(x, -half, half);
+	y = glm::clamp(y, -half, half);
+
+	vertices.push_back(x);
+	vertices.push_back(y);
+	vertices.push_back(WATER_Z);
+	vertices.push_back(0.0f); // normal x
+	vertices.push_back(0.0f); // normal y
+	vertices.push_back(1.0f); // normal z
+	vertices.push_back((x + half) / WATER_RES);
+	vertices.push_back((y + half) / WATER_RES);
+
+	return (GLuint)(vertices.size() / VERTEX_SIZE - 1);
+}
+
+// vertex shared by neighbouring cells of one level
+GLuint waterMeshGenerator::gridVertex(GLuint* grid, float originX, float originY, float cellSize, int i, int j) {
+	GLuint& slot = grid[j * (WATER_LOD_CELLS + 1) + i];
+	if (slot == WATER_RESTART_INDEX)
+		slot = addVertex(originX + i * cellSize, originY + j * cellSize);
+	return slot;
+}
+
+void waterMeshGenerator::addStrip(const GLuint* strip, int count) {
+	if (count < 3)
+		return;
+	if (!indices.empty())
+		indices.push_back(WATER_RESTART_INDEX);
+	indices.insert(indices.end(), strip, strip + count);
+	triangleCount += count - 2;
+}
+
+// one level of the clipmap - rows of cells as strips, ring levels skip the hole covered by finer level,
+// the vertex grid and strip are scratch of the frame arena of the rebuilding thread
+void waterMeshGenerator::generateLevel(int level) {
+	const int n = WATER_LOD_CELLS;
+	const int holeBegin = n / 4;
+	const int holeEnd = 3 * n / 4;
+	const float half = WATER_RES / 2.0f;
+
+	float cellSize = WATER_LOD_CELL_SIZE * (float)(1 << level);
+	float originX = center.x - (n / 2) * cellSize;
+	float originY = center.y - (n / 2) * cellSize;
+
+	arenaVector<GLuint> grid((n + 1) * (n + 1), WATER_RESTART_INDEX);
+	arenaVector<GLuint> strip;
+	strip.reserve(2 * (n + 1));
+
+	for (int j = 0; j < n; j++) {
+		float y0 = originY + j * cellSize;
+		float y1 = y0 + cellSize;
+		bool holeRow = level > 0 && j >= holeBegin && j < holeEnd;
+		bool seamRow = level > 0 && j >= holeBegin - 1 && j <= holeEnd;
+
+		strip.clear();
+		for (int i = 0; i < n; i++) {
+			float x0 = originX + i * cellSize;
+			float x1 = x0 + cellSize;
+			bool outside = x1 <= -half || x0 >= half || y1 <= -half || y0 >= half;
+			bool hole = holeRow && i >= holeBegin && i < holeEnd;
+
+			// cells touching the finer level get a middle vertex on the shared edge so there are no cracks
+			int e0i = -1, e0j = 0, e1i = 0, e1j = 0, o0i = 0, o0j = 0, o1i = 0, o1j = 0;
+			if (!hole && seamRow && i >= holeBegin && i < holeEnd) {
+				if (j == holeBegin - 1) { // top edge
+					e0i = i; e0j = j + 1; e1i = i + 1; e1j = j + 1; o0i = i; o0j = j; o1i = i + 1; o1j = j;
+				}
+				else if (j == holeEnd) { // bottom edge
+					e0i = i; e0j = j; e1i = i + 1; e1j = j; o0i = i; o0j = j + 1; o1i = i + 1; o1j = j + 1;
+				}
+			}
+			else if (!hole && holeRow) {
+				if (i == holeBegin - 1) { // right edge
+					e0i = i + 1; e0j = j; e1i = i + 1; e1j = j + 1; o0i = i; o0j = j; o1i = i; o1j = j + 1;
+				}
+				else if (i == holeEnd) { // left edge
+					e0i = i; e0j = j; e1i = i; e1j = j + 1; o0i = i + 1; o0j = j; o1i = i + 1; o1j = j + 1;
+				}
+			}
+			bool seam = e0i >= 0;
+
+			if (outside || hole || seam) {
+				addStrip(strip.data(), (int)strip.size());
+				strip.clear();
+				if (seam && !outside) {
+					GLuint fan[5];
+					fan[0] = gridVertex(grid.data(), originX, originY, cellSize, e0i, e0j);
+					fan[1] = gridVertex(grid.data(), originX, originY, cellSize, o0i, o0j);
+					fan[2] = addVertex(originX + (e0i + e1i) * 0.5f * cellSize, originY + (e0j + e1j) * 0.5f * cellSize);
+					fan[3] = gridVertex(grid.data(), originX, originY, cellSize, o1i, o1j);
+					fan[4] = gridVertex(grid.data(), originX, originY, cellSize, e1i, e1j);
+					addStrip(fan, 5);
+				}
+				continue;
+			}
+
+			if (strip.empty()) {
+				strip.push_back(gridVertex(grid.data(), originX, originY, cellSize, i, j + 1));
+				strip.push_back(gridVertex(grid.data(), originX, originY, cellSize, i, j));
+			}
+			strip.push_back(gridVertex(grid.data(), originX, originY, cellSize, i + 1, j + 1));
+			strip.push_back(gridVertex(grid.data(), originX, originY, cellSize, i + 1, j));
+		}
+		addStrip(strip.data(), (int)strip.size());
+	}
+}
+
+
+//---------------------------------------------------------------OCEAN MAPS----------------------------------------------------------
+
+GLuint oceanTextureUploader::createMapTexture(GLint internalFormat, GLenum type) {
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, resolution, resolution, 0, GL_RGBA, type, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	// ocean patch is tiled over the whole lake
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	return texture;
+}
+
+void oceanTextureUploader::init(int newResolution) {
+	cleanUp();
+	resolution = newResolution;
+	current = 0;
+	skippedUploads = 0;
+
+	displacementTexture = createMapTexture(GL_RGBA32F, GL_FLOAT);
+	normalTexture = createMapTexture(GL_RGBA8, GL_UNSIGNED_BYTE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// one buffer holds both maps, displacement first
+	GLsizeiptr size = (GLsizeiptr)resolution * resolution * 4 * (sizeof(float) + 1);
+	glGenBuffers(OCEAN_PIXEL_BUFFERS, pixelBuffers);
+	for (int i = 0; i < OCEAN_PIXEL_BUFFERS; i++) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[i]);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	CHECK_GL_ERROR();
+}
+
+// copy maps into the next free buffer and start texture transfer from it, returns false if the upload was skipped
+bool oceanTextureUploader::upload(const float* displacement, const unsigned char* normals) {
+	if (resolution == 0)
+		return false;
+
+	if (fences[current]) {
+		// GPU may still read this buffer, never wait for it
+		if (glClientWaitSync(fences[current], 0, 0) == GL_TIMEOUT_EXPIRED) {
+			skippedUploads++;
+			return false;
+		}
+		glDeleteSync(fences[current]);
+		fences[current] = 0;
+	}
+
+	size_t displacementSize = (size_t)resolution * resolution * 4 * sizeof(float);
+	size_t normalSize = (size_t)resolution * resolution * 4;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[current]);
+	void* data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, displacementSize + normalSize,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (data == NULL) {
+		std::cerr << "oceanTextureUploader: mapping of pixel buffer failed" << std::endl;
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return false;
+	}
+	memcpy(data, displacement, displacementSize);
+	memcpy((char*)data + displacementSize, normals, normalSize);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	glBindTexture(GL_TEXTURE_2D, displacementTexture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, resolution, resolution, GL_RGBA, GL_FLOAT, (void*)0);
+	glBindTexture(GL_TEXTURE_2D, normalTexture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, resolution, resolution, GL_RGBA, GL_UNSIGNED_BYTE, (void*)displacementSize);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	current = (current + 1) % OCEAN_PIXEL_BUFFERS;
+	return true;
 }
 
-void createSquare(GLfloat* buffer, int& index, float x1, float y1, float x2, float y2, float z) {
-	// 2 triangles
-	addVertex(buffer, index, x1, y1, z, 0.0f, 0.0f);
-	addVertex(buffer, index, x1, y2, z, 0.0f, 1.0f);
-	addVertex(buffer, index, x2, y1, z, 1.0f, 0.0f);
+void oceanTextureUploader::cleanUp() {
+	for (int i = 0; i < OCEAN_PIXEL_BUFFERS; i++) {
+		if (fences[i])
+			glDeleteSync(fences[i]);
+		fences[i] = 0;
+	}
+	if (pixelBuffers[0])
+		glDeleteBuffers(OCEAN_PIXEL_BUFFERS, pixelBuffers);
+	for (int i = 0; i < OCEAN_PIXEL_BUFFERS; i++)
+		pixelBuffers[i] = 0;
+	if (displacementTexture)
+		glDeleteTextures(1, &displacementTexture);
+	if (normalTexture)
+		glDeleteTextures(1, &normalTexture);
+	displacementTexture = 0;
+	normalTexture = 0;
+	resolution = 0;
+}
+
+
+//---------------------------------------------------------------REFLECTION PROBE----------------------------------------------------------
+
+void reflectionProbe::init(int newSize, const glm::vec3& newPosition) {
+	cleanUp();
+	size = newSize;
+	position = newPosition;
+
+	glGenTextures(1, &cubeTexture);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubeTexture);
+	for (int face = 0; face < 6; face++) {
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB, size, size, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	}
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+	glGenFramebuffers(1, &frameBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size, size);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-	addVertex(buffer, index, x2, y2, z, 1.0f, 1.0f);
-	addVertex(buffer, index, x1, y2, z, 0.0f, 1.0f);
-	addVertex(buffer, index, x2, y1, z, 1.0f, 0.0f);
+	complete = false;
+	invalidate();
+	CHECK_GL_ERROR();
 }
 
-void generateWater(GLfloat* waterVertices) {
-	int index = 0;
+// static scene changed, all faces will be rendered again
+void reflectionProbe::invalidate() {
+	nextFace = 0;
+	facesLeft = 6;
+}
+
+// attach next face to probe framebuffer and compute its camera, returns face index
+int reflectionProbe::bindNextFace(glm::mat4& viewMatrix, glm::mat4& projectionMatrix) {
+	// look directions and up vectors in cube map face order
+	static const glm::vec3 directions[6] = {
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+	};
+	static const glm::vec3 ups[6] = {
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+	};
+
+	int face = nextFace;
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, cubeTexture, 0);
+	glViewport(0, 0, size, size);
+
+	viewMatrix = glm::lookAt(position, position + directions[face], ups[face]);
+	projectionMatrix = glm::perspective(glm::radians(90.0f), 1.0f, 0.05f, 20.0f);
+	return face;
+}
+
+void reflectionProbe::finishFace() {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	nextFace++;
+	facesLeft--;
+	if (facesLeft == 0) {
+		nextFace = 0;
+		complete = true;
+	}
+}
+
+void reflectionProbe::cleanUp() {
+	if (frameBuffer)
+		glDeleteFramebuffers(1, &frameBuffer);
+	if (depthBuffer)
+		glDeleteRenderbuffers(1, &depthBuffer);
+	if (cubeTexture)
+		glDeleteTextures(1, &cubeTexture);
+	frameBuffer = 0;
+	depthBuffer = 0;
+	cubeTexture = 0;
+	facesLeft = 0;
+	complete = false;
+}
+
+//----WATER VISIBILITY----
+void waterVisibility::init() {
+	cleanUp();
+	glGenQueries(1, &query);
+}
+
+bool waterVisibility::passesNeeded(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) {
+	testedFrames++;
+	skipped = true;
+
+	// lake is a flat rectangle, its lowest and highest position is clipped by the frustum
+	const float half = WATER_RES / 2.0f;
+	viewFrustum frustum(projectionMatrix * viewMatrix);
+	bool inFrustum = false;
+	for (int side = -1; side <= 1 && !inFrustum; side += 2) {
+		float z = WATER_Z + side * WATER_BOUNDS_MARGIN;
+		glm::vec3 corners[4] = {
+			glm::vec3(-half, -half, z), glm::vec3(half, -half, z),
+			glm::vec3(half, half, z), glm::vec3(-half, half, z)
+		};
+		inFrustum = frustum.intersectsPolygon(corners, 4);
+	}
+	if (!inFrustum) {
+		culledFrames++;
+		return false;
+	}
+
+	// result of the previous frame, read only when ready so the pipeline does not stall
+	if (queryPending) {
+		GLuint available = 0;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint anySamples = 0;
+			glGetQueryObjectuiv(query, GL_QUERY_RESULT, &anySamples);
+			occluded = anySamples == 0;
+			queryPending = false;
+		}
+	}
+	if (occluded) {
+		occludedFrames++;
+		return false;
+	}
+
+	skipped = false;
+	return true;
+}
+
+// query is restarted only after the previous result was read
+void waterVisibility::beginQuery() {
+	if (query == 0 || queryPending)
+		return;
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+	queryActive = true;
+}
+
+void waterVisibility::endQuery() {
+	if (!queryActive)
+		return;
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+	queryActive = false;
+	queryPending = true;
+}
+
+void waterVisibility::cleanUp() {
+	if (query)
+		glDeleteQueries(1, &query);
+	query = 0;
+	queryActive = false;
+	queryPending = false;
+	occluded = false;
+}
 
-	// Nastav hranice plochy
-	float x1 = -WATER_RES / 2.0f;
-	float y1 = -WATER_RES / 2.0f;
-	float x2 = WATER_RES / 2.0f;
-	float y2 = WATER_RES / 2.0f;
+//----REFLECTION CAMERA----
+void reflectionCamera::update(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) {
+	view = viewMatrix * waterMirrorMatrix();
+	projection = projectionMatrix;
 
-	createSquare(waterVertices, index, x1, y1, x2, y2, WATER_Z);
+	// water plane in eye space of the mirrored camera, keeps everything above the surface
+	glm::vec4 plane = glm::transpose(glm::inverse(view)) * glm::vec4(0.0f, 0.0f, 1.0f, -WATER_Z);
+	// camera has to be behind the plane, otherwise it sits under the water
+	oblique = plane.w < 0.0f;
+	if (oblique) {
+		// replace near plane with the clip plane (Lengyel, Oblique View Frustum Depth Projection and Clipping)
+		glm::vec4 corner = glm::vec4(
+			(glm::sign(plane.x) + projection[2][0]) / projection[0][0],
+			(glm::sign(plane.y) + projection[2][1]) / projection[1][1],
+			-1.0f,
+			(1.0f + projection[2][2]) / projection[3][2]);
+		glm::vec4 scaled = plane * (2.0f / glm::dot(plane, corner));
+		projection[0][2] = scaled.x - projection[0][3];
+		projection[1][2] = scaled.y - projection[1][3];
+		projection[2][2] = scaled.z - projection[2][3];
+		projection[3][2] = scaled.w - projection[3][3];
+	}
+	frustum.extract(projection * view);
 }
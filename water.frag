@@ -36,6 +36,14 @@ uniform vec3 reflectorDirection;  // reflector direction (world coordinates)
 uniform sampler2D reflectionTexture;
 uniform sampler2D refractionTexture;
 uniform sampler2D dudvMapTexture;
+uniform sampler2D normalMap;       // ocean normals, world space packed to 0-1
+uniform samplerCube reflectionProbe; // static scene around the lake
+uniform bool useProbe;             // reflect probe instead of planar reflection texture
+uniform bool useRefraction;        // refraction texture is rendered
+uniform sampler2D rippleMap;       // interactive ripples, r = height
+uniform float rippleArea;          // world size of ripple map
+uniform sampler2DArray waterLayers; // reflection and refraction from single layered pass
+uniform bool useLayers;
 
 uniform float moveFactor;
 
@@ -53,6 +61,8 @@ smooth in vec3 vertexPosition;         // vertex position in world space
 smooth in vec3 vertexNormal;           // vertex normal
 in float mydistance;				   // distance from the start of the fog, to compute fog
 in vec4 clipSpace;
+smooth in vec2 oceanCoord_v;           // coordinates in ocean maps
+smooth in vec2 rippleCoord_v;          // coordinates in ripple map
 
 
 out vec4       color_f;        // outgoing fragment color
@@ -158,21 +168,47 @@ void main() {
 
 		vec2 ndc = (clipSpace.xy/clipSpace.w)/2.0 + 0.5;
 		vec2 refractTexCoords = vec2(ndc.x, ndc.y);
-		vec2 reflectTexCoords = vec2(ndc.x, -ndc.y);
+		vec2 reflectTexCoords = vec2(ndc.x, ndc.y); // reflection camera is mirrored, no flip
 
 		vec2 distortion1 = (texture2D(dudvMapTexture,  vec2((texCoord_v.x/2.0 + 5.0)*6.0 + moveFactor, (texCoord_v.y/2.0 + 5.0)*6.0)).rg * 2.0 - 1.0) * waveStrength;
 		vec2 distortion2 = (texture2D(dudvMapTexture,  vec2((-(texCoord_v.x/2.0 + 5.0)*6.0) + moveFactor, (texCoord_v.y/2.0 + 5.0)*6.0)).rg * 2.0 - 1.0 + moveFactor) * waveStrength;
 		vec2 totalDist = distortion1 + distortion2;
 
+		// ocean waves bend the reflected and refracted image too
+		vec3 oceanNormal = normalize(texture(normalMap, oceanCoord_v).xyz * 2.0 - 1.0);
+
+		// ripple slope from height differences
+		vec2 rippleTexel = 1.0 / vec2(textureSize(rippleMap, 0));
+		float rippleCell = 2.0 * rippleArea * rippleTexel.x;
+		float rippleDx = texture(rippleMap, rippleCoord_v + vec2(rippleTexel.x, 0.0)).r - texture(rippleMap, rippleCoord_v - vec2(rippleTexel.x, 0.0)).r;
+		float rippleDy = texture(rippleMap, rippleCoord_v + vec2(0.0, rippleTexel.y)).r - texture(rippleMap, rippleCoord_v - vec2(0.0, rippleTexel.y)).r;
+		oceanNormal = normalize(oceanNormal - vec3(rippleDx, rippleDy, 0.0) / rippleCell);
+		vec3 surfaceNormal = normalize((Vmatrix * vec4(oceanNormal, 0.0)).xyz);
+		totalDist += oceanNormal.xy * waveStrength;
+
 		refractTexCoords += totalDist;
 		refractTexCoords = clamp(refractTexCoords, 0.001, 0.999);
 
 		reflectTexCoords += totalDist;
-		reflectTexCoords.x = clamp(reflectTexCoords.x, 0.001, 0.999);
-		reflectTexCoords.y = clamp(reflectTexCoords.y, -0.999, -0.001);
+		reflectTexCoords = clamp(reflectTexCoords, 0.001, 0.999);
+
+		vec4 reflectColor;
+		if (useProbe) {
+			// reflected view ray back in world space, Vmatrix has no scale
+			vec3 eyeReflect = reflect(normalize(vertexPosition), surfaceNormal);
+			vec3 worldReflect = transpose(mat3(Vmatrix)) * eyeReflect;
+			reflectColor = texture(reflectionProbe, worldReflect + vec3(totalDist, 0.0));
+		}
+		else if (useLayers)
+			reflectColor = texture(waterLayers, vec3(reflectTexCoords, 0.0));
+		else
+			reflectColor = texture(reflectionTexture, reflectTexCoords);
 
-		vec4 reflectColor = texture(reflectionTexture, reflectTexCoords);
-		vec4 refractColor = texture(refractionTexture, refractTexCoords);
+		vec4 refractColor = vec4(0.05, 0.2, 0.25, 1.0); // deep water
+		if (useLayers)
+			refractColor = texture(waterLayers, vec3(refractTexCoords, 1.0));
+		else if (useRefraction)
+			refractColor = texture(refractionTexture, refractTexCoords);
 
 		vec3 viewDir = normalize(vertexPosition); 
 		float fresnelFactor = clamp(dot(viewDir, vec3(0.0, 1.0, 0.0)), 0.0, 1.0); // Fresnel Factor 
@@ -182,7 +218,7 @@ void main() {
 		color_f = mix(reflectColor, refractColor, fresnelFactor);
 
 		if(spotLight){
-			color_f += evalSpotLight(cameraReflector, material, vertexPosition, vertexNormal);
+			color_f += evalSpotLight(cameraReflector, material, vertexPosition, surfaceNormal);
 		}
 
 		
@@ -11,18 +11,40 @@
 #define __WATER_H
 #include "pgr.h"
 #include <time.h>
+#include <vector>
 #include "data.h"
+#include "frustum.h"
 
-// size of one square
-const int SQUARE_SIZE = 48; 
-
-// create normal square
+// size of the whole lake
 const int WATER_RES = 17;
 const float WATER_Z = 1.1f;
-const float SQUARE_SIZE_F = 1.0f;
 const int VERTEX_SIZE = 8;
-const int TRIANGLE_VERTICES = 6;
-const int SQUARE_STRIDE = TRIANGLE_VERTICES * VERTEX_SIZE;
+
+// clipmap rings around camera
+const int WATER_LOD_LEVELS = 5;          // level 0 is full grid, others are rings
+const int WATER_LOD_CELLS = 32;          // cells per side of one level, divisible by 4
+const float WATER_LOD_CELL_SIZE = 0.05f; // cell size of the finest level
+const GLuint WATER_RESTART_INDEX = 0xFFFFFFFF;
+
+// reflection probe sits above open water, between tower and house
+const glm::vec3 REFLECTION_PROBE_POSITION = glm::vec3(0.0f, -1.5f, WATER_Z + 0.2f);
+
+// ring of pixel buffers for ocean map uploads
+const int OCEAN_PIXEL_BUFFERS = 3;
+
+// layers of the array framebuffer used by single pass rendering
+const int WATER_LAYER_REFLECTION = 0;
+const int WATER_LAYER_REFRACTION = 1;
+const int WATER_LAYER_COUNT = 2;
+
+// reflection about the water plane z = WATER_Z
+inline glm::mat4 waterMirrorMatrix() {
+	glm::mat4 mirror = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 2.0f * WATER_Z));
+	return glm::scale(mirror, glm::vec3(1.0f, 1.0f, -1.0f));
+}
+
+// lake bounds for visibility test, z margin covers waves and ripples
+const float WATER_BOUNDS_MARGIN = 0.1f;
 
 static int REFLECTION_WIDTH = 320;
 static int REFLECTION_HEIGHT = 180;
@@ -30,9 +52,149 @@ static int REFLECTION_HEIGHT = 180;
 static int REFRACTION_WIDTH = 1280;
 static int REFRACTION_HEIGHT = 720;
 
-void addVertex(GLfloat* buffer, int& index, float x, float y, float z, float u, float v);
-void generateWater(GLfloat waterVertices[]);
-void createSquare(GLfloat waterVertices[], float x1, float y1, float x2, float y2, int index);
+/// <summary>
+/// generates water surface as clipmap - dense rings near camera, coarse far away,
+/// indexed triangle strips separated by primitive restart
+/// </summary>
+class waterMeshGenerator {
+public:
+	waterMeshGenerator() : hasCenter(false), vertexCapacity(0), indexCapacity(0) {}
+
+	bool update(const glm::vec3& cameraPosition);
+	void upload(GLuint vertexBuffer, GLuint elementBuffer);
+	GLsizei getIndexCount() { return (GLsizei)indices.size(); }
+	unsigned int getTriangleCount() { return triangleCount; }
+	glm::vec2 getCenter() { return center; }
+
+private:
+	void generate();
+	void generateLevel(int level);
+	GLuint addVertex(float x, float y);
+	GLuint gridVertex(GLuint* grid, float originX, float originY, float cellSize, int i, int j);
+	void addStrip(const GLuint* strip, int count);
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	unsigned int triangleCount;
+
+	glm::vec2 center;
+	bool hasCenter;
+	size_t vertexCapacity;
+	size_t indexCapacity;
+};
+
+/// <summary>
+/// uploads ocean displacement and normal maps through a ring of pixel buffers, a buffer is
+/// reused only after its fence signaled, if none is free the upload is skipped instead of waiting
+/// </summary>
+class oceanTextureUploader {
+public:
+	oceanTextureUploader() : resolution(0), current(0), skippedUploads(0), displacementTexture(0), normalTexture(0) {
+		for (int i = 0; i < OCEAN_PIXEL_BUFFERS; i++) {
+			pixelBuffers[i] = 0;
+			fences[i] = 0;
+		}
+	}
+
+	void init(int resolution);
+	bool upload(const float* displacement, const unsigned char* normals);
+	void cleanUp();
+	GLuint getDisplacementTexture() { return displacementTexture; }
+	GLuint getNormalTexture() { return normalTexture; }
+	unsigned int getSkippedUploads() { return skippedUploads; }
+
+private:
+	GLuint createMapTexture(GLint internalFormat, GLenum type);
+
+	int resolution;
+	int current;
+	unsigned int skippedUploads;
+	GLuint pixelBuffers[OCEAN_PIXEL_BUFFERS];
+	GLsync fences[OCEAN_PIXEL_BUFFERS];
+	GLuint displacementTexture;
+	GLuint normalTexture;
+};
+
+/// <summary>
+/// cubemap with static scene seen from the lake center, used for reflections instead of
+/// planar pass, after invalidation faces are re-rendered one per frame
+/// </summary>
+class reflectionProbe {
+public:
+	reflectionProbe() : size(0), cubeTexture(0), frameBuffer(0), depthBuffer(0), nextFace(0), facesLeft(0), complete(false) {}
+
+	void init(int size, const glm::vec3& position);
+	void invalidate();
+	bool needsUpdate() { return facesLeft > 0; }
+	bool isComplete() { return complete; }
+	int bindNextFace(glm::mat4& viewMatrix, glm::mat4& projectionMatrix);
+	void finishFace();
+	void cleanUp();
+	GLuint getTexture() { return cubeTexture; }
+	glm::vec3 getPosition() { return position; }
+
+private:
+	int size;
+	glm::vec3 position;
+	GLuint cubeTexture;
+	GLuint frameBuffer;
+	GLuint depthBuffer;
+	int nextFace;
+	int facesLeft;
+	bool complete;     // all faces were rendered at least once
+};
+
+/// <summary>
+/// camera of the planar reflection - main camera mirrored about the water plane, its projection
+/// has oblique near plane lying in the water surface, so nothing under the water is drawn
+/// </summary>
+class reflectionCamera {
+public:
+	reflectionCamera() : oblique(false) {}
+
+	void update(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+	const glm::mat4& getView() { return view; }
+	const glm::mat4& getProjection() { return projection; }
+	const viewFrustum& getFrustum() { return frustum; }
+	bool isOblique() { return oblique; }
+
+private:
+	glm::mat4 view;
+	glm::mat4 projection;
+	viewFrustum frustum;
+	bool oblique;      // false when the main camera is under the water
+};
+
+/// <summary>
+/// decides if reflection and refraction passes are worth rendering - lake bounds are tested
+/// against the camera frustum, then the occlusion query of water from the previous frame is read
+/// </summary>
+class waterVisibility {
+public:
+	waterVisibility() : query(0), queryActive(false), queryPending(false), occluded(false), skipped(false),
+		testedFrames(0), culledFrames(0), occludedFrames(0) {}
+
+	void init();
+	bool passesNeeded(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+	void beginQuery();
+	void endQuery();
+	void cleanUp();
+	bool wasSkipped() { return skipped; }
+	unsigned int getTestedFrames() { return testedFrames; }
+	unsigned int getCulledFrames() { return culledFrames; }
+	unsigned int getOccludedFrames() { return occludedFrames; }
+
+private:
+	GLuint query;
+	bool queryActive;    // water draw is being counted
+	bool queryPending;   // result was not read yet
+	bool occluded;       // last read result had no samples
+	bool skipped;        // passes skipped in this frame
+
+	unsigned int testedFrames;
+	unsigned int culledFrames;
+	unsigned int occludedFrames;
+};
 
 /// <summary>
 /// class for handling with refraction and reflection buffer, set dudv texture and binding
@@ -40,7 +202,8 @@ void createSquare(GLfloat waterVertices[], float x1, float y1, float x2, float y
 class waterBufferMaker {
 public:
 
-	waterBufferMaker() {
+	waterBufferMaker() : layeredFrameBuffer(0), layeredTexture(0), layeredDepthTexture(0) {
+		layerFrameBuffers[0] = layerFrameBuffers[1] = 0;
 		initialiseReflectionFrameBuffer();
 		initialiseRefractionFrameBuffer();
 	}
@@ -62,6 +225,13 @@ public:
 	void setDudvMapTex(GLuint tex) { dudvMapTex = tex; }
 	GLuint getdudvMapTexID() { return dudvMapTex; }
 
+	// reflection and refraction as two layers of one texture array, both in refraction resolution
+	void initialiseLayeredFrameBuffer();
+	void bindLayeredFrameBuffer();
+	void bindLayerFrameBuffer(int layer);
+	bool hasLayers() { return layeredFrameBuffer != 0; }
+	GLuint getLayeredTexture() { return layeredTexture; }
+
 private:
 	GLuint reflectionFrameBuffer;
 	GLuint reflectionTexture;
@@ -71,6 +241,11 @@ private:
 	GLuint refractionTexture;
 	GLuint refractionDepthTexture;
 
+	GLuint layeredFrameBuffer;                     // all layers, geometry shader picks the layer
+	GLuint layerFrameBuffers[WATER_LAYER_COUNT];   // one layer, for skybox and explosions
+	GLuint layeredTexture;
+	GLuint layeredDepthTexture;
+
 	GLuint dudvMapTex;
 };
 
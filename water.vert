@@ -0,0 +1,40 @@
+#version 140
+
+uniform sampler2D displacementMap; // ocean displacement (dx, dy, height), repeats every patch
+uniform float oceanPatchSize;      // world size of one ocean patch
+uniform sampler2D rippleMap;       // interactive ripples, r = height
+uniform float rippleArea;          // world size of ripple map around the lake center
+
+in vec3 position;           // vertex position in world space
+in vec3 normal;             // vertex normal
+in vec2 texCoord;           // incoming texture coordinates
+
+uniform mat4 PVMmatrix;     // Projection * View * Model  --> model to clip coordinates
+uniform mat4 Vmatrix;       // View                       --> world to eye coordinates
+uniform mat4 Mmatrix;       // Model                      --> model to world coordinates
+uniform mat4 normalMatrix;  // inverse transposed Mmatrix
+
+out float mydistance;             // distance from the start of the fog, to compute fog
+out vec4 clipSpace;
+smooth out vec3 vertexPosition;		// vertex position in eye space
+smooth out vec3 vertexNormal;    	// vertex normal in eye space
+smooth out vec2 texCoord_v;       // outgoing texture coordinates
+smooth out vec2 oceanCoord_v;     // coordinates in ocean maps
+smooth out vec2 rippleCoord_v;    // coordinates in ripple map
+
+void main() {
+
+  oceanCoord_v = (Mmatrix * vec4(position, 1.0)).xy / oceanPatchSize;
+  rippleCoord_v = (Mmatrix * vec4(position, 1.0)).xy / rippleArea + 0.5;
+  vec3 displaced = position + textureLod(displacementMap, oceanCoord_v, 0.0).xyz;
+  displaced.z += textureLod(rippleMap, rippleCoord_v, 0.0).r;
+
+  vertexPosition = (Vmatrix * Mmatrix * vec4(displaced, 1.0)).xyz;
+  vertexNormal   = normalize( (Vmatrix * normalMatrix * vec4(normal, 0.0) ).xyz);
+  clipSpace = PVMmatrix * vec4(displaced, 1);
+  gl_Position = clipSpace;
+
+  texCoord_v = texCoord;
+  mydistance =  distance(vec4(0.0, 0.0, 0.0, 1.0), vec4(vertexPosition, 1.0));
+
+}